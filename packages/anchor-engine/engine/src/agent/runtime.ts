@@ -1,3 +1,5 @@
+import * as fs from 'fs';
+import PATHS from '../config/paths.js';
 import { nativeModuleManager } from '../utils/native-module-manager.js';
 import { InferenceService } from '../services/inference/inference-service.js';
 
@@ -32,6 +34,15 @@ export class AgentRuntime {
     // Load the native module (kept for legacy/potential future needs)
     this.native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
 
+    // search_memory answers from the last exported atom index, if there is one
+    if (this.native?.loadMemoryIndex && fs.existsSync(PATHS.MEMORY_INDEX_FILE)) {
+      try {
+        this.native.loadMemoryIndex(PATHS.MEMORY_INDEX_FILE);
+      } catch (e: any) {
+        console.warn(`[AgentRuntime] Memory index not loaded: ${e.message}`);
+      }
+    }
+
     // Initialize inference service
     this.inferenceService = new InferenceService({
       modelPath: options.model
@@ -61,6 +72,22 @@ export class AgentRuntime {
     }
   }
 
+  /**
+   * Run one turn's tool calls. Independent read-only calls run concurrently on
+   * the native worker pool; results come back in call order.
+   */
+  async executeTools(calls: Array<{ tool: string; params?: Record<string, unknown> }>): Promise<string[]> {
+    const requests = calls.map(call => JSON.stringify({ tool: call.tool, params: call.params ?? {} }));
+
+    if (this.native?.executeMany) {
+      return this.native.executeMany(requests);
+    }
+    if (this.native?.executeTool) {
+      return requests.map(request => this.native.executeTool(request));
+    }
+    throw new Error('Native tool executor is not available');
+  }
+
   /**
    * Basic Chat Flow (User Requested Validation Mode)
    * Context -> User Prompt -> Model -> Stream Output
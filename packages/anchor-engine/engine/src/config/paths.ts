@@ -36,6 +36,7 @@ const PATHS = {
   INBOX_DIR: path.join(CONTEXT_DIR, 'inbox'),
   LIBRARIES_DIR: path.join(CONTEXT_DIR, 'libraries'),
   MIRRORS_DIR: path.join(CONTEXT_DIR, 'mirrors'),
+  MEMORY_INDEX_FILE: path.join(CONTEXT_DIR, 'memory.idx'),
   SESSIONS_DIR: path.join(CONTEXT_DIR, 'sessions'),
   TEMP_DIR: path.join(os.tmpdir(), 'sovereign-context-engine'),
   ENGINE_BIN: path.join(PROJECT_ROOT, 'engine', 'bin'),
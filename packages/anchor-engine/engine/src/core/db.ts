@@ -131,6 +131,19 @@ export class Database {
           console.debug(`[DB] Column ${col.name} addition:`, alterErr.message);
         }
       }
+      // Dense row number keying the native simhash column. Checked first: a
+      // SERIAL in ADD COLUMN IF NOT EXISTS would create a sequence every start.
+      try {
+        const ordinal = await this.run(
+          `SELECT 1 FROM information_schema.columns WHERE table_name = 'atoms' AND column_name = 'ordinal'`
+        );
+        if (!ordinal.rows?.length) {
+          await this.run('ALTER TABLE atoms ADD COLUMN ordinal SERIAL;');
+        }
+        await this.run('CREATE UNIQUE INDEX IF NOT EXISTS idx_atoms_ordinal ON atoms(ordinal);');
+      } catch (indexErr: any) {
+        console.warn("[DB] Could not add atom ordinals:", indexErr.message);
+      }
     } catch (e: any) {
       console.error("[DB] Error initializing atoms table:", e);
       throw e;
@@ -0,0 +1,642 @@
+#include "dir_walker.hpp"
+#include "../worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#ifdef _WIN32
+#include <chrono>
+#include <filesystem>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace ece {
+
+namespace {
+
+bool GlobMatchAt(std::string_view pattern, std::string_view text, size_t p, size_t t, std::vector<bool>* failed);
+
+bool GlobMatchFrom(std::string_view pattern, std::string_view text, size_t p, size_t t, std::vector<bool>* failed) {
+    while (p < pattern.size()) {
+        char c = pattern[p];
+        if (c == '*') {
+            if (p + 1 < pattern.size() && pattern[p + 1] == '*') {
+                p += 2;
+                // "**/" may stand for no directory at all
+                if (p < pattern.size() && pattern[p] == '/' && GlobMatchAt(pattern, text, p + 1, t, failed)) {
+                    return true;
+                }
+                for (size_t k = t; k <= text.size(); ++k) {
+                    if (GlobMatchAt(pattern, text, p, k, failed)) return true;
+                }
+                return false;
+            }
+            ++p;
+            for (size_t k = t;; ++k) {
+                if (GlobMatchAt(pattern, text, p, k, failed)) return true;
+                if (k >= text.size() || text[k] == '/') return false;
+            }
+        }
+        if (t >= text.size()) return false;
+
+        if (c == '?') {
+            if (text[t] == '/') return false;
+            ++p;
+            ++t;
+            continue;
+        }
+        if (c == '[') {
+            size_t q = p + 1;
+            const bool negate = q < pattern.size() && (pattern[q] == '!' || pattern[q] == '^');
+            if (negate) ++q;
+            bool matched = false;
+            bool closed = false;
+            for (bool first = true; q < pattern.size(); first = false) {
+                if (pattern[q] == ']' && !first) {
+                    closed = true;
+                    break;
+                }
+                char lo = pattern[q];
+                char hi = lo;
+                if (q + 2 < pattern.size() && pattern[q + 1] == '-' && pattern[q + 2] != ']') {
+                    hi = pattern[q + 2];
+                    q += 3;
+                } else {
+                    ++q;
+                }
+                if (text[t] >= lo && text[t] <= hi) matched = true;
+            }
+            if (closed) {
+                if (matched == negate || text[t] == '/') return false;
+                p = q + 1;
+                ++t;
+                continue;
+            }
+            // Unclosed '[' is a literal
+        }
+        if (c == '\\' && p + 1 < pattern.size()) c = pattern[++p];
+        if (c != text[t]) return false;
+        ++p;
+        ++t;
+    }
+    return t == text.size();
+}
+
+// (p, t) pairs already known not to match are remembered, so each is tried
+// once: plain backtracking is exponential on patterns like "**/a/**/a/**/b"
+bool GlobMatchAt(std::string_view pattern, std::string_view text, size_t p, size_t t, std::vector<bool>* failed) {
+    const size_t state = p * (text.size() + 1) + t;
+    if ((*failed)[state]) return false;
+    if (GlobMatchFrom(pattern, text, p, t, failed)) return true;
+    (*failed)[state] = true;
+    return false;
+}
+
+} // namespace
+
+bool GlobMatch(std::string_view pattern, std::string_view text) {
+    thread_local std::vector<bool> failed;
+    failed.assign((pattern.size() + 1) * (text.size() + 1), false);
+    return GlobMatchFrom(pattern, text, 0, 0, &failed);
+}
+
+std::vector<std::string> ExpandBraces(std::string_view pattern) {
+    // Find the first top-level {...} and split it on top-level commas
+    size_t open = std::string_view::npos;
+    std::vector<size_t> commas;
+    int depth = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        const char c = pattern[i];
+        if (c == '\\') {
+            ++i;
+        } else if (c == '{') {
+            if (depth++ == 0) open = i;
+        } else if (c == ',' && depth == 1) {
+            commas.push_back(i);
+        } else if (c == '}' && depth > 0 && --depth == 0) {
+            if (commas.empty()) {
+                open = std::string_view::npos; // "{x}" is literal
+                continue;
+            }
+            const std::string_view prefix = pattern.substr(0, open);
+            const std::string_view suffix = pattern.substr(i + 1);
+            std::vector<std::string> result;
+            size_t start = open + 1;
+            commas.push_back(i);
+            for (size_t comma : commas) {
+                std::string alternative(prefix);
+                alternative.append(pattern.substr(start, comma - start));
+                alternative.append(suffix);
+                for (std::string& expanded : ExpandBraces(alternative)) {
+                    if (result.size() < 256) result.push_back(std::move(expanded));
+                }
+                start = comma + 1;
+            }
+            return result;
+        }
+    }
+    return {std::string(pattern)};
+}
+
+namespace {
+
+// --- .gitignore ---
+
+struct IgnoreRule {
+    std::string pattern;
+    bool negate = false;
+    bool dir_only = false;
+    bool anchored = false; // matched against the path below the .gitignore, not the basename
+};
+
+// Rules from one .gitignore, chained to those of the directories above it.
+struct IgnoreRules {
+    std::shared_ptr<const IgnoreRules> parent;
+    std::string base; // directory holding the .gitignore, relative to the root, with trailing '/'
+    std::vector<IgnoreRule> rules;
+};
+
+std::vector<IgnoreRule> ParseGitignore(const std::string& content) {
+    std::vector<IgnoreRule> rules;
+    std::istringstream lines(content);
+    std::string line;
+    while (std::getline(lines, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        IgnoreRule rule;
+        std::string_view text = line;
+        if (text[0] == '!') {
+            rule.negate = true;
+            text.remove_prefix(1);
+        }
+        if (!text.empty() && text.back() == '/') {
+            rule.dir_only = true;
+            text.remove_suffix(1);
+        }
+        if (!text.empty() && text[0] == '/') {
+            rule.anchored = true;
+            text.remove_prefix(1);
+        }
+        if (text.empty()) continue;
+        rule.anchored = rule.anchored || text.find('/') != std::string_view::npos;
+        rule.pattern = std::string(text);
+        rules.push_back(std::move(rule));
+    }
+    return rules;
+}
+
+// Deepest .gitignore first, last matching line wins, as in git.
+bool IsIgnored(const IgnoreRules* rules, std::string_view rel, std::string_view name, bool is_dir) {
+    for (; rules != nullptr; rules = rules->parent.get()) {
+        const std::string_view local = rel.substr(rules->base.size());
+        for (auto it = rules->rules.rbegin(); it != rules->rules.rend(); ++it) {
+            if (it->dir_only && !is_dir) continue;
+            if (GlobMatch(it->pattern, it->anchored ? local : name)) return !it->negate;
+        }
+    }
+    return false;
+}
+
+// --- Directory reading ---
+
+struct RawEntry {
+    std::string name;
+    WalkEntry::Type type = WalkEntry::Type::Other;
+    bool type_known = false;
+};
+
+#ifdef _WIN32
+
+namespace fs = std::filesystem;
+
+class DirHandle {
+public:
+    bool Open(const std::string& root, const std::string& rel) {
+        std::error_code ec;
+        dir_ = rel.empty() ? fs::u8path(root) : fs::u8path(root) / fs::u8path(rel);
+        fs::directory_iterator it(dir_, ec);
+        return !ec;
+    }
+
+    bool ReadAll(std::vector<RawEntry>* entries) {
+        std::error_code ec;
+        for (fs::directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec)) {
+            RawEntry entry;
+            entry.name = it->path().filename().u8string();
+            const fs::file_status status = it->symlink_status(ec);
+            entry.type = TypeOf(status);
+            entry.type_known = true;
+            entries->push_back(std::move(entry));
+        }
+        return !ec;
+    }
+
+    void Stat(const std::string& name, WalkEntry* entry) const {
+        std::error_code ec;
+        const fs::path path = dir_ / fs::u8path(name);
+        if (entry->type == WalkEntry::Type::File) {
+            const uintmax_t size = fs::file_size(path, ec);
+            if (!ec) entry->size = size;
+        }
+        const auto mtime = fs::last_write_time(path, ec);
+        if (!ec) {
+            const auto system = std::chrono::time_point_cast<std::chrono::milliseconds>(
+                mtime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+            entry->mtime_ms = system.time_since_epoch().count();
+        }
+    }
+
+    WalkEntry::Type StatType(const std::string& name) const {
+        std::error_code ec;
+        return TypeOf(fs::symlink_status(dir_ / fs::u8path(name), ec));
+    }
+
+private:
+    static WalkEntry::Type TypeOf(const fs::file_status& status) {
+        if (fs::is_symlink(status)) return WalkEntry::Type::Symlink;
+        if (fs::is_directory(status)) return WalkEntry::Type::Directory;
+        if (fs::is_regular_file(status)) return WalkEntry::Type::File;
+        return WalkEntry::Type::Other;
+    }
+
+    fs::path dir_;
+};
+
+#else
+
+WalkEntry::Type TypeOfMode(mode_t mode) {
+    if (S_ISLNK(mode)) return WalkEntry::Type::Symlink;
+    if (S_ISDIR(mode)) return WalkEntry::Type::Directory;
+    if (S_ISREG(mode)) return WalkEntry::Type::File;
+    return WalkEntry::Type::Other;
+}
+
+#ifdef __linux__
+// Kernel record returned by getdents64; d_name is NUL-terminated within d_reclen.
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+#endif
+
+class DirHandle {
+public:
+    ~DirHandle() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool Open(int root_fd, const std::string& rel) {
+        fd_ = ::openat(root_fd, rel.empty() ? "." : rel.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        return fd_ >= 0;
+    }
+
+    bool ReadAll(std::vector<RawEntry>* entries) {
+#ifdef __linux__
+        // One syscall per 32KB of names instead of one readdir() call per entry
+        thread_local std::unique_ptr<char[]> buffer(new char[kBufferSize]);
+        for (;;) {
+            const long n = ::syscall(SYS_getdents64, fd_, buffer.get(), kBufferSize);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return false;
+            if (n == 0) return true;
+            for (long pos = 0; pos < n;) {
+                const auto* record = reinterpret_cast<const LinuxDirent64*>(buffer.get() + pos);
+                pos += record->d_reclen;
+                RawEntry entry;
+                entry.name = record->d_name;
+                SetType(record->d_type, &entry);
+                entries->push_back(std::move(entry));
+            }
+        }
+#else
+        const int fd = ::dup(fd_);
+        DIR* dir = fd >= 0 ? ::fdopendir(fd) : nullptr;
+        if (dir == nullptr) {
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        while (const dirent* record = ::readdir(dir)) {
+            RawEntry entry;
+            entry.name = record->d_name;
+            SetType(record->d_type, &entry);
+            entries->push_back(std::move(entry));
+        }
+        ::closedir(dir);
+        return true;
+#endif
+    }
+
+    void Stat(const std::string& name, WalkEntry* entry) const {
+        struct stat st;
+        if (::fstatat(fd_, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) return;
+        if (!S_ISDIR(st.st_mode)) entry->size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+        entry->mtime_ms = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000 + st.st_mtimespec.tv_nsec / 1000000;
+#else
+        entry->mtime_ms = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+#endif
+    }
+
+    WalkEntry::Type StatType(const std::string& name) const {
+        struct stat st;
+        if (::fstatat(fd_, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) return WalkEntry::Type::Other;
+        return TypeOfMode(st.st_mode);
+    }
+
+private:
+    static constexpr size_t kBufferSize = 32 * 1024;
+
+    static void SetType(unsigned char d_type, RawEntry* entry) {
+        entry->type_known = d_type != DT_UNKNOWN;
+        entry->type = d_type == DT_DIR ? WalkEntry::Type::Directory
+                    : d_type == DT_REG ? WalkEntry::Type::File
+                    : d_type == DT_LNK ? WalkEntry::Type::Symlink
+                    : WalkEntry::Type::Other;
+    }
+
+    int fd_ = -1;
+};
+
+#endif
+
+std::string ReadGitignore(const std::string& root, const std::string& rel) {
+    std::ifstream file(root + "/" + rel + ".gitignore", std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// --- Work-stealing walk ---
+
+class Walker {
+public:
+    Walker(const std::string& root, const WalkOptions& options)
+        : root_(root), options_(options) {
+        for (const std::string& glob : options_.globs) {
+            for (std::string& pattern : ExpandBraces(glob)) {
+                const bool has_slash = pattern.find('/') != std::string::npos;
+                globs_.push_back({std::move(pattern), has_slash});
+            }
+        }
+    }
+
+    WalkResult Run() {
+        WalkResult result;
+#ifndef _WIN32
+        root_fd_ = ::open(root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (root_fd_ < 0) {
+            result.error = "Cannot open directory - " + root_;
+            return result;
+        }
+#endif
+        if (options_.max_depth == 1) {
+            // One directory: read it on this thread, no pool round-trip
+            queues_ = std::vector<Queue>(1);
+            outputs_.resize(1);
+            Process(0, Task{std::string(), 1, nullptr});
+        } else {
+            const size_t pool = WorkerPool::Shared().Size();
+            const size_t workers = options_.max_workers == 0 ? pool : std::min(options_.max_workers, pool);
+            queues_ = std::vector<Queue>(workers);
+            outputs_.resize(workers);
+
+            Push(0, Task{std::string(), 1, nullptr});
+            WorkerPool::Shared().ParallelFor(workers, [this](size_t worker) { Work(worker); });
+        }
+
+#ifndef _WIN32
+        ::close(root_fd_);
+#endif
+        // Which entries each worker saw depends on timing; the first
+        // max_entries in path order do not
+        for (std::vector<WalkEntry>& output : outputs_) {
+            std::move(output.begin(), output.end(), std::back_inserter(result.entries));
+        }
+        std::sort(result.entries.begin(), result.entries.end(), ByPath);
+        if (result.entries.size() > options_.max_entries) {
+            result.entries.resize(options_.max_entries);
+            truncated_ = true;
+        }
+        result.truncated = truncated_;
+        return result;
+    }
+
+private:
+    struct Task {
+        std::string rel; // directory relative to the root; "" or ending in '/'
+        uint32_t depth;  // depth of the entries inside it
+        std::shared_ptr<const IgnoreRules> rules;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct Glob {
+        std::string pattern;
+        bool has_slash;
+    };
+
+    static bool ByPath(const WalkEntry& a, const WalkEntry& b) {
+        return a.path < b.path;
+    }
+
+    void Push(size_t worker, Task task) {
+        pending_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(queues_[worker].mutex);
+            queues_[worker].tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1);
+        Wake(false);
+    }
+
+    // Taking idle_mutex_ orders the state change before a waiter's check,
+    // so the notification cannot fall between its check and its wait
+    void Wake(bool all) {
+        { std::lock_guard<std::mutex> lock(idle_mutex_); }
+        if (all) idle_.notify_all();
+        else idle_.notify_one();
+    }
+
+    bool Pop(size_t worker, Task* task) {
+        {
+            Queue& own = queues_[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                *task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues_.size(); ++k) {
+            Queue& victim = queues_[(worker + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                *task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Work(size_t worker) {
+        Task task;
+        for (;;) {
+            if (Pop(worker, &task)) {
+                Process(worker, task);
+                if (pending_.fetch_sub(1) == 1) Wake(true); // the walk is done
+                continue;
+            }
+            // Nothing to steal while another worker is still reading a
+            // directory: sleep until it queues more or the walk finishes
+            std::unique_lock<std::mutex> lock(idle_mutex_);
+            idle_.wait(lock, [this] { return queued_.load() > 0 || pending_.load() == 0; });
+            if (pending_.load() == 0) return;
+        }
+    }
+
+    bool Matches(const std::string& rel, std::string_view name) const {
+        if (globs_.empty()) return true;
+        for (const Glob& glob : globs_) {
+            if (GlobMatch(glob.pattern, glob.has_slash ? std::string_view(rel) : name)) return true;
+        }
+        return false;
+    }
+
+    void Process(size_t worker, const Task& task) {
+        DirHandle dir;
+#ifdef _WIN32
+        const bool opened = dir.Open(root_, task.rel);
+#else
+        const bool opened = dir.Open(root_fd_, task.rel);
+#endif
+        std::vector<RawEntry> entries;
+        if (!opened || !dir.ReadAll(&entries)) return; // unreadable subdirectories are skipped
+
+        // Subdirectories are pushed last-name-first so this worker pops them
+        // in path order and the cutoff tightens early
+        std::string cutoff;
+        const bool bounded = Cutoff(&cutoff);
+        if (!task.rel.empty() && bounded && task.rel > cutoff) return; // cut after it was queued
+        std::sort(entries.begin(), entries.end(),
+                  [](const RawEntry& a, const RawEntry& b) { return a.name > b.name; });
+
+        std::shared_ptr<const IgnoreRules> rules = task.rules;
+        if (options_.gitignore) {
+            const bool has_gitignore = std::any_of(entries.begin(), entries.end(),
+                                                   [](const RawEntry& e) { return e.name == ".gitignore"; });
+            if (has_gitignore) {
+                auto local = std::make_shared<IgnoreRules>();
+                local->parent = rules;
+                local->base = task.rel;
+                local->rules = ParseGitignore(ReadGitignore(root_, task.rel));
+                if (!local->rules.empty()) rules = std::move(local);
+            }
+        }
+        const bool descend = options_.max_depth == 0 || task.depth < options_.max_depth;
+
+        for (RawEntry& raw : entries) {
+            if (raw.name == "." || raw.name == "..") continue;
+            if (!options_.include_hidden && raw.name[0] == '.') continue;
+            if (options_.gitignore && raw.name == ".git") continue;
+            if (!raw.type_known) raw.type = dir.StatType(raw.name);
+
+            const bool is_dir = raw.type == WalkEntry::Type::Directory;
+            std::string rel = task.rel + raw.name;
+            if (bounded && rel > cutoff) continue; // and so is everything under it
+            if (rules && IsIgnored(rules.get(), rel, raw.name, is_dir)) continue;
+
+            if (is_dir && descend) {
+                std::string sub = rel + "/";
+                if (!bounded || sub <= cutoff) Push(worker, Task{std::move(sub), task.depth + 1, rules});
+            }
+            if (options_.files_only && (is_dir || raw.type == WalkEntry::Type::Other)) continue;
+            if (!Matches(rel, raw.name)) continue;
+
+            WalkEntry entry;
+            entry.path = std::move(rel);
+            entry.type = raw.type;
+            if (options_.stat) dir.Stat(raw.name, &entry);
+            Emit(worker, std::move(entry));
+        }
+    }
+
+    // Only the first max_entries paths can survive the final cut, so a
+    // worker holding twice that many drops the rest of its own. The last
+    // path it keeps bounds the final cut too: nothing sorting after it is
+    // listed or descended into from then on.
+    void Emit(size_t worker, WalkEntry entry) {
+        std::vector<WalkEntry>& output = outputs_[worker];
+        output.push_back(std::move(entry));
+        const size_t keep = options_.max_entries;
+        if (output.size() <= keep || output.size() - keep <= keep) return;
+        truncated_ = true;
+        if (keep == 0) {
+            output.clear();
+            return;
+        }
+        std::nth_element(output.begin(), output.begin() + (keep - 1), output.end(), ByPath);
+        output.resize(keep);
+        std::lock_guard<std::mutex> lock(cutoff_mutex_);
+        if (!has_cutoff_ || output.back().path < cutoff_) {
+            cutoff_ = output.back().path;
+            has_cutoff_ = true;
+        }
+    }
+
+    bool Cutoff(std::string* cutoff) {
+        if (!has_cutoff_) return false;
+        std::lock_guard<std::mutex> lock(cutoff_mutex_);
+        *cutoff = cutoff_;
+        return true;
+    }
+
+    const std::string root_;
+    const WalkOptions& options_;
+    std::vector<Glob> globs_;
+#ifndef _WIN32
+    int root_fd_ = -1;
+#endif
+    std::vector<Queue> queues_;
+    std::vector<std::vector<WalkEntry>> outputs_; // one per worker; merged and sorted at the end
+    std::atomic<size_t> pending_{0};              // directories queued or being read
+    std::atomic<size_t> queued_{0};               // directories queued, not yet taken
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;                // a directory was queued, or the walk ended
+    std::atomic<bool> truncated_{false};
+    std::mutex cutoff_mutex_;
+    std::string cutoff_;                          // no path after it can make the final cut
+    std::atomic<bool> has_cutoff_{false};
+};
+
+} // namespace
+
+WalkResult WalkDirectory(const std::string& root, const WalkOptions& options) {
+    Walker walker(root, options);
+    return walker.Run();
+}
+
+} // namespace ece
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ece {
+
+// Shell-style match of `text` against `pattern`: '*' and '?' stop at '/',
+// '**' crosses directories ("**/" also matches no directory), '[a-z]' and
+// '[!abc]' are classes and '\' escapes the next character.
+bool GlobMatch(std::string_view pattern, std::string_view text);
+
+// Expands "{a,b}" alternatives (nested allowed) into plain glob patterns.
+std::vector<std::string> ExpandBraces(std::string_view pattern);
+
+struct WalkOptions {
+    uint32_t max_depth = 1;           // 1 = the directory's own entries; 0 = unlimited
+    size_t max_entries = 10000;       // keep the first this many matches, by path
+    bool include_hidden = true;       // dotfiles (".git" is always skipped with gitignore on)
+    bool gitignore = true;            // honour .gitignore files found during the walk
+    bool files_only = false;          // emit regular files and symlinks only
+    bool stat = true;                 // fill size and mtime
+    std::vector<std::string> globs;   // emit only paths matching one of these (no '/' = basename)
+    size_t max_workers = 0;           // 0 = shared pool size
+};
+
+struct WalkEntry {
+    std::string path;                 // relative to the root, '/'-separated
+    enum class Type : uint8_t { File, Directory, Symlink, Other } type = Type::File;
+    uint64_t size = 0;
+    int64_t mtime_ms = 0;
+};
+
+struct WalkResult {
+    std::vector<WalkEntry> entries;   // sorted by path
+    bool truncated = false;           // more than max_entries matched; entries are the first ones
+    std::string error;                // the root itself could not be read
+};
+
+// Lists `root` recursively on the shared worker pool. Each worker owns a
+// deque of directories: it pops its own newest entry (depth-first, warm
+// caches) and steals the oldest from others (large untouched subtrees), and
+// sleeps while there is nothing to steal. A single-level listing is read on
+// the calling thread. Once max_entries matches are in hand, subtrees that
+// sort after the last of them are not read at all.
+// On Linux directories are opened relative to the root with openat() and read
+// with getdents64 in 32KB batches; symlinks are reported but not followed.
+WalkResult WalkDirectory(const std::string& root, const WalkOptions& options);
+
+} // namespace ece
@@ -0,0 +1,128 @@
+#include "file_reader.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <filesystem>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ece {
+
+FileReader::~FileReader() {
+    Close();
+}
+
+#ifdef _WIN32
+
+bool FileReader::Open(const std::string& path, std::string* error) {
+    Close();
+    HANDLE handle = CreateFileW(std::filesystem::u8path(path).wstring().c_str(), GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        *error = "Cannot open file - " + path;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        *error = "Cannot stat file - " + path;
+        return false;
+    }
+    path_ = path;
+    handle_ = handle;
+    size_ = static_cast<uint64_t>(size.QuadPart);
+    return true;
+}
+
+void FileReader::Close() {
+    if (handle_ != nullptr) CloseHandle(handle_);
+    handle_ = nullptr;
+    size_ = 0;
+}
+
+bool FileReader::Read(uint64_t offset, uint64_t length, std::string* out, std::string* error) const {
+    if (offset >= size_) return true;
+    length = std::min(length, size_ - offset);
+    const size_t start = out->size();
+    out->resize(start + static_cast<size_t>(length));
+    size_t done = 0;
+    while (done < length) {
+        OVERLAPPED at = {};
+        const uint64_t position = offset + done;
+        at.Offset = static_cast<DWORD>(position);
+        at.OffsetHigh = static_cast<DWORD>(position >> 32);
+        const DWORD want = static_cast<DWORD>(std::min<uint64_t>(length - done, 1u << 30));
+        DWORD got = 0;
+        if (!ReadFile(handle_, &(*out)[start + done], want, &got, &at)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) break;
+            out->resize(start);
+            *error = "Cannot read file - " + path_;
+            return false;
+        }
+        if (got == 0) break;
+        done += got;
+    }
+    out->resize(start + done);
+    return true;
+}
+
+#else
+
+bool FileReader::Open(const std::string& path, std::string* error) {
+    Close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = "Cannot open file - " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        *error = "Cannot stat file - " + path + " (" + std::strerror(errno) + ")";
+        ::close(fd);
+        return false;
+    }
+    path_ = path;
+    fd_ = fd;
+    size_ = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+void FileReader::Close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    size_ = 0;
+}
+
+bool FileReader::Read(uint64_t offset, uint64_t length, std::string* out, std::string* error) const {
+    if (offset >= size_) return true;
+    length = std::min(length, size_ - offset);
+    const size_t start = out->size();
+    out->resize(start + static_cast<size_t>(length));
+    size_t done = 0;
+    while (done < length) {
+        const ssize_t got = ::pread(fd_, &(*out)[start + done], static_cast<size_t>(length - done),
+                                    static_cast<off_t>(offset + done));
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            out->resize(start);
+            *error = "Cannot read file - " + path_ + " (" + std::strerror(errno) + ")";
+            return false;
+        }
+        if (got == 0) break; // truncated since Open
+        done += static_cast<size_t>(got);
+    }
+    out->resize(start + done);
+    return true;
+}
+
+#endif
+
+} // namespace ece
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ece {
+
+// Positional reads (pread / ReadFile) of a file the engine does not own:
+// workspace files and mirrored copies that other processes rewrite in place.
+// Such files are copied out, never mapped - touching a mapped page past the
+// end of a file someone truncated raises SIGBUS and takes the whole Node
+// process down. A file that shrinks while open just reads short.
+class FileReader {
+public:
+    FileReader() = default;
+    ~FileReader();
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    bool Open(const std::string& path, std::string* error);
+    void Close();
+
+    // Size when opened; reads never go past it.
+    uint64_t size() const { return size_; }
+
+    // Appends up to `length` bytes from `offset` to *out, fewer at the end
+    // of the file.
+    bool Read(uint64_t offset, uint64_t length, std::string* out, std::string* error) const;
+    bool ReadAll(std::string* out, std::string* error) const { return Read(0, size_, out, error); }
+
+private:
+    std::string path_;
+    uint64_t size_ = 0;
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+} // namespace ece
@@ -0,0 +1,292 @@
+#include "file_writer.hpp"
+#include "../worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <set>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ece {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<uint64_t> g_temp_sequence{0};
+
+struct PendingWrite {
+    std::string target; // symlinks resolved
+    std::string temp;   // empty for appends
+    std::string error;
+};
+
+std::string ParentDirectory(const std::string& path) {
+    const std::string parent = fs::u8path(path).parent_path().u8string();
+    return parent.empty() ? "." : parent;
+}
+
+std::string TempPathFor(const std::string& target) {
+    const fs::path p = fs::u8path(target);
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = static_cast<int>(::getpid());
+#endif
+    const std::string name = "." + p.filename().u8string() + "." + std::to_string(pid) + "." +
+                             std::to_string(g_temp_sequence.fetch_add(1)) + ".tmp";
+    return (p.parent_path() / fs::u8path(name)).u8string();
+}
+
+// Writes to the destination of a symlink rather than replacing the link.
+std::string ResolveTarget(const std::string& path) {
+    std::error_code ec;
+    const fs::path p = fs::u8path(path);
+    if (fs::is_symlink(fs::symlink_status(p, ec))) {
+        const fs::path resolved = fs::weakly_canonical(p, ec);
+        if (!ec) return resolved.u8string();
+    }
+    return path;
+}
+
+#ifdef _WIN32
+
+// Paths are UTF-8; the ANSI (A) APIs would read them in the active code page
+std::wstring WidePath(const std::string& path) {
+    return fs::u8path(path).wstring();
+}
+
+std::string LastError(const std::string& what, const std::string& path) {
+    return what + " - " + path + " (error " + std::to_string(GetLastError()) + ")";
+}
+
+bool WriteHandle(HANDLE file, const std::string& content, bool durable, const std::string& path, std::string* error) {
+    size_t done = 0;
+    while (done < content.size()) {
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(content.size() - done, 1u << 30));
+        DWORD written = 0;
+        if (!::WriteFile(file, content.data() + done, chunk, &written, nullptr)) {
+            *error = LastError("Cannot write file", path);
+            return false;
+        }
+        done += written;
+    }
+    if (durable && !FlushFileBuffers(file)) {
+        *error = LastError("Cannot flush file", path);
+        return false;
+    }
+    return true;
+}
+
+bool WriteTemp(const std::string& temp, const std::string& target, const std::string& content, bool durable, std::string* error) {
+    (void)target; // new files inherit the directory's ACL
+    HANDLE file = CreateFileW(WidePath(temp).c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        *error = LastError("Cannot create/write file", temp);
+        return false;
+    }
+    const bool ok = WriteHandle(file, content, durable, temp, error);
+    CloseHandle(file);
+    return ok;
+}
+
+bool Commit(const std::string& temp, const std::string& target, std::string* error) {
+    if (!MoveFileExW(WidePath(temp).c_str(), WidePath(target).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        *error = LastError("Cannot replace file", target);
+        return false;
+    }
+    return true;
+}
+
+bool Append(const std::string& target, const std::string& content, bool durable, std::string* error) {
+    HANDLE file = CreateFileW(WidePath(target).c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        *error = LastError("Cannot open file for append", target);
+        return false;
+    }
+    const bool ok = WriteHandle(file, content, durable, target, error);
+    CloseHandle(file);
+    return ok;
+}
+
+// Directory entries are durable once MoveFileEx returns with WRITE_THROUGH.
+bool SyncDirectory(const std::string&, std::string*) {
+    return true;
+}
+
+void RemoveTemp(const std::string& temp) {
+    DeleteFileW(WidePath(temp).c_str());
+}
+
+#else
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+    return what + " - " + path + " (" + std::strerror(errno) + ")";
+}
+
+bool WriteFd(int fd, const std::string& content, bool durable, const std::string& path, std::string* error) {
+    size_t done = 0;
+    while (done < content.size()) {
+        const ssize_t n = ::write(fd, content.data() + done, content.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            *error = ErrnoMessage("Cannot write file", path);
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+#ifdef __linux__
+    if (durable && ::fdatasync(fd) != 0) {
+#else
+    if (durable && ::fsync(fd) != 0) {
+#endif
+        *error = ErrnoMessage("Cannot sync file", path);
+        return false;
+    }
+    return true;
+}
+
+bool CloseFd(int fd, const std::string& path, std::string* error) {
+    if (::close(fd) != 0 && errno != EINTR) {
+        *error = ErrnoMessage("Cannot close file", path);
+        return false;
+    }
+    return true;
+}
+
+bool WriteTemp(const std::string& temp, const std::string& target, const std::string& content, bool durable, std::string* error) {
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        *error = ErrnoMessage("Cannot create/write file", temp);
+        return false;
+    }
+    // Replacing keeps the old file's permissions
+    struct stat st;
+    if (::stat(target.c_str(), &st) == 0) ::fchmod(fd, st.st_mode & 07777);
+
+    const bool written = WriteFd(fd, content, durable, temp, error);
+    std::string close_error;
+    const bool closed = CloseFd(fd, temp, &close_error);
+    if (written && !closed) *error = close_error;
+    return written && closed;
+}
+
+bool Commit(const std::string& temp, const std::string& target, std::string* error) {
+    if (::rename(temp.c_str(), target.c_str()) != 0) {
+        *error = ErrnoMessage("Cannot replace file", target);
+        return false;
+    }
+    return true;
+}
+
+bool Append(const std::string& target, const std::string& content, bool durable, std::string* error) {
+    const int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        *error = ErrnoMessage("Cannot open file for append", target);
+        return false;
+    }
+    const bool written = WriteFd(fd, content, durable, target, error);
+    std::string close_error;
+    const bool closed = CloseFd(fd, target, &close_error);
+    if (written && !closed) *error = close_error;
+    return written && closed;
+}
+
+// Makes renames and newly created names in `dir` survive a crash.
+bool SyncDirectory(const std::string& dir, std::string* error) {
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = ErrnoMessage("Cannot open directory", dir);
+        return false;
+    }
+    const bool ok = ::fsync(fd) == 0 || errno == EINVAL; // some filesystems can't sync directories
+    if (!ok) *error = ErrnoMessage("Cannot sync directory", dir);
+    ::close(fd);
+    return ok;
+}
+
+void RemoveTemp(const std::string& temp) {
+    ::unlink(temp.c_str());
+}
+
+#endif
+
+} // namespace
+
+WriteBatchResult WriteFilesAtomic(const std::vector<FileWrite>& writes, bool durable) {
+    WriteBatchResult result;
+    std::vector<PendingWrite> pending(writes.size());
+
+    // 1. Stage replacements in temp files, in parallel; appends wait for commit
+    WorkerPool::Shared().ParallelFor(writes.size(), [&](size_t i) {
+        PendingWrite& p = pending[i];
+        try {
+            p.target = ResolveTarget(writes[i].path);
+            const fs::path parent = fs::u8path(p.target).parent_path();
+            if (!parent.empty()) fs::create_directories(parent);
+            if (writes[i].append) return;
+
+            p.temp = TempPathFor(p.target);
+            if (!WriteTemp(p.temp, p.target, writes[i].content, durable, &p.error)) {
+                RemoveTemp(p.temp);
+                p.temp.clear();
+            }
+        } catch (const std::exception& e) {
+            p.error = "Cannot create/write file - " + writes[i].path + " (" + e.what() + ")";
+        }
+    });
+
+    for (const PendingWrite& p : pending) {
+        if (!p.error.empty()) {
+            result.error = p.error;
+            break;
+        }
+    }
+    if (!result.error.empty()) {
+        for (const PendingWrite& p : pending) {
+            if (!p.temp.empty()) RemoveTemp(p.temp);
+        }
+        return result;
+    }
+
+    // 2. Commit in request order, so a later write to the same path wins.
+    // A failure here stops the batch; files already committed keep their
+    // new content
+    std::set<std::string> directories;
+    for (size_t i = 0; i < writes.size(); ++i) {
+        PendingWrite& p = pending[i];
+        const bool ok = writes[i].append ? Append(p.target, writes[i].content, durable, &result.error)
+                                         : Commit(p.temp, p.target, &result.error);
+        if (!ok) {
+            for (size_t j = i; j < writes.size(); ++j) {
+                if (!pending[j].temp.empty()) RemoveTemp(pending[j].temp);
+            }
+            return result;
+        }
+        ++result.files;
+        result.bytes += writes[i].content.size();
+        directories.insert(ParentDirectory(p.target));
+    }
+
+    // 3. One directory sync per directory, not per file
+    if (durable) {
+        for (const std::string& dir : directories) {
+            if (!SyncDirectory(dir, &result.error)) return result;
+        }
+    }
+    result.directories = directories.size();
+    return result;
+}
+
+} // namespace ece
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ece {
+
+struct FileWrite {
+    std::string path;
+    std::string content;
+    bool append = false;
+};
+
+struct WriteBatchResult {
+    size_t files = 0;       // files committed
+    size_t bytes = 0;
+    size_t directories = 0; // directories synced
+    std::string error;      // first failure; if staging failed, nothing was touched,
+                            // otherwise the first `files` writes were committed
+};
+
+// Writes a batch so each file is either its old or its new content, never a
+// torn mix, even across a crash:
+//   1. every replacement goes to a temp file next to its target (same mode),
+//      in parallel on the shared worker pool, and is fdatasync'd when
+//      `durable`;
+//   2. only if all temps succeeded are they renamed over their targets, in
+//      order; a failed rename (or append) stops there, leaving the earlier
+//      targets replaced and the later ones untouched - a batch is not a
+//      transaction;
+//   3. each touched directory is fsync'd once, however many files it holds.
+// Appends go straight to the target with O_APPEND (a crash can only lose the
+// tail being added) and are synced with the same pass. A symlinked target
+// has its destination replaced, not the link.
+WriteBatchResult WriteFilesAtomic(const std::vector<FileWrite>& writes, bool durable = true);
+
+} // namespace ece
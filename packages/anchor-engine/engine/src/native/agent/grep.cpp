@@ -0,0 +1,427 @@
+#include "grep.hpp"
+#include "file_reader.hpp"
+#include "../worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+#ifdef USE_RE2
+#include <re2/re2.h>
+#else
+#include <regex>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define ECE_GREP_SIMD 1
+#endif
+
+namespace ece {
+
+namespace {
+
+constexpr size_t kNpos = std::string::npos;
+constexpr size_t kBinaryProbe = 8192;
+
+char FoldAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool IsAsciiLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool EqualAt(const char* text, std::string_view needle, bool fold) {
+    if (!fold) return std::memcmp(text, needle.data(), needle.size()) == 0;
+    for (size_t i = 0; i < needle.size(); ++i) {
+        if (FoldAscii(text[i]) != needle[i]) return false;
+    }
+    return true;
+}
+
+// First occurrence of `needle` in text[from..) or kNpos. Candidates are
+// positions whose first and last bytes both match, tested 32 (or 16) at a
+// time; with `fold` the needle is lowercase and letters compare with bit 5
+// set. Only candidates are compared in full.
+size_t FindLiteral(std::string_view text, size_t from, std::string_view needle, bool fold) {
+    const size_t n = needle.size();
+    if (n == 0) return from <= text.size() ? from : kNpos;
+    if (text.size() < n) return kNpos;
+
+    const char first = needle[0];
+    const char last = needle[n - 1];
+    const char* data = text.data();
+    const size_t limit = text.size() - n + 1; // candidate starts are < limit
+    size_t i = from;
+
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    {
+        const __m256i v_first = _mm256_set1_epi8(first);
+        const __m256i v_last = _mm256_set1_epi8(last);
+        const __m256i fold_first = _mm256_set1_epi8(fold && IsAsciiLetter(first) ? 0x20 : 0);
+        const __m256i fold_last = _mm256_set1_epi8(fold && IsAsciiLetter(last) ? 0x20 : 0);
+        for (; i + 32 <= limit; i += 32) {
+            const __m256i head = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), fold_first);
+            const __m256i tail = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + n - 1)), fold_last);
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(head, v_first), _mm256_cmpeq_epi8(tail, v_last))));
+            while (mask != 0) {
+                const size_t candidate = i + __builtin_ctz(mask);
+                if (EqualAt(data + candidate, needle, fold)) return candidate;
+                mask &= mask - 1;
+            }
+        }
+    }
+#elif defined(ECE_GREP_SIMD) && !defined(_MSC_VER)
+    {
+        const __m128i v_first = _mm_set1_epi8(first);
+        const __m128i v_last = _mm_set1_epi8(last);
+        const __m128i fold_first = _mm_set1_epi8(fold && IsAsciiLetter(first) ? 0x20 : 0);
+        const __m128i fold_last = _mm_set1_epi8(fold && IsAsciiLetter(last) ? 0x20 : 0);
+        for (; i + 16 <= limit; i += 16) {
+            const __m128i head = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), fold_first);
+            const __m128i tail = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1)), fold_last);
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(head, v_first), _mm_cmpeq_epi8(tail, v_last))));
+            while (mask != 0) {
+                const size_t candidate = i + __builtin_ctz(mask);
+                if (EqualAt(data + candidate, needle, fold)) return candidate;
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+    for (; i < limit; ++i) {
+        if ((fold ? FoldAscii(data[i]) : data[i]) == first && EqualAt(data + i, needle, fold)) return i;
+    }
+    return kNpos;
+}
+
+// Longest run of plain characters that every match of `pattern` contains,
+// or "" when none can be proven (alternation, inline flags, ...).
+std::string RequiredLiteral(std::string_view pattern) {
+    if (pattern.find('|') != std::string_view::npos || pattern.find("(?") != std::string_view::npos) return {};
+
+    std::string best;
+    std::string run;
+    int depth = 0;
+    auto flush = [&] {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        const char c = pattern[i];
+        const char next = i + 1 < pattern.size() ? pattern[i + 1] : '\0';
+        char literal = 0;
+        bool is_literal = false;
+
+        if (c == '\\') {
+            if (i + 1 >= pattern.size()) break;
+            ++i;
+            // \d, \w, \b, \x41 ... are classes or escapes we don't decode
+            if (std::isalnum(static_cast<unsigned char>(next))) {
+                flush();
+                continue;
+            }
+            literal = next;
+            is_literal = true;
+        } else if (c == '[') {
+            flush();
+            size_t j = i + 1;
+            if (j < pattern.size() && pattern[j] == '^') ++j;
+            if (j < pattern.size() && pattern[j] == ']') ++j;
+            while (j < pattern.size() && pattern[j] != ']') j += pattern[j] == '\\' ? 2 : 1;
+            i = j;
+            continue;
+        } else if (c == '(') {
+            flush();
+            ++depth;
+            continue;
+        } else if (c == ')') {
+            flush();
+            --depth;
+            continue;
+        } else if (std::strchr(".^$*+?{}", c) != nullptr) {
+            flush();
+            continue;
+        } else {
+            literal = c;
+            is_literal = true;
+        }
+
+        if (!is_literal || depth > 0) {
+            flush();
+            continue;
+        }
+        const char quantifier = i + 1 < pattern.size() ? pattern[i + 1] : '\0';
+        if (quantifier == '?' || quantifier == '*' || quantifier == '{') {
+            flush(); // this character is optional
+        } else {
+            run.push_back(literal);
+            if (quantifier == '+') flush();
+        }
+    }
+    flush();
+    return best;
+}
+
+bool HasRegexSyntax(std::string_view pattern) {
+    return pattern.find_first_of("\\.^$*+?()[]{}|") != std::string_view::npos;
+}
+
+size_t LineStart(std::string_view text, size_t pos) {
+    while (pos > 0 && text[pos - 1] != '\n') --pos;
+    return pos;
+}
+
+size_t LineEnd(std::string_view text, size_t pos) {
+    const void* nl = std::memchr(text.data() + pos, '\n', text.size() - pos);
+    return nl ? static_cast<size_t>(static_cast<const char*>(nl) - text.data()) : text.size();
+}
+
+class Matcher {
+public:
+    bool Compile(const std::string& pattern, const GrepOptions& options, std::string* error) {
+        fold_ = options.ignore_case;
+        regex_ = !options.fixed_strings && HasRegexSyntax(pattern);
+        literal_ = regex_ ? RequiredLiteral(pattern) : pattern;
+        if (fold_) {
+            // Folding only covers ASCII; a non-ASCII literal would miss case variants
+            if (std::any_of(literal_.begin(), literal_.end(), [](char c) { return static_cast<unsigned char>(c) >= 0x80; })) {
+                regex_ = true;
+                literal_.clear();
+            }
+            std::transform(literal_.begin(), literal_.end(), literal_.begin(), FoldAscii);
+        }
+        if (!regex_) {
+            if (literal_.empty()) {
+                *error = "Empty pattern";
+                return false;
+            }
+            return true;
+        }
+
+        // A literal that only needs case folding beyond ASCII still goes
+        // through the regex engine, quoted
+        const std::string source = options.fixed_strings ? Quote(pattern) : pattern;
+#ifdef USE_RE2
+        RE2::Options re_options;
+        re_options.set_case_sensitive(!options.ignore_case);
+        re_options.set_log_errors(false);
+        re_ = std::make_unique<RE2>("(?m)" + source, re_options);
+        if (!re_->ok()) {
+            std::string detail = re_->error();
+            const size_t prefix = detail.find("(?m)");
+            if (prefix != std::string::npos) detail.erase(prefix, 4);
+            *error = "Invalid pattern - " + detail;
+            return false;
+        }
+#else
+        try {
+            auto flags = std::regex::ECMAScript | std::regex::optimize;
+            if (options.ignore_case) flags |= std::regex::icase;
+            re_ = std::regex(source, flags);
+        } catch (const std::regex_error& e) {
+            *error = "Invalid pattern - " + std::string(e.what());
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    // First match at or after `from` (always a line start); [*start, *end).
+    bool Find(std::string_view text, size_t from, size_t* start, size_t* end) const {
+        if (!regex_) {
+            const size_t pos = FindLiteral(text, from, literal_, fold_);
+            if (pos == kNpos) return false;
+            *start = pos;
+            *end = pos + literal_.size();
+            return true;
+        }
+
+        if (!literal_.empty()) {
+            // Only lines holding the required literal can match
+            while (from < text.size()) {
+                const size_t candidate = FindLiteral(text, from, literal_, fold_);
+                if (candidate == kNpos) return false;
+                const size_t line_end = LineEnd(text, candidate);
+                if (MatchLine(text, LineStart(text, candidate), line_end, start, end)) return true;
+                from = line_end + 1;
+            }
+            return false;
+        }
+
+#ifdef USE_RE2
+        re2::StringPiece match;
+        if (!re_->Match(re2::StringPiece(text.data(), text.size()), from, text.size(), RE2::UNANCHORED, &match, 1)) {
+            return false;
+        }
+        *start = static_cast<size_t>(match.data() - text.data());
+        *end = *start + match.size();
+        return true;
+#else
+        while (from < text.size()) {
+            const size_t line_end = LineEnd(text, from);
+            if (MatchLine(text, from, line_end, start, end)) return true;
+            from = line_end + 1;
+        }
+        return false;
+#endif
+    }
+
+private:
+    static std::string Quote(const std::string& literal) {
+        std::string quoted;
+        for (char c : literal) {
+            if (std::strchr("\\.^$*+?()[]{}|", c) != nullptr) quoted.push_back('\\');
+            quoted.push_back(c);
+        }
+        return quoted;
+    }
+
+    bool MatchLine(std::string_view text, size_t line_start, size_t line_end, size_t* start, size_t* end) const {
+#ifdef USE_RE2
+        re2::StringPiece match;
+        if (!re_->Match(re2::StringPiece(text.data(), text.size()), line_start, line_end, RE2::UNANCHORED, &match, 1)) {
+            return false;
+        }
+        *start = static_cast<size_t>(match.data() - text.data());
+        *end = *start + match.size();
+#else
+        std::cmatch match;
+        if (!std::regex_search(text.data() + line_start, text.data() + line_end, match, re_)) return false;
+        *start = line_start + static_cast<size_t>(match.position(0));
+        *end = *start + static_cast<size_t>(match.length(0));
+#endif
+        return true;
+    }
+
+    std::string literal_; // whole pattern, or the prefilter for a regex
+    bool fold_ = false;
+    bool regex_ = false;
+#ifdef USE_RE2
+    std::unique_ptr<RE2> re_;
+#else
+    std::regex re_;
+#endif
+};
+
+// The matching line, cut to `limit` bytes around the match on UTF-8 boundaries.
+std::string Snippet(std::string_view text, size_t line_start, size_t line_end, size_t match, size_t limit) {
+    if (line_end > line_start && text[line_end - 1] == '\r') --line_end;
+    size_t begin = line_start;
+    size_t end = line_end;
+    if (limit > 0 && end - begin > limit) {
+        begin = std::max(line_start, match > limit / 4 ? match - limit / 4 : 0);
+        end = std::min(line_end, begin + limit);
+        while (begin < end && (static_cast<unsigned char>(text[begin]) & 0xC0) == 0x80) ++begin;
+        while (end > begin && end < line_end && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80) --end;
+    }
+    return std::string(text.substr(begin, end - begin));
+}
+
+// Hits in one file, at most `cap`.
+void SearchFile(const std::string& full_path, const std::string& display_path, const Matcher& matcher,
+                const GrepOptions& options, size_t cap, std::vector<GrepHit>* hits) {
+    // Read rather than mapped, since the tree may be edited mid-search; the
+    // binary probe is read first so binary files cost only those bytes
+    FileReader file;
+    std::string error;
+    if (!file.Open(full_path, &error) || file.size() > options.max_file_size) return;
+    std::string buffer;
+    if (!file.Read(0, kBinaryProbe, &buffer, &error) || std::memchr(buffer.data(), '\0', buffer.size()) != nullptr ||
+        !file.Read(buffer.size(), file.size(), &buffer, &error)) {
+        return;
+    }
+    const std::string_view data = buffer;
+
+    size_t from = 0;
+    size_t counted = 0; // newlines are counted up to here
+    uint64_t line = 1;
+    size_t start, end;
+    while (hits->size() < cap && from < data.size() && matcher.Find(data, from, &start, &end)) {
+        line += static_cast<uint64_t>(std::count(data.data() + counted, data.data() + start, '\n'));
+        counted = start;
+        const size_t line_start = LineStart(data, start);
+        const size_t line_end = LineEnd(data, start);
+
+        GrepHit hit;
+        hit.path = display_path;
+        hit.line = line;
+        hit.byte_offset = start;
+        hit.snippet = Snippet(data, line_start, line_end, start, options.snippet_bytes);
+        hits->push_back(std::move(hit));
+
+        if (line_end >= data.size()) break;
+        from = line_end + 1; // one hit per line
+    }
+}
+
+} // namespace
+
+GrepResult Grep(const std::string& root, const std::string& pattern, const GrepOptions& options) {
+    GrepResult result;
+    Matcher matcher;
+    if (!matcher.Compile(pattern, options, &result.error)) return result;
+
+    // A single file is searched as-is and reported under the path given
+    std::vector<std::string> files;
+    std::string prefix;
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(std::filesystem::u8path(root), ec)) {
+        files.push_back(root);
+    } else {
+        WalkOptions walk = options.walk;
+        walk.files_only = true;
+        walk.stat = false;
+        WalkResult tree = WalkDirectory(root, walk);
+        if (!tree.error.empty()) {
+            result.error = tree.error;
+            return result;
+        }
+        files.reserve(tree.entries.size());
+        for (WalkEntry& entry : tree.entries) files.push_back(std::move(entry.path));
+        prefix = root.empty() || root.back() == '/' ? root : root + "/";
+        result.truncated = tree.truncated;
+    }
+
+    // Collect one past each limit so truncation is visible. Files are handed
+    // out in path order, so once the running total passes the limit every
+    // file not yet started sorts after all the hits that will be kept.
+    const size_t limit = options.max_matches;
+    const size_t per_file_cap = options.max_per_file > 0 ? options.max_per_file + 1 : SIZE_MAX;
+    const size_t cap = std::min(per_file_cap, limit + 1);
+    std::vector<std::vector<GrepHit>> per_file(files.size());
+    std::atomic<size_t> found{0};
+    std::atomic<size_t> searched{0};
+    std::atomic<bool> file_truncated{false};
+    WorkerPool::Shared().ParallelFor(files.size(), [&](size_t i) {
+        if (found.load(std::memory_order_relaxed) > limit) return;
+        std::vector<GrepHit>& hits = per_file[i];
+        SearchFile(prefix + files[i], files[i], matcher, options, cap, &hits);
+        if (options.max_per_file > 0 && hits.size() > options.max_per_file) {
+            hits.resize(options.max_per_file);
+            file_truncated.store(true);
+        }
+        found.fetch_add(hits.size());
+        searched.fetch_add(1);
+    }, options.walk.max_workers);
+
+    result.truncated = result.truncated || file_truncated.load();
+    for (std::vector<GrepHit>& hits : per_file) {
+        for (GrepHit& hit : hits) {
+            if (result.hits.size() == limit) {
+                result.truncated = true;
+                break;
+            }
+            result.hits.push_back(std::move(hit));
+        }
+    }
+    result.files_searched = searched.load();
+    return result;
+}
+
+} // namespace ece
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "dir_walker.hpp"
+
+namespace ece {
+
+struct GrepOptions {
+    bool ignore_case = false;
+    bool fixed_strings = false;       // pattern is a literal, not a regex
+    size_t max_matches = 200;         // across all files
+    size_t max_per_file = 0;          // 0 = only max_matches applies
+    size_t max_file_size = 64 << 20;  // larger files are skipped
+    size_t snippet_bytes = 200;       // longer lines are cut around the match
+    WalkOptions walk;                 // which files to search (globs, gitignore, depth)
+};
+
+struct GrepHit {
+    std::string path;                 // relative to the searched directory
+    uint64_t line = 0;                // 1-based
+    uint64_t byte_offset = 0;         // of the match within the file
+    std::string snippet;              // the matching line
+};
+
+struct GrepResult {
+    std::vector<GrepHit> hits;        // in path order, then file order
+    size_t files_searched = 0;
+    bool truncated = false;           // a match limit was reached
+    std::string error;                // bad pattern or unreadable root
+};
+
+// Line-oriented search of every file under `root` (or `root` itself when it
+// is a file), one hit per matching line. Files are read (never mapped: the
+// tree may be truncated under us) and searched in parallel on the shared
+// worker pool; binary files (a NUL in the first 8KB) are skipped. Literal patterns, and the longest literal every regex
+// match must contain, are located with an AVX2/SSE2 first/last-byte scan, so
+// the regex engine (RE2 when built with USE_RE2, std::regex otherwise) only
+// sees candidate lines.
+GrepResult Grep(const std::string& root, const std::string& pattern, const GrepOptions& options);
+
+} // namespace ece
@@ -0,0 +1,398 @@
+#include "json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+
+namespace ece {
+
+namespace {
+
+constexpr size_t kBlockSize = 16 * 1024;
+constexpr int kMaxDepth = 256;
+
+int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void AppendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+} // namespace
+
+// --- JsonValue ---
+
+const JsonValue* JsonValue::Find(std::string_view key) const {
+    if (type != Type::Object) return nullptr;
+    for (uint32_t i = 0; i < size; ++i) {
+        if (keys[i] == key) return &items[i];
+    }
+    return nullptr;
+}
+
+std::string_view JsonValue::GetString(std::string_view key, std::string_view fallback) const {
+    const JsonValue* value = Find(key);
+    return value && value->IsString() ? value->string : fallback;
+}
+
+// Saturates at the int64 range (casting a double outside it is undefined);
+// NaN and infinities count as missing.
+int64_t JsonValue::GetInt(std::string_view key, int64_t fallback) const {
+    const JsonValue* value = Find(key);
+    if (!value || !value->IsNumber() || !std::isfinite(value->number)) return fallback;
+    constexpr double kLimit = 9223372036854775808.0; // 2^63
+    if (value->number >= kLimit) return std::numeric_limits<int64_t>::max();
+    if (value->number <= -kLimit) return std::numeric_limits<int64_t>::min();
+    return static_cast<int64_t>(value->number);
+}
+
+bool JsonValue::GetBool(std::string_view key, bool fallback) const {
+    const JsonValue* value = Find(key);
+    return value && value->IsBool() ? value->boolean : fallback;
+}
+
+// --- Parser ---
+
+class JsonDocument::Parser {
+public:
+    Parser(JsonDocument* doc, std::string_view text) : doc_(doc), text_(text) {}
+
+    bool Run(JsonValue* root, std::string* error) {
+        SkipSpace();
+        if (!ParseValue(root, 0)) {
+            *error = error_ + " at offset " + std::to_string(pos_);
+            return false;
+        }
+        SkipSpace();
+        if (pos_ != text_.size()) {
+            *error = "Unexpected trailing characters at offset " + std::to_string(pos_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool Fail(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    void SkipSpace() {
+        while (pos_ < text_.size()) {
+            const char c = text_[pos_];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+            ++pos_;
+        }
+    }
+
+    bool Consume(std::string_view literal) {
+        if (text_.compare(pos_, literal.size(), literal) != 0) return false;
+        pos_ += literal.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue* out, int depth) {
+        if (pos_ >= text_.size()) return Fail("Unexpected end of input");
+        switch (text_[pos_]) {
+            case '{': return ParseObject(out, depth);
+            case '[': return ParseArray(out, depth);
+            case '"':
+                out->type = JsonValue::Type::String;
+                return ParseString(&out->string);
+            case 't':
+                if (!Consume("true")) return Fail("Invalid literal");
+                out->type = JsonValue::Type::Bool;
+                out->boolean = true;
+                return true;
+            case 'f':
+                if (!Consume("false")) return Fail("Invalid literal");
+                out->type = JsonValue::Type::Bool;
+                return true;
+            case 'n':
+                if (!Consume("null")) return Fail("Invalid literal");
+                out->type = JsonValue::Type::Null;
+                return true;
+            default:
+                return ParseNumber(out);
+        }
+    }
+
+    bool ParseNumber(JsonValue* out) {
+        const size_t start = pos_;
+        if (pos_ < text_.size() && text_[pos_] == '-') ++pos_;
+        const size_t digits = pos_;
+        while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') ++pos_;
+        if (pos_ == digits) return Fail("Unexpected character");
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            ++pos_;
+            const size_t fraction = pos_;
+            while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') ++pos_;
+            if (pos_ == fraction) return Fail("Invalid number");
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) ++pos_;
+            const size_t exponent = pos_;
+            while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') ++pos_;
+            if (pos_ == exponent) return Fail("Invalid number");
+        }
+
+        // strtod needs a terminator; numbers long enough to overflow the
+        // buffer carry no extra precision anyway.
+        char buf[64];
+        const size_t len = std::min(pos_ - start, sizeof(buf) - 1);
+        std::memcpy(buf, text_.data() + start, len);
+        buf[len] = '\0';
+        out->type = JsonValue::Type::Number;
+        out->number = std::strtod(buf, nullptr);
+        return true;
+    }
+
+    // Unescaped strings are returned as views into the input; only strings
+    // with escapes are decoded into the arena. Raw control characters are
+    // tolerated because model-generated tool calls often contain them.
+    bool ParseString(std::string_view* out) {
+        const size_t start = ++pos_;
+        while (pos_ < text_.size() && text_[pos_] != '"' && text_[pos_] != '\\') ++pos_;
+        if (pos_ >= text_.size()) return Fail("Unterminated string");
+        if (text_[pos_] == '"') {
+            *out = text_.substr(start, pos_ - start);
+            ++pos_;
+            return true;
+        }
+
+        scratch_.assign(text_.data() + start, pos_ - start);
+        while (pos_ < text_.size()) {
+            const size_t run = pos_;
+            while (pos_ < text_.size() && text_[pos_] != '"' && text_[pos_] != '\\') ++pos_;
+            scratch_.append(text_.data() + run, pos_ - run);
+            if (pos_ >= text_.size()) break;
+
+            const char c = text_[pos_++];
+            if (c == '"') {
+                char* data = static_cast<char*>(doc_->Allocate(scratch_.size(), 1));
+                std::memcpy(data, scratch_.data(), scratch_.size());
+                *out = std::string_view(data, scratch_.size());
+                return true;
+            }
+            if (pos_ >= text_.size()) break;
+            switch (text_[pos_++]) {
+                case '"': scratch_.push_back('"'); break;
+                case '\\': scratch_.push_back('\\'); break;
+                case '/': scratch_.push_back('/'); break;
+                case 'b': scratch_.push_back('\b'); break;
+                case 'f': scratch_.push_back('\f'); break;
+                case 'n': scratch_.push_back('\n'); break;
+                case 'r': scratch_.push_back('\r'); break;
+                case 't': scratch_.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!ParseHex4(&cp)) return Fail("Invalid \\u escape");
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        uint32_t low;
+                        const size_t save = pos_;
+                        if (Consume("\\u") && ParseHex4(&low) && low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            pos_ = save;
+                            cp = 0xFFFD;
+                        }
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        cp = 0xFFFD;
+                    }
+                    AppendUtf8(scratch_, cp);
+                    break;
+                }
+                default:
+                    --pos_;
+                    return Fail("Invalid escape");
+            }
+        }
+        return Fail("Unterminated string");
+    }
+
+    bool ParseHex4(uint32_t* out) {
+        if (pos_ + 4 > text_.size()) return false;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int digit = HexDigit(text_[pos_ + i]);
+            if (digit < 0) return false;
+            value = (value << 4) | static_cast<uint32_t>(digit);
+        }
+        pos_ += 4;
+        *out = value;
+        return true;
+    }
+
+    // Children are collected on shared stacks and copied into the arena in
+    // one block when the container closes, so nested containers never
+    // interleave and no per-node allocation happens.
+    bool ParseArray(JsonValue* out, int depth) {
+        if (depth >= kMaxDepth) return Fail("Nesting too deep");
+        ++pos_;
+        const size_t first = values_.size();
+        SkipSpace();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            ++pos_;
+        } else {
+            for (;;) {
+                values_.emplace_back();
+                JsonValue value;
+                if (!ParseValue(&value, depth + 1)) return false;
+                values_.back() = value;
+                SkipSpace();
+                if (pos_ >= text_.size()) return Fail("Unterminated array");
+                if (text_[pos_] == ']') {
+                    ++pos_;
+                    break;
+                }
+                if (text_[pos_] != ',') return Fail("Expected ',' or ']'");
+                ++pos_;
+                SkipSpace();
+            }
+        }
+        out->type = JsonValue::Type::Array;
+        out->items = CommitValues(first);
+        out->size = static_cast<uint32_t>(values_.size() - first);
+        values_.resize(first);
+        return true;
+    }
+
+    bool ParseObject(JsonValue* out, int depth) {
+        if (depth >= kMaxDepth) return Fail("Nesting too deep");
+        ++pos_;
+        const size_t first = values_.size();
+        const size_t first_key = keys_.size();
+        SkipSpace();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            ++pos_;
+        } else {
+            for (;;) {
+                if (pos_ >= text_.size() || text_[pos_] != '"') return Fail("Expected string key");
+                std::string_view key;
+                if (!ParseString(&key)) return false;
+                SkipSpace();
+                if (pos_ >= text_.size() || text_[pos_] != ':') return Fail("Expected ':'");
+                ++pos_;
+                SkipSpace();
+
+                keys_.push_back(key);
+                values_.emplace_back();
+                JsonValue value;
+                if (!ParseValue(&value, depth + 1)) return false;
+                values_.back() = value;
+                SkipSpace();
+                if (pos_ >= text_.size()) return Fail("Unterminated object");
+                if (text_[pos_] == '}') {
+                    ++pos_;
+                    break;
+                }
+                if (text_[pos_] != ',') return Fail("Expected ',' or '}'");
+                ++pos_;
+                SkipSpace();
+            }
+        }
+
+        const size_t count = values_.size() - first;
+        out->type = JsonValue::Type::Object;
+        out->items = CommitValues(first);
+        auto* keys = static_cast<std::string_view*>(doc_->Allocate(count * sizeof(std::string_view), alignof(std::string_view)));
+        for (size_t i = 0; i < count; ++i) new (&keys[i]) std::string_view(keys_[first_key + i]);
+        out->keys = keys;
+        out->size = static_cast<uint32_t>(count);
+        values_.resize(first);
+        keys_.resize(first_key);
+        return true;
+    }
+
+    const JsonValue* CommitValues(size_t first) {
+        const size_t count = values_.size() - first;
+        if (count == 0) return nullptr;
+        auto* items = static_cast<JsonValue*>(doc_->Allocate(count * sizeof(JsonValue), alignof(JsonValue)));
+        for (size_t i = 0; i < count; ++i) new (&items[i]) JsonValue(values_[first + i]);
+        return items;
+    }
+
+    JsonDocument* doc_;
+    std::string_view text_;
+    size_t pos_ = 0;
+    std::string error_;
+    std::string scratch_;
+    std::vector<JsonValue> values_;
+    std::vector<std::string_view> keys_;
+};
+
+// --- JsonDocument ---
+
+JsonDocument::JsonDocument() = default;
+JsonDocument::~JsonDocument() = default;
+
+bool JsonDocument::Parse(std::string_view text, std::string* error) {
+    root_ = JsonValue();
+    Parser parser(this, text);
+    return parser.Run(&root_, error);
+}
+
+void* JsonDocument::Allocate(size_t bytes, size_t align) {
+    size_t padding = (align - reinterpret_cast<uintptr_t>(cursor_) % align) % align;
+    if (cursor_ == nullptr || bytes + padding > remaining_) {
+        const size_t size = std::max(kBlockSize, bytes + align);
+        blocks_.emplace_back(new char[size]);
+        cursor_ = blocks_.back().get();
+        remaining_ = size;
+        padding = (align - reinterpret_cast<uintptr_t>(cursor_) % align) % align;
+    }
+    void* result = cursor_ + padding;
+    cursor_ += padding + bytes;
+    remaining_ -= padding + bytes;
+    return result;
+}
+
+void AppendJsonString(std::string* out, std::string_view text) {
+    static const char kHex[] = "0123456789abcdef";
+    out->push_back('"');
+    size_t run = 0; // start of the pending span that needs no escaping
+    for (size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out->append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"': out->append("\\\""); break;
+            case '\\': out->append("\\\\"); break;
+            case '\n': out->append("\\n"); break;
+            case '\r': out->append("\\r"); break;
+            case '\t': out->append("\\t"); break;
+            case '\b': out->append("\\b"); break;
+            case '\f': out->append("\\f"); break;
+            default:
+                out->append("\\u00");
+                out->push_back(kHex[c >> 4]);
+                out->push_back(kHex[c & 0xF]);
+        }
+    }
+    out->append(text.data() + run, text.size() - run);
+    out->push_back('"');
+}
+
+} // namespace ece
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ece {
+
+// Read-only JSON value. Arrays and objects store their children contiguously
+// in the owning JsonDocument's arena; strings point either into the input
+// (no escapes) or into the arena (decoded), so a value is only valid while
+// both the document and the parsed text are alive.
+struct JsonValue {
+    enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string_view string;
+    const JsonValue* items = nullptr;       // array elements or object values
+    const std::string_view* keys = nullptr; // object keys, parallel to items
+    uint32_t size = 0;
+
+    bool IsNull() const { return type == Type::Null; }
+    bool IsString() const { return type == Type::String; }
+    bool IsNumber() const { return type == Type::Number; }
+    bool IsBool() const { return type == Type::Bool; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsObject() const { return type == Type::Object; }
+
+    // Member lookup (objects only); nullptr when absent.
+    const JsonValue* Find(std::string_view key) const;
+
+    // Typed member access with a fallback for absent or mistyped members.
+    std::string_view GetString(std::string_view key, std::string_view fallback = {}) const;
+    int64_t GetInt(std::string_view key, int64_t fallback) const;
+    bool GetBool(std::string_view key, bool fallback) const;
+
+    const JsonValue* begin() const { return items; }
+    const JsonValue* end() const { return items + size; }
+};
+
+// Single-pass recursive-descent parser. All nodes and decoded strings live in
+// a bump arena that is released with the document; nothing is freed piecemeal.
+class JsonDocument {
+public:
+    JsonDocument();
+    ~JsonDocument();
+
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    // Parses `text`, which must outlive the document. On failure returns false
+    // and describes the problem (with byte offset) in `error`.
+    bool Parse(std::string_view text, std::string* error);
+
+    const JsonValue& root() const { return root_; }
+
+private:
+    class Parser;
+
+    void* Allocate(size_t bytes, size_t align);
+
+    JsonValue root_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_ = nullptr;
+    size_t remaining_ = 0;
+};
+
+// Appends `text` to `out` as a quoted JSON string literal. Quotes,
+// backslashes and control characters are escaped; other bytes pass through.
+void AppendJsonString(std::string* out, std::string_view text);
+
+} // namespace ece
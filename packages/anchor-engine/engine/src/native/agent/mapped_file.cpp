@@ -0,0 +1,121 @@
+#include "mapped_file.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <filesystem>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ece {
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path, std::string* error) {
+    Close();
+    HANDLE file = CreateFileW(std::filesystem::u8path(path).wstring().c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        *error = "Cannot open file - " + path;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        *error = "Cannot stat file - " + path;
+        return false;
+    }
+    file_ = file;
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0) return true;
+
+    mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr) {
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (data_ == nullptr) {
+        Close();
+        *error = "Cannot map file - " + path;
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (mapping_ != nullptr) CloseHandle(mapping_);
+    if (file_ != nullptr) CloseHandle(file_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+    file_ = nullptr;
+    size_ = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path, std::string* error) {
+    Close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = "Cannot open file - " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        *error = "Cannot stat file - " + path + " (" + std::strerror(errno) + ")";
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            *error = "Cannot map file - " + path + " (" + std::strerror(errno) + ")";
+            size_ = 0;
+            ::close(fd);
+            return false;
+        }
+        data_ = static_cast<const char*>(data);
+    }
+    ::close(fd); // the mapping keeps the file referenced
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_ != nullptr) ::munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+} // namespace ece
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ece {
+
+// Read-only memory mapping of a whole file. Mapping is O(1) regardless of
+// size; pages are only faulted in for the bytes a caller actually touches.
+// Only for files the engine replaces by rename (saved indexes): a file
+// truncated in place turns a touch past its new end into SIGBUS. Anything
+// else is read through FileReader.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps `path`. Empty files succeed with an empty view.
+    bool Open(const std::string& path, std::string* error);
+    void Close();
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace ece
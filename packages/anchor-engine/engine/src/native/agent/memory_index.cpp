@@ -0,0 +1,293 @@
+#include "memory_index.hpp"
+#include "file_reader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace ece {
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'C', 'E', 'M', 'I', 'D', 'X', '1'};
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kCompoundSize = 24;
+constexpr size_t kLabelSize = 16;
+constexpr size_t kPostingSize = 8;
+constexpr size_t kMaxTerms = 64; // one bit each in a window's term mask
+
+std::mutex g_current_mutex;
+std::shared_ptr<const MemoryIndex> g_current;
+
+uint32_t ReadU32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+bool IsSeparator(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ';';
+}
+
+} // namespace
+
+std::string MemoryIndex::NormalizeKey(std::string_view label) {
+    while (!label.empty() && label.front() == '#') label.remove_prefix(1);
+    std::string key(label);
+    for (char& c : key) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return key;
+}
+
+uint32_t MemoryIndex::Field(const char* record, size_t index) const {
+    return ReadU32(record + index * sizeof(uint32_t));
+}
+
+std::string_view MemoryIndex::Key(uint32_t label) const {
+    const char* record = labels_ + static_cast<size_t>(label) * kLabelSize;
+    return strings_.substr(Field(record, 0), Field(record, 1));
+}
+
+MemoryIndex::Compound MemoryIndex::compound(uint32_t index) const {
+    const char* record = compounds_ + static_cast<size_t>(index) * kCompoundSize;
+    Compound result;
+    result.id = strings_.substr(Field(record, 0), Field(record, 1));
+    result.path = strings_.substr(Field(record, 2), Field(record, 3));
+    std::memcpy(&result.timestamp, record + 16, sizeof(double));
+    return result;
+}
+
+bool MemoryIndex::Open(const std::string& path, std::string* error) {
+    if (!file_.Open(path, error)) return false;
+    const std::string_view data = file_.view();
+
+    auto fail = [&](const std::string& why) {
+        file_.Close();
+        *error = "Invalid memory index - " + path + " (" + why + ")";
+        return false;
+    };
+
+    if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        return fail("bad header");
+    }
+    compound_count_ = ReadU32(data.data() + 8);
+    label_count_ = ReadU32(data.data() + 12);
+    posting_count_ = ReadU32(data.data() + 16);
+
+    const uint64_t tables = kHeaderSize + uint64_t{compound_count_} * kCompoundSize +
+                            uint64_t{label_count_} * kLabelSize + uint64_t{posting_count_} * kPostingSize;
+    if (tables > data.size()) return fail("truncated");
+
+    compounds_ = data.data() + kHeaderSize;
+    labels_ = compounds_ + size_t{compound_count_} * kCompoundSize;
+    postings_ = labels_ + size_t{label_count_} * kLabelSize;
+    strings_ = data.substr(static_cast<size_t>(tables));
+
+    // Check every reference once so lookups never have to
+    auto in_pool = [&](uint32_t offset, uint32_t length) {
+        return uint64_t{offset} + length <= strings_.size();
+    };
+    for (uint32_t i = 0; i < compound_count_; ++i) {
+        const char* record = compounds_ + size_t{i} * kCompoundSize;
+        if (!in_pool(Field(record, 0), Field(record, 1)) || !in_pool(Field(record, 2), Field(record, 3))) {
+            return fail("compound " + std::to_string(i) + " out of range");
+        }
+    }
+    for (uint32_t i = 0; i < label_count_; ++i) {
+        const char* record = labels_ + size_t{i} * kLabelSize;
+        if (!in_pool(Field(record, 0), Field(record, 1)) ||
+            uint64_t{Field(record, 2)} + Field(record, 3) > posting_count_) {
+            return fail("label " + std::to_string(i) + " out of range");
+        }
+        if (i > 0 && !(Key(i - 1) < Key(i))) {
+            return fail("labels not sorted");
+        }
+    }
+    for (uint32_t i = 0; i < posting_count_; ++i) {
+        if (ReadU32(postings_ + size_t{i} * kPostingSize) >= compound_count_) {
+            return fail("posting " + std::to_string(i) + " out of range");
+        }
+    }
+    return true;
+}
+
+std::pair<uint32_t, uint32_t> MemoryIndex::FindLabels(std::string_view key, bool prefix) const {
+    uint32_t lo = 0, hi = label_count_;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (Key(mid) < key) lo = mid + 1; else hi = mid;
+    }
+    if (!prefix) {
+        return lo < label_count_ && Key(lo) == key ? std::make_pair(lo, lo + 1) : std::make_pair(lo, lo);
+    }
+    // Keys sharing the prefix are contiguous from lo
+    uint32_t first = lo;
+    hi = label_count_;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (Key(mid).substr(0, key.size()) == key) lo = mid + 1; else hi = mid;
+    }
+    return {first, lo};
+}
+
+std::vector<MemoryIndex::Posting> MemoryIndex::Lookup(std::string_view key) const {
+    std::vector<Posting> result;
+    const auto range = FindLabels(key, false);
+    for (uint32_t label = range.first; label < range.second; ++label) {
+        const char* record = labels_ + size_t{label} * kLabelSize;
+        const uint32_t first = Field(record, 2);
+        const uint32_t count = Field(record, 3);
+        for (uint32_t i = 0; i < count; ++i) {
+            const char* posting = postings_ + size_t{first + i} * kPostingSize;
+            result.push_back({ReadU32(posting), ReadU32(posting + 4)});
+        }
+    }
+    return result;
+}
+
+std::vector<MemoryIndex::Window> MemoryIndex::Search(std::string_view query, const SearchOptions& options) const {
+    // Terms: the whole query (labels may contain spaces), then each word
+    std::vector<std::string> terms;
+    auto add_term = [&terms](std::string_view text) {
+        std::string key = NormalizeKey(text);
+        if (!key.empty() && terms.size() < kMaxTerms && std::find(terms.begin(), terms.end(), key) == terms.end()) {
+            terms.push_back(std::move(key));
+        }
+    };
+    while (!query.empty() && IsSeparator(query.front())) query.remove_prefix(1);
+    while (!query.empty() && IsSeparator(query.back())) query.remove_suffix(1);
+    add_term(query);
+    for (size_t pos = 0; pos < query.size();) {
+        while (pos < query.size() && IsSeparator(query[pos])) ++pos;
+        size_t end = pos;
+        while (end < query.size() && !IsSeparator(query[end])) ++end;
+        if (end > pos) add_term(query.substr(pos, end - pos));
+        pos = end;
+    }
+
+    struct Hit {
+        uint32_t compound;
+        uint32_t offset;
+        uint32_t term;
+    };
+    std::vector<Hit> hits;
+    for (uint32_t t = 0; t < terms.size(); ++t) {
+        const auto range = FindLabels(terms[t], options.prefix);
+        for (uint32_t label = range.first; label < range.second; ++label) {
+            const char* record = labels_ + size_t{label} * kLabelSize;
+            const uint32_t first = Field(record, 2);
+            const uint32_t count = Field(record, 3);
+            for (uint32_t i = 0; i < count; ++i) {
+                const char* posting = postings_ + size_t{first + i} * kPostingSize;
+                hits.push_back({ReadU32(posting), ReadU32(posting + 4), t});
+            }
+        }
+    }
+    if (hits.empty()) return {};
+
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        return a.compound != b.compound ? a.compound < b.compound : a.offset < b.offset;
+    });
+
+    // Merge hits in the same compound whose radii overlap, up to max_window
+    struct Candidate {
+        uint32_t compound;
+        uint64_t start;
+        uint64_t end;
+        uint32_t hits;
+        uint64_t terms; // bit per term
+    };
+    const uint64_t radius = options.radius;
+    const uint64_t max_window = options.max_window > 0 ? options.max_window : radius * 3;
+    std::vector<Candidate> candidates;
+    for (const Hit& hit : hits) {
+        const uint64_t start = hit.offset > radius ? hit.offset - radius : 0;
+        const uint64_t end = uint64_t{hit.offset} + radius;
+        if (!candidates.empty()) {
+            Candidate& last = candidates.back();
+            if (last.compound == hit.compound && start <= last.end && std::max(end, last.end) - last.start <= max_window) {
+                last.end = std::max(end, last.end);
+                ++last.hits;
+                last.terms |= uint64_t{1} << hit.term;
+                continue;
+            }
+        }
+        candidates.push_back({hit.compound, start, end, 1, uint64_t{1} << hit.term});
+    }
+
+    auto distinct = [](uint64_t mask) {
+        int count = 0;
+        for (; mask != 0; mask &= mask - 1) ++count;
+        return count;
+    };
+    std::sort(candidates.begin(), candidates.end(), [&](const Candidate& a, const Candidate& b) {
+        const int da = distinct(a.terms), db = distinct(b.terms);
+        if (da != db) return da > db;
+        if (a.hits != b.hits) return a.hits > b.hits;
+        const double ta = compound(a.compound).timestamp, tb = compound(b.compound).timestamp;
+        if (ta != tb) return ta > tb;
+        return a.compound != b.compound ? a.compound < b.compound : a.start < b.start;
+    });
+
+    // Read windows in rank order, skipping files that have gone missing or
+    // shrunk since the export. Mirrored files are rewritten in place, so
+    // only each window's bytes are read (never mapped); each file is opened
+    // at most once
+    std::vector<Window> windows;
+    std::unordered_map<uint32_t, std::unique_ptr<FileReader>> files;
+    std::string data;
+    for (const Candidate& candidate : candidates) {
+        if (windows.size() >= options.limit) break;
+
+        auto it = files.find(candidate.compound);
+        if (it == files.end()) {
+            auto file = std::make_unique<FileReader>();
+            std::string open_error;
+            if (!file->Open(std::string(compound(candidate.compound).path), &open_error)) file.reset();
+            it = files.emplace(candidate.compound, std::move(file)).first;
+        }
+        if (!it->second) continue;
+
+        // The byte after the window too, to tell whether `end` splits a
+        // UTF-8 sequence
+        const uint64_t file_size = it->second->size();
+        if (candidate.start >= file_size) continue;
+        const uint64_t span = std::max(candidate.start, std::min<uint64_t>(candidate.end, file_size)) - candidate.start;
+        std::string read_error;
+        data.clear();
+        if (!it->second->Read(candidate.start, span + 1, &data, &read_error) || data.empty()) continue;
+        size_t start = 0;
+        size_t end = static_cast<size_t>(std::min<uint64_t>(span, data.size()));
+        // Don't start or stop inside a UTF-8 sequence
+        while (start < end && (static_cast<unsigned char>(data[start]) & 0xC0) == 0x80) ++start;
+        while (end > start && end < data.size() && (static_cast<unsigned char>(data[end]) & 0xC0) == 0x80) --end;
+
+        Window window;
+        window.compound = candidate.compound;
+        window.start = candidate.start + start;
+        window.end = candidate.start + end;
+        window.hits = candidate.hits;
+        for (size_t t = 0; t < terms.size(); ++t) {
+            if (candidate.terms & (uint64_t{1} << t)) window.terms.push_back(terms[t]);
+        }
+        window.content.assign(data.data() + start, end - start);
+        windows.push_back(std::move(window));
+    }
+    return windows;
+}
+
+bool MemoryIndex::Load(const std::string& path, std::string* error) {
+    auto index = std::make_shared<MemoryIndex>();
+    if (!index->Open(path, error)) return false;
+    std::lock_guard<std::mutex> lock(g_current_mutex);
+    g_current = std::move(index);
+    return true;
+}
+
+std::shared_ptr<const MemoryIndex> MemoryIndex::Current() {
+    std::lock_guard<std::mutex> lock(g_current_mutex);
+    return g_current;
+}
+
+} // namespace ece
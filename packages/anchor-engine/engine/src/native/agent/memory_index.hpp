@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mapped_file.hpp"
+
+namespace ece {
+
+// Read-only snapshot of the atom_positions table: atom label -> (compound,
+// byte offset) postings, with each compound's file on disk. Exported by
+// services/search/memory-index.ts; layout (little-endian):
+//
+//   header    "ECEMIDX1", u32 compound_count, u32 label_count,
+//             u32 posting_count, u32 reserved
+//   compounds compound_count x { u32 id_offset, u32 id_length,
+//             u32 path_offset, u32 path_length, f64 timestamp }
+//   labels    label_count x { u32 key_offset, u32 key_length,
+//             u32 first_posting, u32 posting_count }, sorted by key bytes
+//   postings  posting_count x { u32 compound, u32 byte_offset }, grouped by
+//             label, then by compound and offset
+//   strings   UTF-8 pool the offsets above point into
+//
+// Keys are labels with any leading '#' removed and ASCII lowercased, which is
+// how queries are normalized too. Bounds are checked once at load, so lookups
+// are a binary search over the mapping with no further validation.
+class MemoryIndex {
+public:
+    struct Posting {
+        uint32_t compound;
+        uint32_t byte_offset;
+    };
+
+    struct Compound {
+        std::string_view id;
+        std::string_view path; // mirrored file (or original when unmirrored)
+        double timestamp;
+    };
+
+    struct SearchOptions {
+        size_t limit = 10;       // windows returned
+        uint32_t radius = 500;   // bytes around each hit
+        uint32_t max_window = 0; // 0 = radius * 3
+        bool prefix = false;     // also match labels starting with a term
+    };
+
+    struct Window {
+        uint32_t compound;
+        uint64_t start;
+        uint64_t end;
+        uint32_t hits;
+        std::vector<std::string> terms; // query terms found in the window
+        std::string content;
+    };
+
+    bool Open(const std::string& path, std::string* error);
+
+    uint32_t compound_count() const { return compound_count_; }
+    uint32_t label_count() const { return label_count_; }
+    uint32_t posting_count() const { return posting_count_; }
+    Compound compound(uint32_t index) const;
+
+    // Postings for a normalized key; empty when the label is unknown.
+    std::vector<Posting> Lookup(std::string_view key) const;
+
+    // Finds the query's atoms, merges nearby hits per compound into windows
+    // and reads them from the files on disk. Windows covering more distinct
+    // terms rank first, then more hits, then newer compounds.
+    std::vector<Window> Search(std::string_view query, const SearchOptions& options) const;
+
+    static std::string NormalizeKey(std::string_view label);
+
+    // Process-wide index used by the search_memory tool. Load swaps in a new
+    // snapshot; searches already running keep the one they started with.
+    static bool Load(const std::string& path, std::string* error);
+    static std::shared_ptr<const MemoryIndex> Current();
+
+private:
+    // Range [first, last) of label records whose key matches.
+    std::pair<uint32_t, uint32_t> FindLabels(std::string_view key, bool prefix) const;
+    std::string_view Key(uint32_t label) const;
+    uint32_t Field(const char* record, size_t index) const;
+
+    MappedFile file_;
+    const char* compounds_ = nullptr;
+    const char* labels_ = nullptr;
+    const char* postings_ = nullptr;
+    std::string_view strings_;
+    uint32_t compound_count_ = 0;
+    uint32_t label_count_ = 0;
+    uint32_t posting_count_ = 0;
+};
+
+} // namespace ece
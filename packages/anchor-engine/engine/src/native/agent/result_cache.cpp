@@ -0,0 +1,179 @@
+#include "result_cache.hpp"
+#include <chrono>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace ece {
+
+namespace fs = std::filesystem;
+
+FileStamp FileStamp::Of(const std::string& path) {
+    FileStamp stamp;
+#ifdef _WIN32
+    // Paths are UTF-8, so the wide API; BACKUP_SEMANTICS lets directories be opened too
+    HANDLE handle = CreateFileW(fs::u8path(path).wstring().c_str(), FILE_READ_ATTRIBUTES,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return stamp;
+    BY_HANDLE_FILE_INFORMATION info;
+    if (GetFileInformationByHandle(handle, &info)) {
+        stamp.exists = true;
+        stamp.dev = info.dwVolumeSerialNumber;
+        stamp.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        const uint64_t ticks = (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+                               info.ftLastWriteTime.dwLowDateTime;
+        // 100ns ticks since 1601, rebased to the Unix epoch
+        stamp.mtime_ns = (static_cast<int64_t>(ticks) - 116444736000000000LL) * 100;
+        stamp.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+    }
+    CloseHandle(handle);
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return stamp;
+    stamp.exists = true;
+    stamp.dev = static_cast<uint64_t>(st.st_dev);
+    stamp.inode = static_cast<uint64_t>(st.st_ino);
+#ifdef __APPLE__
+    stamp.mtime_ns = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    stamp.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    stamp.size = static_cast<uint64_t>(st.st_size);
+#endif
+    return stamp;
+}
+
+ResultCache& ResultCache::Shared() {
+    // Enough for a session's worth of re-read source files and listings
+    static ResultCache* cache = new ResultCache(512, 64 << 20);
+    return *cache;
+}
+
+ResultCache::ResultCache(size_t max_entries, size_t max_bytes)
+    : max_entries_(max_entries), max_bytes_(max_bytes) {}
+
+std::string ResultCache::NormalPath(const std::string& path) {
+    std::error_code ec;
+    fs::path absolute = fs::absolute(fs::u8path(path), ec);
+    if (ec) absolute = fs::u8path(path);
+    std::string normal = absolute.lexically_normal().u8string();
+    // "dir/" and "dir" are the same dependency
+    while (normal.size() > 1 && (normal.back() == '/' || normal.back() == '\\')) normal.pop_back();
+    return normal;
+}
+
+bool ResultCache::Lookup(const std::string& key, std::string* result) {
+    Dependencies dependencies;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++stats_.misses;
+            return false;
+        }
+        dependencies = it->second->dependencies;
+    }
+
+    bool fresh = true;
+    for (const auto& dependency : dependencies) {
+        if (FileStamp::Of(dependency.first) != dependency.second) {
+            fresh = false;
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end() || !fresh) {
+        if (it != index_.end()) {
+            EraseLocked(it->second);
+            ++stats_.invalidations;
+        }
+        ++stats_.misses;
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    *result = it->second->result;
+    ++stats_.hits;
+    return true;
+}
+
+void ResultCache::Store(const std::string& key, const std::string& result, Dependencies dependencies) {
+    if (result.size() > max_bytes_ / 8) return;
+
+    // A path modified within a timestamp tick of now could change again
+    // without its stamp moving (git's "racily clean" case); cache it once it
+    // has settled. Two seconds covers FAT's granularity too.
+    const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    for (const auto& dependency : dependencies) {
+        if (dependency.second.exists && now_ns - dependency.second.mtime_ns < 2000000000LL) return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto existing = index_.find(key);
+    if (existing != index_.end()) EraseLocked(existing->second);
+
+    lru_.push_front(Entry{key, result, std::move(dependencies)});
+    index_.emplace(key, lru_.begin());
+    stats_.bytes += result.size();
+    ++stats_.entries;
+
+    while (stats_.entries > max_entries_ || stats_.bytes > max_bytes_) {
+        EraseLocked(std::prev(lru_.end()));
+        ++stats_.evictions;
+    }
+}
+
+void ResultCache::Invalidate(const std::string& path) {
+    const std::string target = NormalPath(path);
+    const std::string parent = fs::u8path(target).parent_path().u8string();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        bool depends = false;
+        for (const auto& dependency : it->dependencies) {
+            if (dependency.first == target || dependency.first == parent) {
+                depends = true;
+                break;
+            }
+        }
+        if (depends) {
+            auto next = std::next(it);
+            EraseLocked(it);
+            ++stats_.invalidations;
+            it = next;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ResultCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.invalidations += lru_.size();
+    lru_.clear();
+    index_.clear();
+    stats_.entries = 0;
+    stats_.bytes = 0;
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ResultCache::EraseLocked(EntryList::iterator it) {
+    stats_.bytes -= it->result.size();
+    --stats_.entries;
+    index_.erase(it->key);
+    lru_.erase(it);
+}
+
+} // namespace ece
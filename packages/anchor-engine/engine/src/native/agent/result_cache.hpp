@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ece {
+
+// Identity and version of a file or directory as the filesystem reports it.
+// A missing path has a stamp too (exists = false), so "still absent" can be
+// validated like anything else.
+struct FileStamp {
+    bool exists = false;
+    uint64_t dev = 0;
+    uint64_t inode = 0;
+    int64_t mtime_ns = 0;
+    uint64_t size = 0;
+
+    bool operator==(const FileStamp& other) const {
+        return exists == other.exists && dev == other.dev && inode == other.inode &&
+               mtime_ns == other.mtime_ns && size == other.size;
+    }
+    bool operator!=(const FileStamp& other) const { return !(*this == other); }
+
+    // Follows symlinks, like the tools that read through them.
+    static FileStamp Of(const std::string& path);
+};
+
+// Bounded LRU of read-only tool results. Each entry records the stamp of
+// every path it was built from (taken before reading) and is only served
+// while all of them are unchanged on disk, so edits made outside the
+// executor are picked up on the next call. Writes made through the executor
+// also drop the entries depending on the written path or its directory, which
+// covers changes landing within one mtime tick.
+class ResultCache {
+public:
+    using Dependencies = std::vector<std::pair<std::string, FileStamp>>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;      // dropped for space
+        uint64_t invalidations = 0;  // dropped by a write or a changed stamp
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    // Process-wide cache used by ToolExecutor.
+    static ResultCache& Shared();
+
+    ResultCache(size_t max_entries, size_t max_bytes);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // Copies the result for `key` into `result` if its dependencies are
+    // unchanged. Stamps are checked without holding the lock.
+    bool Lookup(const std::string& key, std::string* result);
+
+    // Results larger than an eighth of the byte budget, or built from a path
+    // modified in the last two seconds, are not kept.
+    void Store(const std::string& key, const std::string& result, Dependencies dependencies);
+
+    // Drops entries that depend on `path` or on the directory holding it.
+    void Invalidate(const std::string& path);
+    void Clear();
+
+    Stats stats() const;
+
+    // Absolute, lexically normal form used for keys and dependencies.
+    static std::string NormalPath(const std::string& path);
+
+private:
+    struct Entry {
+        std::string key;
+        std::string result;
+        Dependencies dependencies;
+    };
+    using EntryList = std::list<Entry>;
+
+    void EraseLocked(EntryList::iterator it);
+
+    const size_t max_entries_;
+    const size_t max_bytes_;
+    mutable std::mutex mutex_;
+    EntryList lru_; // most recently used first
+    std::unordered_map<std::string, EntryList::iterator> index_;
+    Stats stats_;
+};
+
+} // namespace ece
@@ -0,0 +1,212 @@
+#include "shell_runner.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace ece {
+
+namespace {
+
+constexpr size_t kReadBufferSize = 64 * 1024;
+
+// Keeps output up to the cap and reports whether anything was dropped.
+void Capture(ShellResult& result, const ShellOptions& options, const ShellChunkFn& on_chunk,
+             bool is_stderr, std::string_view chunk) {
+    const size_t used = result.out.size() + result.err.size();
+    if (used >= options.max_output) {
+        result.truncated = true;
+        return;
+    }
+    if (chunk.size() > options.max_output - used) {
+        chunk = chunk.substr(0, options.max_output - used);
+        result.truncated = true;
+    }
+    (is_stderr ? result.err : result.out).append(chunk);
+    if (on_chunk) on_chunk(is_stderr, chunk);
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+// No process groups or poll() on Windows; keep the pipe-based path and
+// capture stdout only.
+ShellResult RunShellCommand(const std::string& command, const ShellOptions& options,
+                            const ShellChunkFn& on_chunk) {
+    ShellResult result;
+    std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(command.c_str(), "r"), _pclose);
+    if (!pipe) {
+        result.error = "Failed to execute command - " + command;
+        return result;
+    }
+
+    std::array<char, kReadBufferSize> buffer;
+    size_t n;
+    while ((n = fread(buffer.data(), 1, buffer.size(), pipe.get())) > 0) {
+        Capture(result, options, on_chunk, false, std::string_view(buffer.data(), n));
+    }
+    result.exit_code = _pclose(pipe.release());
+    return result;
+}
+
+#else
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool MakePipe(int fds[2]) {
+    if (::pipe(fds) != 0) return false;
+    for (int i = 0; i < 2; ++i) ::fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void CloseFd(int& fd) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+} // namespace
+
+ShellResult RunShellCommand(const std::string& command, const ShellOptions& options,
+                            const ShellChunkFn& on_chunk) {
+    ShellResult result;
+
+    int out_pipe[2] = {-1, -1};
+    int err_pipe[2] = {-1, -1};
+    if (!MakePipe(out_pipe) || !MakePipe(err_pipe)) {
+        result.error = std::string("Failed to create pipes - ") + std::strerror(errno);
+        CloseFd(out_pipe[0]);
+        CloseFd(out_pipe[1]);
+        return result;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err_pipe[1], STDERR_FILENO);
+
+    // Own process group so a timeout can take down the whole pipeline, and
+    // default SIGPIPE (Node ignores it, which children would inherit).
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigset_t no_mask;
+    sigemptyset(&no_mask);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setsigmask(&attr, &no_mask);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+    const char* argv[] = {"/bin/sh", "-c", command.c_str(), nullptr};
+    pid_t pid = -1;
+    const int spawn_error = posix_spawn(&pid, "/bin/sh", &actions, &attr, const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    CloseFd(out_pipe[1]);
+    CloseFd(err_pipe[1]);
+
+    if (spawn_error != 0) {
+        result.error = "Failed to execute command - " + command + " (" + std::strerror(spawn_error) + ")";
+        CloseFd(out_pipe[0]);
+        CloseFd(err_pipe[0]);
+        return result;
+    }
+
+    std::unique_ptr<char[]> buffer(new char[kReadBufferSize]);
+    pollfd fds[2] = {{out_pipe[0], POLLIN, 0}, {err_pipe[0], POLLIN, 0}};
+
+    // Reads whatever is available; closes the fd at EOF.
+    auto drain = [&](int index) {
+        for (;;) {
+            const ssize_t n = ::read(fds[index].fd, buffer.get(), kReadBufferSize);
+            if (n > 0) {
+                Capture(result, options, on_chunk, index == 1, std::string_view(buffer.get(), static_cast<size_t>(n)));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            CloseFd(fds[index].fd);
+            return;
+        }
+    };
+
+    // Capped (~17 years) so the nanosecond deadline cannot overflow
+    const auto start = Clock::now();
+    Clock::time_point deadline = options.timeout_ms > 0
+        ? start + std::chrono::milliseconds(std::min<int64_t>(options.timeout_ms, int64_t{1} << 39))
+        : Clock::time_point::max();
+    int kill_stage = 0; // 0 = running, 1 = SIGTERM sent, 2 = SIGKILL sent
+    int status = 0;
+    bool reaped = false;
+
+    // Runs until the shell is reaped, not merely until the pipes close: a
+    // command that closes stdout/stderr and keeps going is still bound by
+    // the deadline.
+    while (!reaped) {
+        const auto now = Clock::now();
+        if (now >= deadline) {
+            if (kill_stage == 2) break; // something outside the group holds the pipes
+            ::kill(-pid, kill_stage == 0 ? SIGTERM : SIGKILL);
+            result.timed_out = true;
+            ++kill_stage;
+            deadline = now + std::chrono::milliseconds(500);
+        }
+
+        // Wake at least every 100ms: a finished shell whose background
+        // children still hold the pipes must not keep us waiting. With both
+        // pipes closed poll() only sleeps, so check the child more often.
+        const bool pipes_open = fds[0].fd >= 0 || fds[1].fd >= 0;
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+        const int timeout = static_cast<int>(std::min<int64_t>(wait, pipes_open ? 100 : 10));
+        const int ready = ::poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) break;
+
+        for (int i = 0; i < 2; ++i) {
+            if (fds[i].fd >= 0 && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) drain(i);
+        }
+        if ((ready == 0 || (fds[0].fd < 0 && fds[1].fd < 0)) && ::waitpid(pid, &status, WNOHANG) == pid) {
+            reaped = true;
+            for (int i = 0; i < 2; ++i) {
+                if (fds[i].fd >= 0) drain(i);
+            }
+        }
+    }
+
+    CloseFd(fds[0].fd);
+    CloseFd(fds[1].fd);
+    if (!reaped) {
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+    }
+
+    if (WIFEXITED(status)) {
+        result.exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        result.term_signal = WTERMSIG(status);
+    }
+    return result;
+}
+
+#endif
+
+} // namespace ece
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace ece {
+
+struct ShellOptions {
+    int64_t timeout_ms = 120000;  // wall clock; <= 0 disables the timeout
+    size_t max_output = 1 << 20;  // combined stdout+stderr bytes kept/streamed
+};
+
+struct ShellResult {
+    std::string out;
+    std::string err;
+    int exit_code = -1;     // -1 when the process was killed by a signal
+    int term_signal = 0;
+    bool timed_out = false;
+    bool truncated = false; // output beyond max_output was drained and dropped
+    std::string error;      // spawn failure; nothing ran
+};
+
+// Receives output as it arrives, from the thread running the command.
+using ShellChunkFn = std::function<void(bool is_stderr, std::string_view chunk)>;
+
+// Runs `command` through /bin/sh in its own process group with stdin from
+// /dev/null. stdout and stderr are read through poll() into 64KB buffers; on
+// timeout the whole group gets SIGTERM, then SIGKILL after a short grace.
+// Blocks the calling thread until the command finishes.
+ShellResult RunShellCommand(const std::string& command, const ShellOptions& options,
+                            const ShellChunkFn& on_chunk = nullptr);
+
+} // namespace ece
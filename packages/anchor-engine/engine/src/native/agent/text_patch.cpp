@@ -0,0 +1,328 @@
+#include "text_patch.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ece {
+
+namespace {
+
+// 1-based line of byte `pos`, for error messages only
+size_t LineOf(std::string_view text, size_t pos) {
+    return static_cast<size_t>(std::count(text.begin(), text.begin() + pos, '\n')) + 1;
+}
+
+std::string_view StripCr(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+// Byte offsets of line starts; line k is [starts[k], starts[k+1]) with the
+// text size as the final bound. A trailing newline does not open a new line.
+class LineTable {
+public:
+    explicit LineTable(std::string_view text) : text_(text) {
+        if (text.empty()) return;
+        starts_.push_back(0);
+        const char* base = text.data();
+        size_t pos = 0;
+        while (pos < text.size()) {
+            const void* nl = std::memchr(base + pos, '\n', text.size() - pos);
+            if (nl == nullptr) break;
+            pos = static_cast<size_t>(static_cast<const char*>(nl) - base) + 1;
+            if (pos < text.size()) starts_.push_back(pos);
+        }
+    }
+
+    size_t count() const { return starts_.size(); }
+    size_t begin(size_t line) const { return line < starts_.size() ? starts_[line] : text_.size(); }
+    size_t end(size_t line) const { return begin(line + 1); }
+
+    // The line with its terminator
+    std::string_view raw(size_t line) const { return text_.substr(begin(line), end(line) - begin(line)); }
+
+    // The line without "\n" or "\r\n"
+    std::string_view content(size_t line) const {
+        std::string_view l = raw(line);
+        if (!l.empty() && l.back() == '\n') l.remove_suffix(1);
+        return StripCr(l);
+    }
+
+private:
+    std::string_view text_;
+    std::vector<size_t> starts_;
+};
+
+struct HunkLine {
+    char kind;             // ' ', '-' or '+'
+    std::string_view text; // without the marker or line ending
+    bool crlf = false;     // as written in the diff
+    bool no_newline = false;
+};
+
+struct Hunk {
+    size_t old_start = 0, old_count = 1;
+    size_t new_start = 0, new_count = 1;
+    std::string_view header;
+    std::vector<HunkLine> lines;
+};
+
+bool ParseNumber(std::string_view text, size_t* pos, size_t* out) {
+    size_t value = 0;
+    const size_t start = *pos;
+    while (*pos < text.size() && text[*pos] >= '0' && text[*pos] <= '9') {
+        value = value * 10 + static_cast<size_t>(text[*pos] - '0');
+        ++*pos;
+    }
+    *out = value;
+    return *pos > start;
+}
+
+// "@@ -a[,b] +c[,d] @@ optional section name"
+bool ParseHunkHeader(std::string_view line, Hunk* hunk) {
+    size_t pos = 0;
+    if (line.compare(0, 4, "@@ -") != 0) return false;
+    pos = 4;
+    if (!ParseNumber(line, &pos, &hunk->old_start)) return false;
+    if (pos < line.size() && line[pos] == ',') {
+        ++pos;
+        if (!ParseNumber(line, &pos, &hunk->old_count)) return false;
+    }
+    if (line.compare(pos, 2, " +") != 0) return false;
+    pos += 2;
+    if (!ParseNumber(line, &pos, &hunk->new_start)) return false;
+    if (pos < line.size() && line[pos] == ',') {
+        ++pos;
+        if (!ParseNumber(line, &pos, &hunk->new_count)) return false;
+    }
+    if (line.compare(pos, 3, " @@") != 0) return false;
+    hunk->header = line.substr(0, pos + 3);
+    return true;
+}
+
+bool ParseDiff(std::string_view diff, std::vector<Hunk>* hunks, std::string* error) {
+    Hunk* current = nullptr;
+    size_t old_seen = 0, new_seen = 0;
+    bool seen_target = false;
+
+    size_t pos = 0;
+    while (pos < diff.size()) {
+        size_t nl = diff.find('\n', pos);
+        if (nl == std::string_view::npos) nl = diff.size();
+        const std::string_view raw = diff.substr(pos, nl - pos);
+        const std::string_view line = StripCr(raw);
+        pos = nl + 1;
+
+        const bool in_hunk = current != nullptr && (old_seen < current->old_count || new_seen < current->new_count);
+        if (in_hunk) {
+            // Editors and mailers sometimes drop the space on empty context lines
+            const char kind = line.empty() ? ' ' : line[0];
+            if (kind == '\\') {
+                if (!current->lines.empty()) current->lines.back().no_newline = true;
+                continue;
+            }
+            if (kind != ' ' && kind != '-' && kind != '+') {
+                *error = "hunk " + std::to_string(hunks->size()) + " is truncated - " + std::string(current->header);
+                return false;
+            }
+            current->lines.push_back({kind, line.empty() ? line : line.substr(1), raw.size() != line.size()});
+            if (kind != '+') ++old_seen;
+            if (kind != '-') ++new_seen;
+            if (old_seen > current->old_count || new_seen > current->new_count) {
+                *error = "hunk " + std::to_string(hunks->size()) + " has more lines than its header says - " +
+                         std::string(current->header);
+                return false;
+            }
+            continue;
+        }
+
+        if (!line.empty() && line[0] == '\\') {
+            // Marker for the last line of a completed hunk
+            if (current != nullptr && !current->lines.empty()) current->lines.back().no_newline = true;
+        } else if (line.compare(0, 2, "@@") == 0) {
+            hunks->emplace_back();
+            current = &hunks->back();
+            if (!ParseHunkHeader(line, current)) {
+                *error = "malformed hunk header - " + std::string(line);
+                return false;
+            }
+            old_seen = new_seen = 0;
+        } else if (line.compare(0, 4, "+++ ") == 0) {
+            if (seen_target && !hunks->empty()) {
+                *error = "diff touches more than one file - apply each file separately";
+                return false;
+            }
+            seen_target = true;
+        }
+        // Anything else ("diff --git", "index", "---", commentary) is ignored
+    }
+
+    if (current != nullptr && (old_seen < current->old_count || new_seen < current->new_count)) {
+        *error = "hunk " + std::to_string(hunks->size()) + " is truncated - " + std::string(current->header);
+        return false;
+    }
+    if (hunks->empty()) {
+        *error = "diff has no hunks";
+        return false;
+    }
+    return true;
+}
+
+bool HunkMatchesAt(const LineTable& lines, const std::vector<std::string_view>& old_lines, size_t at) {
+    if (at + old_lines.size() > lines.count()) return false;
+    for (size_t j = 0; j < old_lines.size(); ++j) {
+        if (lines.content(at + j) != old_lines[j]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+PatchResult ApplyTextEdits(std::string_view original, const std::vector<TextEdit>& edits) {
+    PatchResult result;
+
+    struct Span {
+        size_t begin, end, edit;
+    };
+    std::vector<Span> spans;
+
+    for (size_t i = 0; i < edits.size(); ++i) {
+        const TextEdit& edit = edits[i];
+        if (edit.old_text.empty()) {
+            result.error = "edit " + std::to_string(i) + " has an empty old_text";
+            return result;
+        }
+        std::vector<size_t> found;
+        for (size_t pos = original.find(edit.old_text); pos != std::string_view::npos;
+             pos = original.find(edit.old_text, pos + edit.old_text.size())) {
+            found.push_back(pos);
+            if (!edit.replace_all && found.size() > 3) break;
+        }
+        if (found.empty()) {
+            result.error = "edit " + std::to_string(i) + " old_text not found";
+            return result;
+        }
+        if (!edit.replace_all && found.size() > 1) {
+            std::string lines;
+            for (size_t k = 0; k < std::min<size_t>(found.size(), 3); ++k) {
+                lines += (k ? ", " : "") + std::to_string(LineOf(original, found[k]));
+            }
+            result.error = "edit " + std::to_string(i) + " old_text matches " +
+                           (found.size() > 3 ? "more than 3" : std::to_string(found.size())) + " times (lines " +
+                           lines + (found.size() > 3 ? ", ..." : "") +
+                           ") - include more context or set replace_all";
+            return result;
+        }
+        for (size_t pos : found) spans.push_back({pos, pos + edit.old_text.size(), i});
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.begin < b.begin; });
+    size_t size = original.size();
+    for (size_t k = 0; k < spans.size(); ++k) {
+        if (k > 0 && spans[k].begin < spans[k - 1].end) {
+            result.error = "edits " + std::to_string(std::min(spans[k - 1].edit, spans[k].edit)) + " and " +
+                           std::to_string(std::max(spans[k - 1].edit, spans[k].edit)) + " overlap at line " +
+                           std::to_string(LineOf(original, spans[k].begin));
+            return result;
+        }
+        size = size - (spans[k].end - spans[k].begin) + edits[spans[k].edit].new_text.size();
+    }
+
+    // One pass over the original: unchanged runs are copied between matches
+    result.content.reserve(size);
+    size_t cursor = 0;
+    for (const Span& span : spans) {
+        result.content.append(original.data() + cursor, span.begin - cursor);
+        result.content += edits[span.edit].new_text;
+        cursor = span.end;
+    }
+    result.content.append(original.data() + cursor, original.size() - cursor);
+    result.replacements = spans.size();
+    return result;
+}
+
+PatchResult ApplyUnifiedDiff(std::string_view original, std::string_view diff) {
+    PatchResult result;
+    std::vector<Hunk> hunks;
+    if (!ParseDiff(diff, &hunks, &result.error)) return result;
+
+    const LineTable lines(original);
+    // Added lines follow the file's line ending; a file without one takes
+    // whatever the diff used
+    const size_t first_nl = original.find('\n');
+    const bool file_eol = first_nl != std::string_view::npos;
+    const std::string_view file_crlf = file_eol && first_nl > 0 && original[first_nl - 1] == '\r' ? "\r\n" : "\n";
+    auto eol_for = [&](const HunkLine& line) -> std::string_view {
+        return file_eol ? file_crlf : (line.crlf ? "\r\n" : "\n");
+    };
+
+    result.content.reserve(original.size() + diff.size());
+    size_t cursor = 0;    // bytes of the original already emitted
+    size_t min_line = 0;  // hunks may not overlap or go backwards
+    long long drift = 0;  // where the last hunk landed vs. where its header said
+
+    for (size_t h = 0; h < hunks.size(); ++h) {
+        const Hunk& hunk = hunks[h];
+        std::vector<std::string_view> old_lines;
+        for (const HunkLine& line : hunk.lines) {
+            if (line.kind != '+') old_lines.push_back(line.text);
+        }
+
+        // "-a,0" inserts after line a; otherwise the hunk starts at line a
+        const long long named = static_cast<long long>(hunk.old_count == 0 ? hunk.old_start
+                                                                           : std::max<size_t>(hunk.old_start, 1) - 1);
+        const long long last = static_cast<long long>(lines.count()) - static_cast<long long>(old_lines.size());
+        const long long expected = std::max<long long>(static_cast<long long>(min_line),
+                                                       std::min(named + drift, std::max(last, 0LL)));
+        long long at = -1;
+        if (old_lines.empty()) {
+            at = expected;
+        } else {
+            // Nearest fit to the expected line, searching outwards
+            for (long long d = 0; at < 0; ++d) {
+                const long long below = expected + d, above = expected - d;
+                const bool below_ok = below <= last;
+                const bool above_ok = d > 0 && above >= static_cast<long long>(min_line);
+                if (!below_ok && !above_ok) break;
+                if (below_ok && HunkMatchesAt(lines, old_lines, static_cast<size_t>(below))) at = below;
+                else if (above_ok && HunkMatchesAt(lines, old_lines, static_cast<size_t>(above))) at = above;
+            }
+        }
+        if (at < 0) {
+            result.error = "hunk " + std::to_string(h + 1) + " does not match the file - " + std::string(hunk.header);
+            return result;
+        }
+        drift = at - named;
+
+        const size_t first = static_cast<size_t>(at);
+        const size_t begin = lines.begin(first);
+        result.content.append(original.data() + cursor, begin - cursor);
+        // Inserting after a last line that has no newline needs one first
+        if (begin == original.size() && !original.empty() && original.back() != '\n' && hunk.new_count > 0) {
+            result.content += eol_for(hunk.lines.front());
+        }
+
+        size_t old_index = first;
+        for (size_t k = 0; k < hunk.lines.size(); ++k) {
+            const HunkLine& line = hunk.lines[k];
+            if (line.kind == '-') {
+                ++old_index;
+            } else if (line.kind == ' ') {
+                // Context keeps the file's own bytes, line ending included
+                const std::string_view raw = lines.raw(old_index++);
+                result.content.append(raw.data(), raw.size());
+                if ((raw.empty() || raw.back() != '\n') && !line.no_newline) result.content += eol_for(line);
+            } else {
+                result.content.append(line.text.data(), line.text.size());
+                if (!line.no_newline) result.content += eol_for(line);
+            }
+        }
+
+        cursor = lines.begin(old_index);
+        min_line = old_index;
+        ++result.hunks;
+    }
+    result.content.append(original.data() + cursor, original.size() - cursor);
+    return result;
+}
+
+} // namespace ece
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ece {
+
+// One exact-match replacement. `old_text` must occur exactly once in the
+// file unless `replace_all` is set.
+struct TextEdit {
+    std::string old_text;
+    std::string new_text;
+    bool replace_all = false;
+};
+
+struct PatchResult {
+    std::string content;   // the edited file
+    size_t replacements = 0;
+    size_t hunks = 0;      // unified diff hunks applied
+    std::string error;     // nothing is produced when set
+};
+
+// Applies `edits` to `original`. Every edit is located in the original text
+// (not in the output of earlier edits), matches may not overlap, and the
+// result is assembled in a single pass, so a handful of edits to a large file
+// costs one copy of it.
+PatchResult ApplyTextEdits(std::string_view original, const std::vector<TextEdit>& edits);
+
+// Applies a single-file unified diff (`---`/`+++` headers optional). Each
+// hunk is matched on its context and removed lines, first at the position
+// its header names (shifted by the drift of earlier hunks) and then at the
+// nearest position where it fits, as `patch` does. Added lines use the
+// file's line ending; "\ No newline at end of file" markers are honoured.
+PatchResult ApplyUnifiedDiff(std::string_view original, std::string_view diff);
+
+} // namespace ece
@@ -0,0 +1,302 @@
+#include "tool_bindings.hpp"
+#include "memory_index.hpp"
+#include "result_cache.hpp"
+#include "shell_runner.hpp"
+#include "tool_executor.hpp"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ece {
+
+namespace {
+
+// Length of the prefix of `text` that does not end inside a UTF-8 sequence.
+size_t CompleteUtf8Prefix(const std::string& text) {
+    size_t i = text.size();
+    size_t back = 0;
+    while (i > 0 && back < 4) {
+        const unsigned char c = static_cast<unsigned char>(text[i - 1]);
+        if ((c & 0xC0) != 0x80) {
+            const size_t need = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 1;
+            return back + 1 >= need ? text.size() : i - 1;
+        }
+        --i;
+        ++back;
+    }
+    return text.size();
+}
+
+// --- executeAsync / executeMany ---
+
+// Runs tool calls off the JS thread. A single call resolves with its result
+// string; a batch resolves with an array in request order.
+class ToolCallWorker : public Napi::AsyncWorker {
+public:
+    ToolCallWorker(Napi::Env env, std::vector<std::string> requests, bool batch, size_t max_workers)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          requests_(std::move(requests)),
+          batch_(batch),
+          max_workers_(max_workers) {}
+
+    Napi::Promise GetPromise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        if (batch_) {
+            results_ = ToolExecutor::ExecuteMany(requests_, max_workers_);
+        } else {
+            results_.push_back(ToolExecutor::Execute(requests_[0]));
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        if (!batch_) {
+            deferred_.Resolve(Napi::String::New(env, results_[0]));
+            return;
+        }
+        Napi::Array results = Napi::Array::New(env, results_.size());
+        for (size_t i = 0; i < results_.size(); ++i) {
+            results[static_cast<uint32_t>(i)] = Napi::String::New(env, results_[i]);
+        }
+        deferred_.Resolve(results);
+    }
+
+    void OnError(const Napi::Error& e) override {
+        deferred_.Reject(e.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<std::string> requests_;
+    std::vector<std::string> results_;
+    bool batch_;
+    size_t max_workers_;
+};
+
+// executeAsync(json) -> Promise<string>
+Napi::Value ExecuteAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto* worker = new ToolCallWorker(env, {info[0].As<Napi::String>().Utf8Value()}, false, 0);
+    Napi::Promise promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+}
+
+// executeMany(jsonArray, { concurrency }?) -> Promise<string[]>
+// Independent read-only calls (read_file, list_dir, search_memory) run
+// concurrently; results keep request order.
+Napi::Value ExecuteMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Array of JSON strings expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array input = info[0].As<Napi::Array>();
+    std::vector<std::string> requests;
+    requests.reserve(input.Length());
+    for (uint32_t i = 0; i < input.Length(); ++i) {
+        Napi::Value value = input.Get(i);
+        if (!value.IsString()) {
+            Napi::TypeError::New(env, "Element " + std::to_string(i) + " is not a string").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        requests.push_back(value.As<Napi::String>().Utf8Value());
+    }
+
+    size_t max_workers = 0;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("concurrency") && options.Get("concurrency").IsNumber()) {
+            const int64_t concurrency = options.Get("concurrency").As<Napi::Number>().Int64Value();
+            if (concurrency > 0) max_workers = static_cast<size_t>(concurrency);
+        }
+    }
+
+    auto* worker = new ToolCallWorker(env, std::move(requests), true, max_workers);
+    Napi::Promise promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+}
+
+// --- loadMemoryIndex ---
+
+// loadMemoryIndex(path) -> { compounds, labels, postings }
+// Maps an atom_positions export for search_memory. Replaces the current index;
+// on failure the previous one stays loaded and an Error is thrown.
+Napi::Value LoadMemoryIndex(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string error;
+    if (!MemoryIndex::Load(info[0].As<Napi::String>().Utf8Value(), &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::shared_ptr<const MemoryIndex> index = MemoryIndex::Current();
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("compounds", Napi::Number::New(env, index->compound_count()));
+    stats.Set("labels", Napi::Number::New(env, index->label_count()));
+    stats.Set("postings", Napi::Number::New(env, index->posting_count()));
+    return stats;
+}
+
+// --- toolCacheStats / clearToolCache ---
+
+// toolCacheStats() -> { hits, misses, evictions, invalidations, entries, bytes }
+// Counters for the read_file/list_dir result cache since the module loaded.
+Napi::Value ToolCacheStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const ResultCache::Stats cache = ResultCache::Shared().stats();
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("hits", Napi::Number::New(env, static_cast<double>(cache.hits)));
+    stats.Set("misses", Napi::Number::New(env, static_cast<double>(cache.misses)));
+    stats.Set("evictions", Napi::Number::New(env, static_cast<double>(cache.evictions)));
+    stats.Set("invalidations", Napi::Number::New(env, static_cast<double>(cache.invalidations)));
+    stats.Set("entries", Napi::Number::New(env, static_cast<double>(cache.entries)));
+    stats.Set("bytes", Napi::Number::New(env, static_cast<double>(cache.bytes)));
+    return stats;
+}
+
+// clearToolCache() drops every cached result; the counters keep running.
+Napi::Value ClearToolCache(const Napi::CallbackInfo& info) {
+    ResultCache::Shared().Clear();
+    return info.Env().Undefined();
+}
+
+// --- execShellStream ---
+
+struct ShellStreamContext {
+    explicit ShellStreamContext(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+    Napi::Promise::Deferred deferred;
+};
+
+struct ShellStreamEvent {
+    bool done = false;
+    bool is_stderr = false;
+    std::string chunk;
+    ShellResult result; // set on the final event; output fields are empty
+};
+
+void DeliverShellEvent(Napi::Env env, Napi::Function on_chunk, ShellStreamContext* context, ShellStreamEvent* event) {
+    std::unique_ptr<ShellStreamEvent> owned(event);
+    if (env == nullptr) return; // environment is shutting down
+
+    if (!event->done) {
+        on_chunk.Call({Napi::String::New(env, event->chunk), Napi::String::New(env, event->is_stderr ? "stderr" : "stdout")});
+        return;
+    }
+
+    const ShellResult& result = event->result;
+    if (!result.error.empty()) {
+        context->deferred.Reject(Napi::Error::New(env, result.error).Value());
+        return;
+    }
+    Napi::Object summary = Napi::Object::New(env);
+    summary.Set("exitCode", result.term_signal != 0 ? env.Null() : Napi::Number::New(env, result.exit_code));
+    summary.Set("signal", Napi::Number::New(env, result.term_signal));
+    summary.Set("timedOut", Napi::Boolean::New(env, result.timed_out));
+    summary.Set("truncated", Napi::Boolean::New(env, result.truncated));
+    context->deferred.Resolve(summary);
+}
+
+// execShellStream(command, onChunk, { timeoutMs, maxOutput }?) ->
+//   Promise<{ exitCode, signal, timedOut, truncated }>
+// The command runs on its own thread, not the libuv pool, so long builds do
+// not starve other async work. onChunk(text, 'stdout' | 'stderr') is called
+// on the JS thread as output arrives; chunks never split a UTF-8 character.
+Napi::Value ExecShellStream(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsFunction()) {
+        Napi::TypeError::New(env, "Expected (command: string, onChunk: function, options?)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string command = info[0].As<Napi::String>().Utf8Value();
+    ShellOptions options;
+    if (info.Length() > 2 && info[2].IsObject()) {
+        Napi::Object opts = info[2].As<Napi::Object>();
+        if (opts.Has("timeoutMs") && opts.Get("timeoutMs").IsNumber()) {
+            options.timeout_ms = opts.Get("timeoutMs").As<Napi::Number>().Int64Value();
+        }
+        if (opts.Has("maxOutput") && opts.Get("maxOutput").IsNumber()) {
+            const int64_t max_output = opts.Get("maxOutput").As<Napi::Number>().Int64Value();
+            if (max_output >= 0) options.max_output = static_cast<size_t>(max_output);
+        }
+    }
+
+    auto* context = new ShellStreamContext(env);
+    Napi::Promise promise = context->deferred.Promise();
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+        env, info[1].As<Napi::Function>(), "execShellStream", 0, 1, context,
+        [](Napi::Env, ShellStreamContext* ctx) { delete ctx; });
+
+    std::thread([tsfn, context, command = std::move(command), options]() mutable {
+        auto deliver = [context](Napi::Env js_env, Napi::Function on_chunk, ShellStreamEvent* event) {
+            DeliverShellEvent(js_env, on_chunk, context, event);
+        };
+        auto post = [&](ShellStreamEvent* event) {
+            if (tsfn.BlockingCall(event, deliver) != napi_ok) delete event;
+        };
+
+        std::string pending[2];
+        auto emit = [&](bool is_stderr, std::string text) {
+            auto* event = new ShellStreamEvent();
+            event->is_stderr = is_stderr;
+            event->chunk = std::move(text);
+            post(event);
+        };
+
+        ShellResult result = RunShellCommand(command, options, [&](bool is_stderr, std::string_view chunk) {
+            std::string& buffer = pending[is_stderr ? 1 : 0];
+            buffer.append(chunk);
+            const size_t ready = CompleteUtf8Prefix(buffer);
+            if (ready == 0) return;
+            emit(is_stderr, buffer.substr(0, ready));
+            buffer.erase(0, ready);
+        });
+        for (int i = 0; i < 2; ++i) {
+            if (!pending[i].empty()) emit(i == 1, std::move(pending[i]));
+        }
+
+        auto* done = new ShellStreamEvent();
+        done->done = true;
+        result.out.clear(); // already streamed
+        result.err.clear();
+        done->result = std::move(result);
+        post(done);
+        tsfn.Release();
+    }).detach();
+
+    return promise;
+}
+
+} // namespace
+
+Napi::Object InitToolBindings(Napi::Env env, Napi::Object exports) {
+    exports.Set("executeAsync", Napi::Function::New(env, ExecuteAsync));
+    exports.Set("executeMany", Napi::Function::New(env, ExecuteMany));
+    exports.Set("loadMemoryIndex", Napi::Function::New(env, LoadMemoryIndex));
+    exports.Set("toolCacheStats", Napi::Function::New(env, ToolCacheStats));
+    exports.Set("clearToolCache", Napi::Function::New(env, ClearToolCache));
+    exports.Set("execShellStream", Napi::Function::New(env, ExecShellStream));
+    return exports;
+}
+
+} // namespace ece
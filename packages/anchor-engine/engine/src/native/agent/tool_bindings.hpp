@@ -0,0 +1,10 @@
+#pragma once
+#include <napi.h>
+
+namespace ece {
+
+// Registers the asynchronous agent tool entry points on the module exports
+// (the synchronous executeTool binding is registered alongside it).
+Napi::Object InitToolBindings(Napi::Env env, Napi::Object exports);
+
+} // namespace ece
@@ -1,142 +1,326 @@
 #include "tool_executor.hpp"
+#include "json.hpp"
+#include "file_reader.hpp"
+#include "../worker_pool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <array>
 #include <memory>
 #include <stdexcept>
-#include <regex>
-
-// Minimal JSON parser for extracting tool and params
-// In production, we could link nlohmann/json if needed
+#include <unordered_map>
 
 namespace ece {
 
 namespace fs = std::filesystem;
 
 std::string ToolExecutor::Execute(const std::string& json_command) {
-    try {
-        // Use regex to extract tool name
-        std::regex tool_regex("\"tool\"\\s*:\\s*\"([^\"]+)\"");
-        std::smatch tool_match;
+    JsonDocument doc;
+    std::string parse_error;
+    if (!doc.Parse(json_command, &parse_error)) {
+        return "Error: Invalid JSON format - " + parse_error;
+    }
+    return Dispatch(doc.root());
+}
 
-        if (!std::regex_search(json_command, tool_match, tool_regex)) {
-            return "Error: Invalid JSON format - no tool specified";
+std::vector<std::string> ToolExecutor::ExecuteMany(const std::vector<std::string>& json_commands, size_t max_workers) {
+    const size_t count = json_commands.size();
+    std::vector<std::string> results(count);
+    std::vector<std::unique_ptr<JsonDocument>> docs(count);
+    std::vector<bool> concurrent(count, false);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto doc = std::make_unique<JsonDocument>();
+        std::string parse_error;
+        if (!doc->Parse(json_commands[i], &parse_error)) {
+            results[i] = "Error: Invalid JSON format - " + parse_error;
+            continue;
         }
+        const JsonValue* tool = doc->root().Find("tool");
+        concurrent[i] = tool != nullptr && tool->IsString() && IsReadOnlyTool(tool->string);
+        docs[i] = std::move(doc);
+    }
 
-        std::string tool = tool_match[1].str();
+    // Runs of read-only calls go to the pool together; anything with side
+    // effects runs alone, after everything before it and before anything after
+    size_t i = 0;
+    while (i < count) {
+        if (!docs[i]) {
+            ++i;
+        } else if (!concurrent[i]) {
+            results[i] = Dispatch(docs[i]->root());
+            ++i;
+        } else {
+            size_t end = i;
+            while (end < count && (concurrent[end] || !docs[end])) ++end;
+            WorkerPool::Shared().ParallelFor(end - i, [&, first = i](size_t k) {
+                if (docs[first + k]) results[first + k] = Dispatch(docs[first + k]->root());
+            }, max_workers);
+            i = end;
+        }
+    }
+    return results;
+}
 
-        // Extract params object
-        std::regex params_regex("\"params\"\\s*:\\s*(\\{[^}]*\\})");
-        std::smatch params_match;
+bool ToolExecutor::IsReadOnlyTool(std::string_view tool) {
+    return tool == "read_file" || tool == "list_dir" || tool == "glob" || tool == "grep" ||
+           tool == "search_memory";
+}
 
-        std::string params_obj = "{}"; // default empty object
-        if (std::regex_search(json_command, params_match, params_regex)) {
-            params_obj = params_match[1].str();
+std::string ToolExecutor::Dispatch(const JsonValue& root) {
+    try {
+        const JsonValue* tool = root.Find("tool");
+        if (tool == nullptr || !tool->IsString()) {
+            return "Error: Invalid JSON format - no tool specified";
         }
-        
-        // Dispatch based on tool
-        if (tool == "read_file") {
-            // Extract path from params
-            std::regex path_regex("\"path\"\\s*:\\s*\"([^\"]+)\"");
-            std::smatch path_match;
-
-            if (std::regex_search(params_obj, path_match, path_regex)) {
-                std::string path = path_match[1].str();
-                return ReadFile(path);
-            } else {
-                return "Error: read_file tool requires 'path' parameter";
-            }
+
+        // Built once; lookups hash the tool name instead of walking a chain
+        using Handler = std::string (*)(const JsonValue&);
+        static const std::unordered_map<std::string_view, Handler> kTools = {
+            {"read_file", &ToolExecutor::RunReadFile},
+            {"write_file", &ToolExecutor::RunWriteFile},
+            {"write_files", &ToolExecutor::RunWriteFiles},
+            {"apply_edit", &ToolExecutor::RunApplyEdit},
+            {"list_dir", &ToolExecutor::RunListDir},
+            {"glob", &ToolExecutor::RunGlob},
+            {"grep", &ToolExecutor::RunGrep},
+            {"exec_shell", &ToolExecutor::RunExecShell},
+            {"search_memory", &ToolExecutor::RunSearchMemory},
+        };
+
+        auto it = kTools.find(tool->string);
+        if (it == kTools.end()) {
+            return "Error: Unknown tool '" + std::string(tool->string) + "'";
         }
-        else if (tool == "write_file") {
-            // Extract path and content from params
-            std::regex path_regex("\"path\"\\s*:\\s*\"([^\"]+)\"");
-            std::regex content_regex("\"content\"\\s*:\\s*\"([^\"]*)\"");
 
-            std::smatch path_match, content_match;
-            std::string path, content;
+        // A missing params object behaves like {}
+        static const JsonValue kNoParams = [] {
+            JsonValue empty;
+            empty.type = JsonValue::Type::Object;
+            return empty;
+        }();
+        const JsonValue* params = root.Find("params");
+        return it->second(params && params->IsObject() ? *params : kNoParams);
+    }
+    catch (const std::exception& e) {
+        return "Error: Exception in Execute - " + std::string(e.what());
+    }
+    catch (...) {
+        return "Error: Unknown exception in Execute";
+    }
+}
 
-            if (std::regex_search(params_obj, path_match, path_regex)) {
-                path = path_match[1].str();
-            } else {
-                return "Error: write_file tool requires 'path' parameter";
-            }
+// --- Tool entry points: validate params, then call the implementation ---
 
-            if (std::regex_search(params_obj, content_match, content_regex)) {
-                content = content_match[1].str();
-                // Handle escaped characters in content
-                std::string unescaped_content;
-                unescaped_content.reserve(content.length());
-                for (size_t i = 0; i < content.length(); ++i) {
-                    if (content[i] == '\\' && i + 1 < content.length()) {
-                        switch (content[i + 1]) {
-                            case 'n': unescaped_content += '\n'; i++; break;
-                            case 't': unescaped_content += '\t'; i++; break;
-                            case 'r': unescaped_content += '\r'; i++; break;
-                            case '\\': unescaped_content += '\\'; i++; break;
-                            case '"': unescaped_content += '"'; i++; break;
-                            default: unescaped_content += content[i]; break;
-                        }
-                    } else {
-                        unescaped_content += content[i];
-                    }
-                }
-                content = unescaped_content;
-            } else {
-                return "Error: write_file tool requires 'content' parameter";
-            }
+std::string ToolExecutor::RunReadFile(const JsonValue& params) {
+    const JsonValue* path = params.Find("path");
+    if (path == nullptr || !path->IsString()) {
+        return "Error: read_file tool requires 'path' parameter";
+    }
 
-            return WriteFile(path, content);
-        }
-        else if (tool == "list_dir") {
-            // Extract path from params, default to current directory
-            std::regex path_regex("\"path\"\\s*:\\s*\"([^\"]+)\"");
-            std::smatch path_match;
+    // Optional window: byte offset/length or 1-based line range, capped at
+    // max_bytes (0 = no cap)
+    ReadRange range;
+    range.offset = static_cast<uint64_t>(std::max<int64_t>(0, params.GetInt("offset", 0)));
+    const int64_t length = params.GetInt("length", -1);
+    if (length >= 0) range.length = static_cast<uint64_t>(length);
+    range.start_line = static_cast<uint64_t>(std::max<int64_t>(0, params.GetInt("start_line", 0)));
+    range.end_line = static_cast<uint64_t>(std::max<int64_t>(0, params.GetInt("end_line", 0)));
+    range.max_bytes = static_cast<size_t>(std::max<int64_t>(0, params.GetInt("max_bytes", static_cast<int64_t>(range.max_bytes))));
+    return ReadFile(std::string(path->string), range);
+}
 
-            std::string path = ".";
-            if (std::regex_search(params_obj, path_match, path_regex)) {
-                path = path_match[1].str();
-            }
+std::string ToolExecutor::RunWriteFile(const JsonValue& params) {
+    const JsonValue* path = params.Find("path");
+    if (path == nullptr || !path->IsString()) {
+        return "Error: write_file tool requires 'path' parameter";
+    }
+    const JsonValue* content = params.Find("content");
+    if (content == nullptr || !content->IsString()) {
+        return "Error: write_file tool requires 'content' parameter";
+    }
+    return WriteFile(std::string(path->string), std::string(content->string),
+                     params.GetBool("append", false), params.GetBool("fsync", true));
+}
 
-            return ListDir(path);
+std::string ToolExecutor::RunWriteFiles(const JsonValue& params) {
+    const JsonValue* files = params.Find("files");
+    if (files == nullptr || !files->IsArray()) {
+        return "Error: write_files tool requires 'files' parameter";
+    }
+    std::vector<FileWrite> writes;
+    writes.reserve(files->size);
+    for (const JsonValue& file : *files) {
+        const JsonValue* path = file.Find("path");
+        const JsonValue* content = file.Find("content");
+        if (!file.IsObject() || path == nullptr || !path->IsString() || content == nullptr || !content->IsString()) {
+            return "Error: write_files entry " + std::to_string(writes.size()) + " requires 'path' and 'content'";
         }
-        else if (tool == "exec_shell") {
-            // Extract command from params
-            std::regex cmd_regex("\"command\"\\s*:\\s*\"([^\"]+)\"");
-            std::smatch cmd_match;
+        writes.push_back({std::string(path->string), std::string(content->string), file.GetBool("append", false)});
+    }
+    return WriteFiles(writes, params.GetBool("fsync", true));
+}
 
-            if (std::regex_search(params_obj, cmd_match, cmd_regex)) {
-                std::string cmd = cmd_match[1].str();
-                return ExecShell(cmd);
-            } else {
-                return "Error: exec_shell tool requires 'command' parameter";
+std::string ToolExecutor::RunApplyEdit(const JsonValue& params) {
+    const JsonValue* path = params.Find("path");
+    if (path == nullptr || !path->IsString()) {
+        return "Error: apply_edit tool requires 'path' parameter";
+    }
+
+    // Either a unified diff, an edits array, or one old_text/new_text pair
+    std::vector<TextEdit> edits;
+    const JsonValue* diff = params.Find("diff");
+    const JsonValue* list = params.Find("edits");
+    if (list != nullptr && list->IsArray()) {
+        edits.reserve(list->size);
+        for (const JsonValue& edit : *list) {
+            const JsonValue* old_text = edit.Find("old_text");
+            const JsonValue* new_text = edit.Find("new_text");
+            if (!edit.IsObject() || old_text == nullptr || !old_text->IsString() || new_text == nullptr || !new_text->IsString()) {
+                return "Error: apply_edit edit " + std::to_string(edits.size()) + " requires 'old_text' and 'new_text'";
             }
+            edits.push_back({std::string(old_text->string), std::string(new_text->string), edit.GetBool("replace_all", false)});
+        }
+    } else if (params.Find("old_text") != nullptr) {
+        const JsonValue* old_text = params.Find("old_text");
+        const JsonValue* new_text = params.Find("new_text");
+        if (!old_text->IsString() || new_text == nullptr || !new_text->IsString()) {
+            return "Error: apply_edit tool requires 'old_text' and 'new_text' strings";
         }
-        else if (tool == "search_memory") {
-            // Extract query from params
-            std::regex query_regex("\"query\"\\s*:\\s*\"([^\"]+)\"");
-            std::smatch query_match;
+        edits.push_back({std::string(old_text->string), std::string(new_text->string), params.GetBool("replace_all", false)});
+    }
 
-            if (std::regex_search(params_obj, query_match, query_regex)) {
-                std::string query = query_match[1].str();
-                return SearchMemory(query);
-            } else {
-                return "Error: search_memory tool requires 'query' parameter";
+    const bool has_diff = diff != nullptr && diff->IsString();
+    if (has_diff == !edits.empty()) {
+        return "Error: apply_edit tool requires exactly one of 'edits', 'old_text'/'new_text' or 'diff'";
+    }
+    return ApplyEdit(std::string(path->string), edits, has_diff ? std::string(diff->string) : std::string(),
+                     params.GetBool("fsync", true));
+}
+
+namespace {
+
+// Walk params shared by list_dir, glob and grep; the glob filter (`glob_key`)
+// is a string or an array of strings.
+void ReadWalkOptions(const JsonValue& params, std::string_view glob_key, WalkOptions* options) {
+    if (const JsonValue* pattern = params.Find(glob_key)) {
+        if (pattern->IsString()) {
+            options->globs.emplace_back(pattern->string);
+        } else if (pattern->IsArray()) {
+            for (const JsonValue& item : *pattern) {
+                if (item.IsString()) options->globs.emplace_back(item.string);
             }
         }
-        else {
-            return "Error: Unknown tool '" + tool + "'";
+    }
+    options->max_entries = static_cast<size_t>(std::max<int64_t>(1, params.GetInt("max_entries", static_cast<int64_t>(options->max_entries))));
+    options->include_hidden = params.GetBool("hidden", options->include_hidden);
+    options->gitignore = params.GetBool("gitignore", options->gitignore);
+}
+
+// Appends a listed path with backslash, tab, newline and CR written as C
+// escapes, so such names cannot break the one-entry-per-line output.
+void AppendListedPath(std::string_view path, std::string* out) {
+    for (const char c : path) {
+        switch (c) {
+            case '\\': out->append("\\\\"); break;
+            case '\t': out->append("\\t"); break;
+            case '\n': out->append("\\n"); break;
+            case '\r': out->append("\\r"); break;
+            default: out->push_back(c);
         }
     }
-    catch (const std::exception& e) {
-        return "Error: Exception in Execute - " + std::string(e.what());
+}
+
+} // namespace
+
+std::string ToolExecutor::RunListDir(const JsonValue& params) {
+    // One level by default; recursive (or a pattern) walks the whole tree
+    // unless max_depth says otherwise
+    WalkOptions options;
+    options.max_entries = 1000;
+    ReadWalkOptions(params, "pattern", &options);
+    const bool recursive = params.GetBool("recursive", !options.globs.empty());
+    options.max_depth = static_cast<uint32_t>(std::clamp<int64_t>(params.GetInt("max_depth", recursive ? 0 : 1), 0, UINT32_MAX));
+    return ListDir(std::string(params.GetString("path", ".")), options);
+}
+
+std::string ToolExecutor::RunGlob(const JsonValue& params) {
+    const JsonValue* pattern = params.Find("pattern");
+    if (pattern == nullptr || !(pattern->IsString() || pattern->IsArray())) {
+        return "Error: glob tool requires 'pattern' parameter";
     }
-    catch (...) {
-        return "Error: Unknown exception in Execute";
+    WalkOptions options;
+    options.max_entries = 1000;
+    options.files_only = true;
+    ReadWalkOptions(params, "pattern", &options);
+    options.max_depth = static_cast<uint32_t>(std::clamp<int64_t>(params.GetInt("max_depth", 0), 0, UINT32_MAX));
+    return ListDir(std::string(params.GetString("path", ".")), options);
+}
+
+std::string ToolExecutor::RunGrep(const JsonValue& params) {
+    const JsonValue* pattern = params.Find("pattern");
+    if (pattern == nullptr || !pattern->IsString()) {
+        return "Error: grep tool requires 'pattern' parameter";
+    }
+    GrepOptions options;
+    options.walk.max_entries = 200000; // files considered, not matches
+    ReadWalkOptions(params, "glob", &options.walk);
+    options.walk.max_depth = static_cast<uint32_t>(std::clamp<int64_t>(params.GetInt("max_depth", 0), 0, UINT32_MAX));
+    options.ignore_case = params.GetBool("ignore_case", false);
+    options.fixed_strings = params.GetBool("fixed_strings", false);
+    options.max_matches = static_cast<size_t>(std::max<int64_t>(1, params.GetInt("max_matches", static_cast<int64_t>(options.max_matches))));
+    options.max_per_file = static_cast<size_t>(std::max<int64_t>(0, params.GetInt("max_per_file", 0)));
+    options.snippet_bytes = static_cast<size_t>(std::max<int64_t>(0, params.GetInt("snippet_bytes", static_cast<int64_t>(options.snippet_bytes))));
+    return GrepFiles(std::string(params.GetString("path", ".")), std::string(pattern->string), options);
+}
+
+std::string ToolExecutor::RunExecShell(const JsonValue& params) {
+    const JsonValue* command = params.Find("command");
+    if (command == nullptr || !command->IsString()) {
+        return "Error: exec_shell tool requires 'command' parameter";
     }
+    ShellOptions options;
+    options.timeout_ms = params.GetInt("timeout_ms", options.timeout_ms);
+    options.max_output = static_cast<size_t>(std::max<int64_t>(0, params.GetInt("max_output", static_cast<int64_t>(options.max_output))));
+    return ExecShell(std::string(command->string), options);
 }
 
-std::string ToolExecutor::ReadFile(const std::string& path) {
+std::string ToolExecutor::RunSearchMemory(const JsonValue& params) {
+    const JsonValue* query = params.Find("query");
+    if (query == nullptr || !query->IsString()) {
+        return "Error: search_memory tool requires 'query' parameter";
+    }
+    MemoryIndex::SearchOptions options;
+    options.limit = static_cast<size_t>(std::max<int64_t>(1, params.GetInt("limit", static_cast<int64_t>(options.limit))));
+    options.radius = static_cast<uint32_t>(std::clamp<int64_t>(params.GetInt("radius", options.radius), 0, UINT32_MAX));
+    options.max_window = static_cast<uint32_t>(std::clamp<int64_t>(params.GetInt("max_window", 0), 0, UINT32_MAX));
+    options.prefix = params.GetBool("prefix", false);
+    return SearchMemory(std::string(query->string), options);
+}
+
+std::string ToolExecutor::ReadFile(const std::string& path, const ReadRange& range) {
+    const std::string normal = ResultCache::NormalPath(path);
+    const std::string key = "read_file\n" + normal + "\n" + std::to_string(range.offset) + "," +
+                            std::to_string(range.length) + "," + std::to_string(range.start_line) + "," +
+                            std::to_string(range.end_line) + "," + std::to_string(range.max_bytes);
+    std::string result;
+    if (ResultCache::Shared().Lookup(key, &result)) {
+        return result;
+    }
+
+    // Stamped before reading, so a change while reading is seen next time
+    const FileStamp stamp = FileStamp::Of(normal);
+    result = ReadWindow(path, range);
+    if (stamp.exists && result.compare(0, 6, "Error:") != 0) {
+        ResultCache::Shared().Store(key, result, {{normal, stamp}});
+    }
+    return result;
+}
+
+std::string ToolExecutor::ReadWindow(const std::string& path, const ReadRange& range) {
     try {
         if (!fs::exists(path)) {
             return "Error: File not found - " + path;
@@ -146,14 +330,86 @@ std::string ToolExecutor::ReadFile(const std::string& path) {
             return "Error: Path is not a regular file - " + path;
         }
         
-        std::ifstream f(path);
-        if (!f.is_open()) {
-            return "Error: Cannot open file - " + path;
+        // Read, not mapped: workspace files can be truncated under us
+        FileReader file;
+        std::string error;
+        if (!file.Open(path, &error)) {
+            return "Error: " + error;
         }
-        
-        std::stringstream buffer;
-        buffer << f.rdbuf();
-        return buffer.str();
+        const uint64_t size = file.size();
+
+        std::string buffer;
+        std::string_view window;
+        size_t begin = 0;
+        if (range.start_line > 0) {
+            // Line mode (1-based, inclusive) takes precedence over offset/length.
+            // Read in blocks: skip to start_line, then collect until end_line
+            // or one byte past max_bytes, so a range near the top of a huge
+            // file costs only the bytes up to it
+            constexpr uint64_t kLineBlock = 64 * 1024;
+            uint64_t line = 1;
+            uint64_t pos = 0;
+            while (line < range.start_line && pos < size) {
+                std::string block;
+                if (!file.Read(pos, kLineBlock, &block, &error)) {
+                    return "Error: " + error;
+                }
+                if (block.empty()) break; // truncated since Open
+                size_t i = 0;
+                while (line < range.start_line) {
+                    const void* nl = std::memchr(block.data() + i, '\n', block.size() - i);
+                    if (!nl) {
+                        i = block.size();
+                        break;
+                    }
+                    i = static_cast<size_t>(static_cast<const char*>(nl) - block.data()) + 1;
+                    ++line;
+                }
+                pos += i;
+            }
+            begin = static_cast<size_t>(pos);
+
+            const uint64_t cap = range.max_bytes > 0 ? uint64_t{range.max_bytes} + 1 : size;
+            const bool bounded = range.end_line >= range.start_line;
+            while (buffer.size() < cap && !(bounded && line > range.end_line)) {
+                const size_t scanned = buffer.size();
+                if (!file.Read(pos, std::min<uint64_t>(kLineBlock, cap - scanned), &buffer, &error)) {
+                    return "Error: " + error;
+                }
+                if (buffer.size() == scanned) break; // end of file
+                pos += buffer.size() - scanned;
+                for (size_t i = scanned; bounded && line <= range.end_line;) {
+                    const void* nl = std::memchr(buffer.data() + i, '\n', buffer.size() - i);
+                    if (!nl) break;
+                    i = static_cast<size_t>(static_cast<const char*>(nl) - buffer.data()) + 1;
+                    if (line++ == range.end_line) buffer.resize(i);
+                }
+            }
+            window = buffer;
+        } else {
+            // Byte mode reads only the window, plus the byte after a cut so
+            // it can land on a UTF-8 boundary: a window near the start of a
+            // huge file costs only its own bytes
+            begin = static_cast<size_t>(std::min<uint64_t>(range.offset, size));
+            uint64_t length = std::min<uint64_t>(range.length, size - begin);
+            if (range.max_bytes > 0) length = std::min<uint64_t>(length, uint64_t{range.max_bytes} + 1);
+            if (!file.Read(begin, length, &buffer, &error)) {
+                return "Error: " + error;
+            }
+            window = buffer;
+        }
+
+        if (range.max_bytes == 0 || window.size() <= range.max_bytes) {
+            return window.size() == buffer.size() ? buffer : std::string(window);
+        }
+
+        // Cut on a UTF-8 boundary and say where to continue from
+        size_t cut = range.max_bytes;
+        while (cut > 0 && (static_cast<unsigned char>(window[cut]) & 0xC0) == 0x80) --cut;
+        std::string result(window.substr(0, cut));
+        result += "\n... [TRUNCATED - returned bytes " + std::to_string(begin) + "-" + std::to_string(begin + cut) +
+                  " of " + std::to_string(size) + "; pass offset/length to read more]";
+        return result;
     }
     catch (const std::exception& e) {
         return "Error: Exception reading file " + path + " - " + std::string(e.what());
@@ -163,23 +419,16 @@ std::string ToolExecutor::ReadFile(const std::string& path) {
     }
 }
 
-std::string ToolExecutor::WriteFile(const std::string& path, const std::string& content) {
+std::string ToolExecutor::WriteFile(const std::string& path, const std::string& content, bool append, bool durable) {
     try {
-        // Create directory if it doesn't exist
-        fs::path p(path);
-        if (p.parent_path() != "") {
-            fs::create_directories(p.parent_path());
+        // Temp file + rename: readers (and the watchdog) never see a torn file
+        WriteBatchResult write = WriteFilesAtomic({FileWrite{path, content, append}}, durable);
+        ResultCache::Shared().Invalidate(path);
+        if (!write.error.empty()) {
+            return "Error: " + write.error;
         }
-        
-        std::ofstream f(path);
-        if (!f.is_open()) {
-            return "Error: Cannot create/write file - " + path;
-        }
-        
-        f << content;
-        f.close();
-        
-        return "Success: Written " + std::to_string(content.size()) + " bytes to " + path;
+        return std::string(append ? "Success: Appended " : "Success: Written ") +
+               std::to_string(content.size()) + " bytes to " + path;
     }
     catch (const std::exception& e) {
         return "Error: Exception writing file " + path + " - " + std::string(e.what());
@@ -189,8 +438,93 @@ std::string ToolExecutor::WriteFile(const std::string& path, const std::string&
     }
 }
 
-std::string ToolExecutor::ListDir(const std::string& path) {
+std::string ToolExecutor::WriteFiles(const std::vector<FileWrite>& writes, bool durable) {
+    try {
+        WriteBatchResult write = WriteFilesAtomic(writes, durable);
+        for (const FileWrite& file : writes) {
+            ResultCache::Shared().Invalidate(file.path);
+        }
+        if (!write.error.empty()) {
+            return "Error: " + write.error + " - " + std::to_string(write.files) + " of " +
+                   std::to_string(writes.size()) + " files written";
+        }
+        return "Success: Written " + std::to_string(write.files) + " files (" + std::to_string(write.bytes) +
+               " bytes) in " + std::to_string(write.directories) + " directories";
+    }
+    catch (const std::exception& e) {
+        return "Error: Exception writing files - " + std::string(e.what());
+    }
+    catch (...) {
+        return "Error: Unknown exception writing files";
+    }
+}
+
+std::string ToolExecutor::ApplyEdit(const std::string& path, const std::vector<TextEdit>& edits, const std::string& diff, bool durable) {
     try {
+        if (!fs::exists(path)) {
+            return "Error: File not found - " + path;
+        }
+
+        if (!fs::is_regular_file(path)) {
+            return "Error: Path is not a regular file - " + path;
+        }
+
+        // Read, not mapped: the file can be truncated under us
+        PatchResult patch;
+        size_t old_size = 0;
+        {
+            FileReader file;
+            std::string original, error;
+            if (!file.Open(path, &error) || !file.ReadAll(&original, &error)) {
+                return "Error: " + error;
+            }
+            old_size = original.size();
+            patch = diff.empty() ? ApplyTextEdits(original, edits) : ApplyUnifiedDiff(original, diff);
+        }
+        if (!patch.error.empty()) {
+            return "Error: Edit not applied to " + path + " - " + patch.error;
+        }
+
+        const size_t new_size = patch.content.size();
+        WriteBatchResult write = WriteFilesAtomic({FileWrite{path, std::move(patch.content), false}}, durable);
+        ResultCache::Shared().Invalidate(path);
+        if (!write.error.empty()) {
+            return "Error: " + write.error;
+        }
+        const std::string applied = diff.empty() ? std::to_string(patch.replacements) + " replacement(s)"
+                                                 : std::to_string(patch.hunks) + " hunk(s)";
+        return "Success: Applied " + applied + " to " + path + " (" + std::to_string(old_size) + " -> " +
+               std::to_string(new_size) + " bytes)";
+    }
+    catch (const std::exception& e) {
+        return "Error: Exception editing file " + path + " - " + std::string(e.what());
+    }
+    catch (...) {
+        return "Error: Unknown exception editing file " + path;
+    }
+}
+
+std::string ToolExecutor::ListDir(const std::string& path, const WalkOptions& options) {
+    try {
+        // A single-level listing depends only on the directory, its entries
+        // and its .gitignore, so it can be validated cheaply; deeper walks
+        // are not cached
+        const bool cacheable = options.max_depth == 1;
+        std::string normal, key;
+        FileStamp dir_stamp;
+        if (cacheable) {
+            normal = ResultCache::NormalPath(path);
+            key = "list_dir\n" + normal + "\n" + std::to_string(options.max_entries) + "," +
+                  std::to_string(options.include_hidden) + std::to_string(options.gitignore) +
+                  std::to_string(options.files_only) + std::to_string(options.stat);
+            for (const std::string& glob : options.globs) key += "\n" + glob;
+            std::string cached;
+            if (ResultCache::Shared().Lookup(key, &cached)) {
+                return cached;
+            }
+            dir_stamp = FileStamp::Of(normal);
+        }
+
         if (!fs::exists(path)) {
             return "Error: Directory not found - " + path;
         }
@@ -199,14 +533,55 @@ std::string ToolExecutor::ListDir(const std::string& path) {
             return "Error: Path is not a directory - " + path;
         }
         
+        WalkResult walk = WalkDirectory(path, options);
+        if (!walk.error.empty()) {
+            return "Error: " + walk.error;
+        }
+
+        // One entry per line: path (escaped; directories end in '/', symlinks
+        // in '@'), size in bytes ('-' for directories) and UTC mtime
         std::string result;
-        for (const auto& entry : fs::directory_iterator(path)) {
-            result += entry.path().filename().string();
-            if (entry.is_directory()) {
-                result += "/";
+        for (const WalkEntry& entry : walk.entries) {
+            AppendListedPath(entry.path, &result);
+            if (entry.type == WalkEntry::Type::Directory) {
+                result += "/\t-\t";
+            } else {
+                if (entry.type == WalkEntry::Type::Symlink) result += "@";
+                result += "\t" + std::to_string(entry.size) + "\t";
             }
+            const std::time_t seconds = static_cast<std::time_t>(entry.mtime_ms / 1000);
+            std::tm utc{};
+#ifdef _WIN32
+            gmtime_s(&utc, &seconds);
+#else
+            gmtime_r(&seconds, &utc);
+#endif
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+            result += stamp;
             result += "\n";
         }
+        if (walk.truncated) {
+            result += "... [TRUNCATED - first " + std::to_string(options.max_entries) +
+                      " entries by path; narrow the pattern or raise max_entries]\n";
+        }
+
+        if (cacheable && dir_stamp.exists) {
+            // Entry stamps are taken after the walk; one that changed in
+            // between is recent enough that Store declines it
+            ResultCache::Dependencies dependencies;
+            dependencies.reserve(walk.entries.size() + 2);
+            dependencies.emplace_back(normal, dir_stamp);
+            if (options.gitignore) {
+                const std::string gitignore = (fs::u8path(normal) / ".gitignore").u8string();
+                dependencies.emplace_back(gitignore, FileStamp::Of(gitignore));
+            }
+            for (const WalkEntry& entry : walk.entries) {
+                const std::string child = (fs::u8path(normal) / fs::u8path(entry.path)).u8string();
+                dependencies.emplace_back(child, FileStamp::Of(child));
+            }
+            ResultCache::Shared().Store(key, result, std::move(dependencies));
+        }
         return result;
     }
     catch (const std::exception& e) {
@@ -217,27 +592,65 @@ std::string ToolExecutor::ListDir(const std::string& path) {
     }
 }
 
-std::string ToolExecutor::ExecShell(const std::string& cmd) {
+std::string ToolExecutor::GrepFiles(const std::string& path, const std::string& pattern, const GrepOptions& options) {
     try {
-        std::array<char, 128> buffer;
-        std::string result;
-        
-#ifdef _WIN32
-        // Windows implementation
-        std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(cmd.c_str(), "r"), _pclose);
-#else
-        // Unix-like implementation
-        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd.c_str(), "r"), pclose);
-#endif
-        
-        if (!pipe) {
-            return "Error: Failed to execute command - " + cmd;
+        if (!fs::exists(path)) {
+            return "Error: Path not found - " + path;
         }
-        
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
+
+        GrepResult grep = Grep(path, pattern, options);
+        if (!grep.error.empty()) {
+            return "Error: " + grep.error;
+        }
+
+        // Structured so the agent can jump straight to read_file offsets:
+        // {"hits":[{"path","line","byte_offset","snippet"}],"files_searched","truncated"}
+        std::string result = "{\"hits\":[";
+        for (size_t i = 0; i < grep.hits.size(); ++i) {
+            const GrepHit& hit = grep.hits[i];
+            if (i > 0) result += ',';
+            result += "{\"path\":";
+            AppendJsonString(&result, hit.path);
+            result += ",\"line\":" + std::to_string(hit.line);
+            result += ",\"byte_offset\":" + std::to_string(hit.byte_offset);
+            result += ",\"snippet\":";
+            AppendJsonString(&result, hit.snippet);
+            result += '}';
+        }
+        result += "],\"files_searched\":" + std::to_string(grep.files_searched);
+        result += ",\"truncated\":";
+        result += grep.truncated ? "true}" : "false}";
+        return result;
+    }
+    catch (const std::exception& e) {
+        return "Error: Exception searching " + path + " - " + std::string(e.what());
+    }
+    catch (...) {
+        return "Error: Unknown exception searching " + path;
+    }
+}
+
+std::string ToolExecutor::ExecShell(const std::string& cmd, const ShellOptions& options) {
+    try {
+        ShellResult run = RunShellCommand(cmd, options);
+        if (!run.error.empty()) {
+            return "Error: " + run.error;
+        }
+
+        std::string result = std::move(run.out);
+        auto note = [&result](const std::string& text) {
+            if (!result.empty() && result.back() != '\n') result += '\n';
+            result += text;
+        };
+        if (!run.err.empty()) note("[stderr]\n" + run.err);
+        if (run.truncated) note("... [TRUNCATED - output exceeded " + std::to_string(options.max_output) + " bytes]");
+        if (run.timed_out) {
+            note("[TIMED OUT after " + std::to_string(options.timeout_ms) + "ms - process group killed]");
+        } else if (run.term_signal != 0) {
+            note("[killed by signal " + std::to_string(run.term_signal) + "]");
+        } else if (run.exit_code != 0) {
+            note("[exit code " + std::to_string(run.exit_code) + "]");
         }
-        
         return result;
     }
     catch (const std::exception& e) {
@@ -248,10 +661,43 @@ std::string ToolExecutor::ExecShell(const std::string& cmd) {
     }
 }
 
-std::string ToolExecutor::SearchMemory(const std::string& query) {
-    // This would connect back to ECE's search functionality
-    // For now, return a placeholder response
-    return "Search functionality would connect to ECE's Tag-Walker protocol for query: " + query;
+std::string ToolExecutor::SearchMemory(const std::string& query, const MemoryIndex::SearchOptions& options) {
+    try {
+        // Answered from the atom_positions snapshot and the mirrored files;
+        // no database round-trip
+        std::shared_ptr<const MemoryIndex> index = MemoryIndex::Current();
+        if (!index) {
+            return "Error: Memory index not loaded - call loadMemoryIndex(path) first";
+        }
+
+        const std::vector<MemoryIndex::Window> windows = index->Search(query, options);
+        if (windows.empty()) {
+            return "No memories found for: " + query;
+        }
+
+        std::string result;
+        for (size_t i = 0; i < windows.size(); ++i) {
+            const MemoryIndex::Window& window = windows[i];
+            const MemoryIndex::Compound compound = index->compound(window.compound);
+            result += "[" + std::to_string(i + 1) + "] " + std::string(compound.path) +
+                      " (bytes " + std::to_string(window.start) + "-" + std::to_string(window.end) +
+                      ", " + std::to_string(window.hits) + (window.hits == 1 ? " hit: " : " hits: ");
+            for (size_t t = 0; t < window.terms.size(); ++t) {
+                if (t > 0) result += ", ";
+                result += window.terms[t];
+            }
+            result += ")\n";
+            result += window.content;
+            result += "\n\n";
+        }
+        return result;
+    }
+    catch (const std::exception& e) {
+        return "Error: Exception searching memory for '" + query + "' - " + std::string(e.what());
+    }
+    catch (...) {
+        return "Error: Unknown exception searching memory for '" + query + "'";
+    }
 }
 
 } // namespace ece
\ No newline at end of file
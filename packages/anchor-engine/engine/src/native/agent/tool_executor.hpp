@@ -1,24 +1,71 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
+#include "dir_walker.hpp"
+#include "file_writer.hpp"
+#include "grep.hpp"
+#include "memory_index.hpp"
+#include "result_cache.hpp"
+#include "shell_runner.hpp"
+#include "text_patch.hpp"
 
 namespace ece {
 
+struct JsonValue;
+
 class ToolExecutor {
 public:
     // Main Dispatcher: Parses JSON and routes to specific function
     static std::string Execute(const std::string& json_command);
 
+    // Runs a batch of tool calls and returns results in request order.
+    // Consecutive read-only calls run concurrently on the shared worker pool
+    // (at most max_workers at once, 0 = pool size); calls with side effects
+    // act as barriers and run alone.
+    static std::vector<std::string> ExecuteMany(const std::vector<std::string>& json_commands, size_t max_workers = 0);
+
+    static bool IsReadOnlyTool(std::string_view tool);
+
 private:
-    // The "Hands"
-    static std::string ReadFile(const std::string& path);
-    static std::string WriteFile(const std::string& path, const std::string& content);
-    static std::string ListDir(const std::string& path);
-    static std::string SearchMemory(const std::string& query); // Connects back to ECE
+    static std::string Dispatch(const JsonValue& root);
+
+    // Window of a file for read_file; the default reads the whole file up to
+    // max_bytes.
+    struct ReadRange {
+        uint64_t offset = 0;
+        uint64_t length = UINT64_MAX;
+        uint64_t start_line = 0; // 1-based; 0 = byte mode
+        uint64_t end_line = 0;   // inclusive; 0 = to end of file
+        size_t max_bytes = 1 << 20;
+    };
+
+    // Dispatch targets: pull typed params out of the parsed request
+    static std::string RunReadFile(const JsonValue& params);
+    static std::string RunWriteFile(const JsonValue& params);
+    static std::string RunWriteFiles(const JsonValue& params);
+    static std::string RunApplyEdit(const JsonValue& params);
+    static std::string RunListDir(const JsonValue& params);
+    static std::string RunGlob(const JsonValue& params);
+    static std::string RunGrep(const JsonValue& params);
+    static std::string RunExecShell(const JsonValue& params);
+    static std::string RunSearchMemory(const JsonValue& params);
+
+    // The "Hands"; read_file and single-level list_dir results are served
+    // from ResultCache::Shared() while the paths they read are unchanged
+    static std::string ReadFile(const std::string& path, const ReadRange& range);
+    static std::string ReadWindow(const std::string& path, const ReadRange& range);
+    static std::string WriteFile(const std::string& path, const std::string& content, bool append, bool durable);
+    static std::string WriteFiles(const std::vector<FileWrite>& writes, bool durable);
+    static std::string ApplyEdit(const std::string& path, const std::vector<TextEdit>& edits, const std::string& diff, bool durable);
+    static std::string ListDir(const std::string& path, const WalkOptions& options);
+    static std::string GrepFiles(const std::string& path, const std::string& pattern, const GrepOptions& options);
+    static std::string SearchMemory(const std::string& query, const MemoryIndex::SearchOptions& options);
     
     // Helper
-    static std::string ExecShell(const std::string& cmd);
+    static std::string ExecShell(const std::string& cmd, const ShellOptions& options);
 };
 
 } // namespace ece
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "charset.hpp"
+#include <array>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define ECE_CHARSET_SIMD 1
+#endif
+
+namespace ece {
+
+namespace {
+
+// Code points for 0x80-0x9F in Windows-1252; 0xA0-0xFF match Latin-1.
+// Holes (0x81, 0x8D, 0x8F, 0x90, 0x9D) map to the C1 control, as in WHATWG.
+constexpr uint16_t kWindows1252C1[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+uint16_t Windows1252CodePoint(uint8_t byte) {
+    return byte < 0xA0 ? kWindows1252C1[byte - 0x80] : byte;
+}
+
+// ISO-8859-15 is Latin-1 with eight letters and the euro sign swapped in.
+uint16_t Iso8859_15CodePoint(uint8_t byte) {
+    switch (byte) {
+        case 0xA4: return 0x20AC;
+        case 0xA6: return 0x0160;
+        case 0xA8: return 0x0161;
+        case 0xB4: return 0x017D;
+        case 0xB8: return 0x017E;
+        case 0xBC: return 0x0152;
+        case 0xBD: return 0x0153;
+        case 0xBE: return 0x0178;
+        default: return byte;
+    }
+}
+
+char AsciiLowerChar(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+bool LabelEquals(std::string_view label, std::string_view name) {
+    if (label.size() != name.size()) return false;
+    for (size_t i = 0; i < label.size(); ++i) {
+        if (AsciiLowerChar(label[i]) != name[i]) return false;
+    }
+    return true;
+}
+
+void AppendCodePoint(uint32_t cp, std::string* out) {
+    if (cp < 0x80) {
+        out->push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+constexpr uint32_t kReplacement = 0xFFFD;
+
+// Number of leading ASCII bytes in [data, data + n).
+size_t AsciiPrefixLength(const char* data, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+#elif defined(ECE_CHARSET_SIMD) && !defined(_MSC_VER)
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(v));
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        if (word & 0x8080808080808080ULL) break;
+    }
+    while (i < n && static_cast<unsigned char>(data[i]) < 0x80) ++i;
+    return i;
+}
+
+template <uint16_t (*CodePoint)(uint8_t)>
+const std::array<char[4], 128>& BuildTable() {
+    // [0..2] = UTF-8 bytes, [3] = length
+    static const std::array<char[4], 128> table = [] {
+        std::array<char[4], 128> t{};
+        for (int b = 0; b < 128; ++b) {
+            std::string seq;
+            AppendCodePoint(CodePoint(static_cast<uint8_t>(0x80 + b)), &seq);
+            std::memcpy(t[b], seq.data(), seq.size());
+            t[b][3] = static_cast<char>(seq.size());
+        }
+        return t;
+    }();
+    return table;
+}
+
+} // namespace
+
+bool CharsetFromLabel(std::string_view label, Charset* charset) {
+    while (!label.empty() && (label.front() == ' ' || label.front() == '\t' || label.front() == '\n' ||
+                              label.front() == '\r' || label.front() == '\f')) {
+        label.remove_prefix(1);
+    }
+    while (!label.empty() && (label.back() == ' ' || label.back() == '\t' || label.back() == '\n' ||
+                              label.back() == '\r' || label.back() == '\f')) {
+        label.remove_suffix(1);
+    }
+
+    static constexpr struct {
+        const char* label;
+        Charset charset;
+    } kLabels[] = {
+        {"utf-8", Charset::Utf8},
+        {"utf8", Charset::Utf8},
+        {"unicode-1-1-utf-8", Charset::Utf8},
+        {"utf-16", Charset::Utf16LE},
+        {"utf-16le", Charset::Utf16LE},
+        {"unicode", Charset::Utf16LE},
+        {"utf-16be", Charset::Utf16BE},
+        {"windows-1252", Charset::Windows1252},
+        {"cp1252", Charset::Windows1252},
+        {"x-cp1252", Charset::Windows1252},
+        {"iso-8859-1", Charset::Windows1252},
+        {"iso8859-1", Charset::Windows1252},
+        {"iso_8859-1", Charset::Windows1252},
+        {"latin1", Charset::Windows1252},
+        {"l1", Charset::Windows1252},
+        {"cp819", Charset::Windows1252},
+        {"ibm819", Charset::Windows1252},
+        {"ascii", Charset::Windows1252},
+        {"us-ascii", Charset::Windows1252},
+        {"iso-8859-15", Charset::Iso8859_15},
+        {"iso8859-15", Charset::Iso8859_15},
+        {"iso_8859-15", Charset::Iso8859_15},
+        {"latin-9", Charset::Iso8859_15},
+        {"l9", Charset::Iso8859_15},
+    };
+    for (const auto& entry : kLabels) {
+        if (LabelEquals(label, entry.label)) {
+            *charset = entry.charset;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* CharsetName(Charset charset) {
+    switch (charset) {
+        case Charset::Utf8: return "utf-8";
+        case Charset::Utf16LE: return "utf-16le";
+        case Charset::Utf16BE: return "utf-16be";
+        case Charset::Windows1252: return "windows-1252";
+        case Charset::Iso8859_15: return "iso-8859-15";
+    }
+    return "utf-8";
+}
+
+size_t DetectBom(std::string_view bytes, Charset* charset) {
+    if (bytes.size() >= 3 && bytes.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        *charset = Charset::Utf8;
+        return 3;
+    }
+    if (bytes.size() >= 2 && bytes.compare(0, 2, "\xFF\xFE") == 0) {
+        *charset = Charset::Utf16LE;
+        return 2;
+    }
+    if (bytes.size() >= 2 && bytes.compare(0, 2, "\xFE\xFF") == 0) {
+        *charset = Charset::Utf16BE;
+        return 2;
+    }
+    return 0;
+}
+
+bool IsValidUtf8(std::string_view bytes, bool allow_truncated) {
+    const auto* p = reinterpret_cast<const unsigned char*>(bytes.data());
+    const size_t n = bytes.size();
+    size_t i = 0;
+    while (i < n) {
+        i += AsciiPrefixLength(bytes.data() + i, n - i);
+        if (i >= n) break;
+
+        const unsigned char c = p[i];
+        size_t len;
+        uint32_t min;
+        if (c >= 0xC2 && c <= 0xDF) { len = 2; min = 0x80; }
+        else if (c >= 0xE0 && c <= 0xEF) { len = 3; min = 0x800; }
+        else if (c >= 0xF0 && c <= 0xF4) { len = 4; min = 0x10000; }
+        else return false;
+
+        if (i + len > n) {
+            if (!allow_truncated) return false;
+            for (size_t k = i + 1; k < n; ++k) {
+                if ((p[k] & 0xC0) != 0x80) return false;
+            }
+            return true;
+        }
+
+        uint32_t cp = c & (0x7F >> len);
+        for (size_t k = 1; k < len; ++k) {
+            if ((p[i + k] & 0xC0) != 0x80) return false;
+            cp = (cp << 6) | (p[i + k] & 0x3F);
+        }
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+        i += len;
+    }
+    return true;
+}
+
+Utf8Transcoder::Utf8Transcoder(Charset charset) : charset_(charset) {
+    if (charset == Charset::Windows1252) {
+        high_table_ = BuildTable<Windows1252CodePoint>().data();
+    } else if (charset == Charset::Iso8859_15) {
+        high_table_ = BuildTable<Iso8859_15CodePoint>().data();
+    }
+}
+
+void Utf8Transcoder::Append(std::string_view bytes, std::string* out) {
+    switch (charset_) {
+        case Charset::Utf8:
+            out->append(bytes);
+            break;
+        case Charset::Utf16LE:
+        case Charset::Utf16BE:
+            AppendUtf16(bytes, out);
+            break;
+        default:
+            AppendSingleByte(bytes, out);
+            break;
+    }
+}
+
+void Utf8Transcoder::Finish(std::string* out) {
+    if (carry_byte_ >= 0 || high_surrogate_ != 0) AppendCodePoint(kReplacement, out);
+    carry_byte_ = -1;
+    high_surrogate_ = 0;
+}
+
+void Utf8Transcoder::AppendSingleByte(std::string_view bytes, std::string* out) {
+    out->reserve(out->size() + bytes.size() + bytes.size() / 4);
+    const char* data = bytes.data();
+    const size_t n = bytes.size();
+    size_t i = 0;
+    while (i < n) {
+        const size_t run = AsciiPrefixLength(data + i, n - i);
+        out->append(data + i, run);
+        i += run;
+        while (i < n && static_cast<unsigned char>(data[i]) >= 0x80) {
+            const char* seq = high_table_[static_cast<unsigned char>(data[i]) - 0x80];
+            out->append(seq, static_cast<size_t>(seq[3]));
+            ++i;
+        }
+    }
+}
+
+void Utf8Transcoder::AppendUnit(uint16_t unit, std::string* out) {
+    if (high_surrogate_ != 0) {
+        if (unit >= 0xDC00 && unit <= 0xDFFF) {
+            AppendCodePoint(0x10000 + ((high_surrogate_ - 0xD800u) << 10) + (unit - 0xDC00u), out);
+            high_surrogate_ = 0;
+            return;
+        }
+        AppendCodePoint(kReplacement, out);
+        high_surrogate_ = 0;
+    }
+    if (unit >= 0xD800 && unit <= 0xDBFF) {
+        high_surrogate_ = unit;
+    } else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+        AppendCodePoint(kReplacement, out);
+    } else {
+        AppendCodePoint(unit, out);
+    }
+}
+
+void Utf8Transcoder::AppendUtf16(std::string_view bytes, std::string* out) {
+    const bool le = charset_ == Charset::Utf16LE;
+    const auto* p = reinterpret_cast<const unsigned char*>(bytes.data());
+    const size_t n = bytes.size();
+    size_t i = 0;
+    out->reserve(out->size() + n / 2);
+
+    if (carry_byte_ >= 0 && n > 0) {
+        const uint16_t unit = le ? static_cast<uint16_t>(carry_byte_ | (p[0] << 8))
+                                 : static_cast<uint16_t>((carry_byte_ << 8) | p[0]);
+        carry_byte_ = -1;
+        AppendUnit(unit, out);
+        i = 1;
+    }
+
+    while (i + 1 < n) {
+#if defined(ECE_CHARSET_SIMD) && !defined(_MSC_VER)
+        // Eight ASCII code units at a time: narrow them with a saturating pack.
+        if (high_surrogate_ == 0) {
+            const __m128i ascii_mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+            while (i + 16 <= n) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                if (!le) v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, ascii_mask), _mm_setzero_si128())) != 0xFFFF) break;
+                char narrow[16];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(narrow), _mm_packus_epi16(v, v));
+                out->append(narrow, 8);
+                i += 16;
+            }
+            if (i + 1 >= n) break;
+        }
+#endif
+        const uint16_t unit = le ? static_cast<uint16_t>(p[i] | (p[i + 1] << 8))
+                                 : static_cast<uint16_t>((p[i] << 8) | p[i + 1]);
+        AppendUnit(unit, out);
+        i += 2;
+    }
+
+    if (i < n) carry_byte_ = p[i];
+}
+
+} // namespace ece
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ece {
+
+// Encodings HtmlIngestor can turn into UTF-8. Single-byte charsets are table
+// driven, so adding one means adding its 0x80-0xFF code point table.
+enum class Charset { Utf8, Utf16LE, Utf16BE, Windows1252, Iso8859_15 };
+
+// Resolves a WHATWG encoding label ("latin1", "cp1252", " UTF-8 ", ...).
+// Like browsers, the Latin-1 and ASCII labels map to Windows-1252.
+bool CharsetFromLabel(std::string_view label, Charset* charset);
+const char* CharsetName(Charset charset);
+
+// Length of a byte order mark at the start of `bytes` (0 if none).
+size_t DetectBom(std::string_view bytes, Charset* charset);
+
+// Strict UTF-8 validation. With `allow_truncated`, a sequence cut off by the
+// end of `bytes` is accepted so a leading chunk of a stream can be checked.
+bool IsValidUtf8(std::string_view bytes, bool allow_truncated = false);
+
+// Converts a byte stream to UTF-8. Append() accepts arbitrary slices: a UTF-16
+// code unit or surrogate pair split across calls is carried over, and
+// anything malformed becomes U+FFFD. UTF-8 input is passed through untouched.
+class Utf8Transcoder {
+public:
+    explicit Utf8Transcoder(Charset charset);
+
+    Charset charset() const { return charset_; }
+
+    void Append(std::string_view bytes, std::string* out);
+    void Finish(std::string* out); // Flushes dangling state and resets
+
+private:
+    void AppendSingleByte(std::string_view bytes, std::string* out);
+    void AppendUtf16(std::string_view bytes, std::string* out);
+    void AppendUnit(uint16_t unit, std::string* out);
+
+    Charset charset_;
+    const char (*high_table_)[4] = nullptr; // UTF-8 for 0x80-0xFF, length in [3]
+    int carry_byte_ = -1;                   // first half of a split UTF-16 unit
+    uint16_t high_surrogate_ = 0;           // pending lead surrogate
+};
+
+} // namespace ece
@@ -0,0 +1,923 @@
+#include "fingerprint.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define ECE_FINGERPRINT_SIMD 1
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ece {
+
+namespace {
+
+constexpr uint64_t kMul1 = 0x9E3779B97F4A7C15ULL;
+constexpr uint64_t kMul2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint32_t kMaxShingle = 16;
+constexpr size_t kBatch = 256; // features hashed before each accumulate
+
+inline uint64_t Rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// murmur3 fmix64: every input bit affects every output bit
+inline uint64_t Avalanche(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline int CountTrailingZeros(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+inline bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline char AsciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+}
+
+// Lower-cases the ASCII letters of eight packed bytes at once; bytes >= 0x80
+// are left alone
+inline uint64_t FoldAscii(uint64_t word) {
+    constexpr uint64_t kOnes = 0x0101010101010101ULL;
+    const uint64_t low7 = word & (0x7F * kOnes);
+    const uint64_t at_least_a = low7 + (0x80 - 'A') * kOnes;
+    const uint64_t above_z = low7 + (0x80 - 'Z' - 1) * kOnes;
+    const uint64_t upper = at_least_a & ~above_z & ~word & (0x80 * kOnes);
+    return word | (upper >> 2);
+}
+
+// HashBytes, optionally hashing the text as if it were ASCII-lower-cased,
+// which spares SimHash a folded copy of its input. With `overread`, the
+// caller guarantees 8 readable bytes past the end, so the tail is one masked
+// load instead of a variable-length copy.
+template <bool kFold>
+uint64_t HashWords(const char* data, size_t n, uint64_t seed, bool overread) {
+    uint64_t h = seed ^ (n * kMul1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        if (kFold) word = FoldAscii(word);
+        h = Rotl(h ^ (word * kMul2), 31) * kMul1;
+    }
+    if (i < n) {
+        uint64_t word = 0;
+        if (overread) {
+            std::memcpy(&word, data + i, 8);
+            word &= ~uint64_t{0} >> (64 - 8 * (n - i));
+        } else {
+            std::memcpy(&word, data + i, n - i);
+        }
+        if (kFold) word = FoldAscii(word);
+        h = Rotl(h ^ (word * kMul2), 31) * kMul1;
+    }
+    return Avalanche(h);
+}
+
+inline uint64_t TokenHash(const char* token, size_t length, bool lowercase, bool overread) {
+    return lowercase ? HashWords<true>(token, length, 0, overread) : HashWords<false>(token, length, 0, overread);
+}
+
+// Bit j set when data[j] is ASCII whitespace (' ', \t, \n, \v, \f, \r), for
+// the first min(n, 64) bytes; bits past `n` read as whitespace.
+uint64_t SpaceMask(const char* data, size_t n) {
+    uint64_t mask = 0;
+    size_t j = 0;
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i span = _mm256_set1_epi8('\r' - '\t');
+    for (; j + 32 <= n && j < 64; j += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + j));
+        const __m256i control = _mm256_sub_epi8(v, tab); // \t..\r -> 0..4
+        const __m256i is_control = _mm256_cmpeq_epi8(_mm256_min_epu8(control, span), control);
+        const __m256i is_space = _mm256_or_si256(_mm256_cmpeq_epi8(v, space), is_control);
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(is_space))) << j;
+    }
+#elif defined(ECE_FINGERPRINT_SIMD) && !defined(_MSC_VER)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i span = _mm_set1_epi8('\r' - '\t');
+    for (; j + 16 <= n && j < 64; j += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j));
+        const __m128i control = _mm_sub_epi8(v, tab);
+        const __m128i is_control = _mm_cmpeq_epi8(_mm_min_epu8(control, span), control);
+        const __m128i is_space = _mm_or_si128(_mm_cmpeq_epi8(v, space), is_control);
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(is_space))) << j;
+    }
+#endif
+    for (; j < 64; ++j) {
+        if (j >= n || IsSpace(data[j])) mask |= uint64_t{1} << j;
+    }
+    return mask;
+}
+
+constexpr size_t kNoToken = static_cast<size_t>(-1);
+
+// Calls on_token(start, end) for every whitespace-terminated token of `text`
+// and returns where the unterminated last token starts (kNoToken when the
+// text ends in whitespace). Tokens are runs of non-space bits in 64-byte
+// whitespace masks; each boundary is found with a bit scan instead of a
+// per-byte branch.
+template <typename OnToken>
+size_t ScanTokens(std::string_view text, OnToken&& on_token) {
+    size_t token_start = kNoToken;
+    uint64_t previous_space = 1; // before the text counts as whitespace
+    for (size_t base = 0; base < text.size(); base += 64) {
+        const uint64_t space = SpaceMask(text.data() + base, text.size() - base);
+        uint64_t edges = space ^ ((space << 1) | previous_space);
+        previous_space = space >> 63;
+        while (edges != 0) {
+            const int bit = CountTrailingZeros(edges);
+            edges &= edges - 1;
+            if (base + bit >= text.size()) break; // the padding past the end
+            if ((space >> bit) & 1) {
+                on_token(token_start, base + bit);
+                token_start = kNoToken;
+            } else {
+                token_start = base + bit;
+            }
+        }
+    }
+    return token_start;
+}
+
+// set[i] += number of features with bit i set
+void CountSetBits(const uint64_t* features, size_t count, int32_t* set) {
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    // Broadcast each 32-bit half and shift lane j right by j: eight bits per
+    // vector, sixty-four counters in eight registers for the whole batch
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i shift[4] = {
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+        _mm256_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15),
+        _mm256_setr_epi32(16, 17, 18, 19, 20, 21, 22, 23),
+        _mm256_setr_epi32(24, 25, 26, 27, 28, 29, 30, 31),
+    };
+    __m256i acc[8];
+    for (int v = 0; v < 8; ++v) acc[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(set + 8 * v));
+    for (size_t f = 0; f < count; ++f) {
+        const __m256i lo = _mm256_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(features[f])));
+        const __m256i hi = _mm256_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(features[f] >> 32)));
+        for (int v = 0; v < 4; ++v) {
+            acc[v] = _mm256_add_epi32(acc[v], _mm256_and_si256(_mm256_srlv_epi32(lo, shift[v]), one));
+            acc[v + 4] = _mm256_add_epi32(acc[v + 4], _mm256_and_si256(_mm256_srlv_epi32(hi, shift[v]), one));
+        }
+    }
+    for (int v = 0; v < 8; ++v) _mm256_storeu_si256(reinterpret_cast<__m256i*>(set + 8 * v), acc[v]);
+#elif defined(ECE_FINGERPRINT_SIMD) && !defined(_MSC_VER)
+    // No variable shifts: test each nibble against {1, 2, 4, 8}; a match is
+    // -1 in its lane, so subtracting counts it
+    const __m128i select = _mm_setr_epi32(1, 2, 4, 8);
+    __m128i acc[16];
+    for (int g = 0; g < 16; ++g) acc[g] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set + 4 * g));
+    for (size_t f = 0; f < count; ++f) {
+        const uint64_t h = features[f];
+        for (int g = 0; g < 16; ++g) {
+            const __m128i nibble = _mm_set1_epi32(static_cast<int32_t>((h >> (4 * g)) & 0xF));
+            acc[g] = _mm_sub_epi32(acc[g], _mm_cmpeq_epi32(_mm_and_si128(nibble, select), select));
+        }
+    }
+    for (int g = 0; g < 16; ++g) _mm_storeu_si128(reinterpret_cast<__m128i*>(set + 4 * g), acc[g]);
+#else
+    for (size_t f = 0; f < count; ++f) {
+        for (int i = 0; i < 64; ++i) set[i] += static_cast<int32_t>((features[f] >> i) & 1);
+    }
+#endif
+}
+
+// Order-sensitive combination of the last `k` token hashes in the ring
+uint64_t ShingleHash(const uint64_t* ring, size_t tokens, size_t k) {
+    uint64_t h = k * kMul2;
+    for (size_t j = 0; j < k; ++j) {
+        h = Rotl((h ^ ring[(tokens - k + j) % kMaxShingle]) * kMul1, 29);
+    }
+    return Avalanche(h);
+}
+
+// out[i] = popcount(a[i] ^ b[kPairwise ? i : 0])
+template <bool kPairwise>
+void XorDistances(const uint64_t* a, const uint64_t* b, size_t count, uint8_t* out) {
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    // Nibble popcounts by table shuffle, summed per 64-bit lane with vpsadbw;
+    // four vectors' lane sums are merged into one 16-byte store
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i broadcast = kPairwise ? zero : _mm256_set1_epi64x(static_cast<long long>(b[0]));
+    const __m256i gather = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    // lane j holds hashes j, j+4, j+8, j+12 in its low four bytes
+    const __m128i transpose = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    auto lane_counts = [&](size_t offset) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + offset));
+        const __m256i y = kPairwise ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + offset)) : broadcast;
+        const __m256i diff = _mm256_xor_si256(x, y);
+        const __m256i counts = _mm256_add_epi8(
+            _mm256_shuffle_epi8(table, _mm256_and_si256(diff, low_nibble)),
+            _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(diff, 4), low_nibble)));
+        return _mm256_sad_epu8(counts, zero);
+    };
+    for (; i + 16 <= count; i += 16) {
+        __m256i merged = lane_counts(i);
+        merged = _mm256_or_si256(merged, _mm256_slli_epi64(lane_counts(i + 4), 8));
+        merged = _mm256_or_si256(merged, _mm256_slli_epi64(lane_counts(i + 8), 16));
+        merged = _mm256_or_si256(merged, _mm256_slli_epi64(lane_counts(i + 12), 24));
+        const __m128i packed = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(merged, gather));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(packed, transpose));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = static_cast<uint8_t>(HammingDistance(a[i], b[kPairwise ? i : 0]));
+    }
+}
+
+// --- N-API ---
+
+// fingerprint(text: string | Buffer, { shingle?, lowercase? }?) -> bigint
+// Buffers are hashed in place.
+Napi::Value Fingerprint(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || (!info[0].IsString() && !info[0].IsBuffer())) {
+        Napi::TypeError::New(env, "String or Buffer expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    SimHashOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        options = ReadSimHashOptions(info[1].As<Napi::Object>());
+    }
+
+    uint64_t hash = 0;
+    if (info[0].IsBuffer()) {
+        Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+        hash = SimHash(std::string_view(buffer.Data(), buffer.Length()), options);
+    } else {
+        hash = SimHash(info[0].As<Napi::String>().Utf8Value(), options);
+    }
+    return Napi::BigInt::New(env, hash);
+}
+
+// distance(a, b) -> number of differing bits (0-64)
+Napi::Value Distance(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    uint64_t a = 0, b = 0;
+    if (info.Length() < 2 || !ReadHash(info[0], &a) || !ReadHash(info[1], &b)) {
+        Napi::TypeError::New(env, "Expected two 64-bit hashes (bigint or hex string)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Number::New(env, HammingDistance(a, b));
+}
+
+// Query of a batch call: a single hash, or a BigUint64Array of one hash (the
+// same for every candidate) or of one hash per candidate
+bool ReadQuery(const Napi::Value& value, size_t candidates, uint64_t* single, const uint64_t** data,
+               bool* pairwise) {
+    size_t count = 0;
+    if (ReadHashArray(value, data, &count)) {
+        if (count == 1) {
+            *single = (*data)[0];
+            *pairwise = false;
+            return true;
+        }
+        *pairwise = true;
+        return count == candidates;
+    }
+    *pairwise = false;
+    return ReadHash(value, single);
+}
+
+// distanceBatch(query, candidates: BigUint64Array) -> Uint8Array
+// out[i] is the distance from the query (or query[i]) to candidates[i].
+Napi::Value DistanceBatch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint64_t* candidates = nullptr;
+    size_t count = 0;
+    if (info.Length() < 2 || !ReadHashArray(info[1], &candidates, &count)) {
+        Napi::TypeError::New(env, "BigUint64Array of candidate hashes expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    uint64_t single = 0;
+    const uint64_t* queries = nullptr;
+    bool pairwise = false;
+    if (!ReadQuery(info[0], count, &single, &queries, &pairwise)) {
+        Napi::TypeError::New(env, "Query must be a 64-bit hash or a BigUint64Array of 1 or candidates.length hashes")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Uint8Array distances = Napi::Uint8Array::New(env, count);
+    if (pairwise) {
+        HammingDistancesPairwise(queries, candidates, count, distances.Data());
+    } else {
+        HammingDistances(single, candidates, count, distances.Data());
+    }
+    return distances;
+}
+
+// nearestK(query, candidates: BigUint64Array, k, maxDistance = 64)
+//   -> { indices: Uint32Array, distances: Uint8Array }, nearest first
+Napi::Value NearestKBinding(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint64_t* candidates = nullptr;
+    size_t count = 0;
+    uint64_t query = 0;
+    if (info.Length() < 3 || !ReadHash(info[0], &query) || !ReadHashArray(info[1], &candidates, &count) ||
+        !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (hash, BigUint64Array, k[, maxDistance])").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (count > UINT32_MAX) {
+        Napi::RangeError::New(env, "Too many candidates").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    const int64_t k = info[2].As<Napi::Number>().Int64Value();
+    int max_distance = 64;
+    if (info.Length() > 3 && info[3].IsNumber()) {
+        max_distance = static_cast<int>(std::clamp<int64_t>(info[3].As<Napi::Number>().Int64Value(), -1, 64));
+    }
+
+    const auto nearest = NearestK(query, candidates, count, static_cast<size_t>(std::max<int64_t>(k, 0)), max_distance);
+    Napi::Uint32Array indices = Napi::Uint32Array::New(env, nearest.size());
+    Napi::Uint8Array distances = Napi::Uint8Array::New(env, nearest.size());
+    for (size_t i = 0; i < nearest.size(); ++i) {
+        indices[i] = nearest[i].first;
+        distances[i] = nearest[i].second;
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("indices", indices);
+    result.Set("distances", distances);
+    return result;
+}
+
+} // namespace
+
+SimHashOptions ReadSimHashOptions(const Napi::Object& opts) {
+    SimHashOptions options;
+    if (opts.Has("shingle") && opts.Get("shingle").IsNumber()) {
+        const int64_t shingle = opts.Get("shingle").As<Napi::Number>().Int64Value();
+        options.shingle = static_cast<uint32_t>(std::clamp<int64_t>(shingle, 1, kMaxShingle));
+    }
+    if (opts.Has("lowercase")) {
+        options.lowercase = opts.Get("lowercase").ToBoolean().Value();
+    }
+    return options;
+}
+
+bool ReadHash(const Napi::Value& value, uint64_t* out) {
+    if (value.IsBigInt()) {
+        bool lossless = false;
+        *out = value.As<Napi::BigInt>().Uint64Value(&lossless);
+        return true;
+    }
+    if (value.IsString()) {
+        const std::string text = value.As<Napi::String>().Utf8Value();
+        size_t i = text.compare(0, 2, "0x") == 0 || text.compare(0, 2, "0X") == 0 ? 2 : 0;
+        if (text.size() == i || text.size() - i > 16) return false; // "" and "0x" are not hashes
+        uint64_t hash = 0;
+        for (; i < text.size(); ++i) {
+            const char c = AsciiLower(text[i]);
+            const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digit < 0) return false;
+            hash = (hash << 4) | static_cast<uint64_t>(digit);
+        }
+        *out = hash;
+        return true;
+    }
+    if (value.IsNumber()) {
+        // Casting 2^64 and up (or NaN) to uint64_t is undefined
+        const double number = value.As<Napi::Number>().DoubleValue();
+        if (!(number >= 0 && number < 18446744073709551616.0)) return false;
+        *out = static_cast<uint64_t>(number);
+        return true;
+    }
+    return false;
+}
+
+bool ReadHashArray(const Napi::Value& value, const uint64_t** data, size_t* count) {
+    if (!value.IsTypedArray()) return false;
+    const napi_typedarray_type type = value.As<Napi::TypedArray>().TypedArrayType();
+    if (type != napi_biguint64_array && type != napi_bigint64_array) return false;
+    Napi::TypedArrayOf<uint64_t> array = value.As<Napi::TypedArrayOf<uint64_t>>();
+    *data = array.Data();
+    *count = array.ElementLength();
+    return true;
+}
+
+uint64_t HashBytes(std::string_view bytes, uint64_t seed) {
+    return HashWords<false>(bytes.data(), bytes.size(), seed, false);
+}
+
+void SimHashAccumulator::Add(const uint64_t* features, size_t count) {
+    Accumulate(features, count, 1);
+}
+
+void SimHashAccumulator::Remove(const uint64_t* features, size_t count) {
+    Accumulate(features, count, -1);
+}
+
+void SimHashAccumulator::Accumulate(const uint64_t* features, size_t count, int32_t sign) {
+    while (count > 0) {
+        // ±1 per feature is 2 * (features with the bit set) - features
+        const size_t chunk = std::min<size_t>(count, 1u << 20);
+        alignas(32) int32_t set[64] = {};
+        CountSetBits(features, chunk, set);
+        for (int i = 0; i < 64; ++i) {
+            counters_[i] += sign * (2 * set[i] - static_cast<int32_t>(chunk));
+        }
+        features += chunk;
+        count -= chunk;
+    }
+}
+
+void SimHashAccumulator::Reset() {
+    std::fill(std::begin(counters_), std::end(counters_), 0);
+}
+
+void SimHashAccumulator::Restore(const int32_t* counters) {
+    std::copy(counters, counters + 64, counters_);
+}
+
+uint64_t SimHashAccumulator::Digest() const {
+    uint64_t digest = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (counters_[i] > 0) digest |= uint64_t{1} << i;
+    }
+    return digest;
+}
+
+uint64_t SimHash(std::string_view text, const SimHashOptions& options) {
+    const size_t k = std::clamp<uint32_t>(options.shingle, 1, kMaxShingle);
+
+    SimHashAccumulator accumulator;
+    uint64_t ring[kMaxShingle];
+    uint64_t batch[kBatch];
+    size_t pending = 0;
+    size_t tokens = 0;
+
+    auto add_token = [&](size_t start, size_t end) {
+        const char* token = text.data() + start;
+        const size_t length = end - start;
+        const bool overread = end + 8 <= text.size();
+        ring[tokens % kMaxShingle] = TokenHash(token, length, options.lowercase, overread);
+        ++tokens;
+        if (tokens >= k) {
+            batch[pending++] = ShingleHash(ring, tokens, k);
+            if (pending == kBatch) {
+                accumulator.Add(batch, pending);
+                pending = 0;
+            }
+        }
+    };
+
+    const size_t tail = ScanTokens(text, add_token);
+    if (tail != kNoToken) add_token(tail, text.size());
+
+    if (tokens == 0) return 0;
+    if (tokens < k) batch[pending++] = ShingleHash(ring, tokens, tokens);
+    accumulator.Add(batch, pending);
+    return accumulator.Digest();
+}
+
+void ShingleFeatures(std::string_view text, const SimHashOptions& options, std::vector<uint64_t>* features) {
+    const size_t k = std::clamp<uint32_t>(options.shingle, 1, kMaxShingle);
+    features->clear();
+    uint64_t ring[kMaxShingle];
+    size_t tokens = 0;
+
+    auto add_token = [&](size_t start, size_t end) {
+        ring[tokens % kMaxShingle] = TokenHash(text.data() + start, end - start, options.lowercase,
+                                               end + 8 <= text.size());
+        ++tokens;
+        if (tokens >= k) features->push_back(ShingleHash(ring, tokens, k));
+    };
+    const size_t tail = ScanTokens(text, add_token);
+    if (tail != kNoToken) add_token(tail, text.size());
+    if (tokens > 0 && tokens < k) features->push_back(ShingleHash(ring, tokens, tokens));
+}
+
+namespace {
+
+constexpr char kStreamMagic[8] = {'E', 'C', 'E', 'S', 'I', 'M', 'S', '1'};
+
+template <typename T>
+void Put(std::string* out, const T* values, size_t count = 1) {
+    out->append(reinterpret_cast<const char*>(values), sizeof(T) * count);
+}
+
+// Bounds-checked reads over a serialized state
+class StateReader {
+public:
+    explicit StateReader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    bool Get(T* values, size_t count = 1) {
+        if (count > (data_.size() - offset_) / sizeof(T)) return false;
+        if (count == 0) return true;
+        std::memcpy(values, data_.data() + offset_, sizeof(T) * count);
+        offset_ += sizeof(T) * count;
+        return true;
+    }
+    bool Bytes(std::string* out, uint64_t length) {
+        if (length > data_.size() - offset_) return false;
+        out->assign(data_.data() + offset_, static_cast<size_t>(length));
+        offset_ += static_cast<size_t>(length);
+        return true;
+    }
+    bool AtEnd() const { return offset_ == data_.size(); }
+
+private:
+    std::string_view data_;
+    size_t offset_ = 0;
+};
+
+} // namespace
+
+SimHashStream::SimHashStream(const SimHashOptions& options, uint32_t window, uint32_t stride)
+    : options_(options), window_(window), stride_(window == 0 ? 0 : stride == 0 ? window : stride) {
+    options_.shingle = std::clamp<uint32_t>(options_.shingle, 1, kMaxShingle);
+    batch_.reserve(kBatch);
+}
+
+void SimHashStream::Reset() {
+    *this = SimHashStream(options_, window_, stride_);
+}
+
+void SimHashStream::Append(std::string_view text, std::vector<Window>* windows) {
+    size_t offset = 0;
+    if (!carry_.empty()) {
+        // The carried token runs on to the first whitespace
+        while (offset < text.size() && !IsSpace(text[offset])) ++offset;
+        const uint64_t start = bytes_ - carry_.size();
+        carry_.append(text.data(), offset);
+        if (offset == text.size()) {
+            bytes_ += text.size();
+            return;
+        }
+        AddToken(TokenHash(carry_.data(), carry_.size(), options_.lowercase, false), start, bytes_ + offset, windows);
+        carry_.clear();
+    }
+
+    const std::string_view rest = text.substr(offset);
+    const uint64_t base = bytes_ + offset;
+    const size_t tail = ScanTokens(rest, [&](size_t start, size_t end) {
+        const uint64_t hash = TokenHash(rest.data() + start, end - start, options_.lowercase, end + 8 <= rest.size());
+        AddToken(hash, base + start, base + end, windows);
+    });
+    if (tail != kNoToken) carry_.assign(rest.data() + tail, rest.size() - tail);
+    bytes_ += text.size();
+    Flush();
+}
+
+void SimHashStream::AddToken(uint64_t hash, uint64_t start, uint64_t end, std::vector<Window>* windows) {
+    const size_t k = options_.shingle;
+    const size_t slot = tokens_ % kMaxShingle;
+    token_hashes_[slot] = hash;
+    token_starts_[slot] = start;
+    token_ends_[slot] = end;
+    ++tokens_;
+    if (tokens_ < k) return;
+
+    const uint64_t feature = ShingleHash(token_hashes_, tokens_, k);
+    batch_.push_back(feature);
+    if (batch_.size() == kBatch) Flush();
+
+    const uint64_t index = features_++;
+    if (window_ == 0 || index < next_window_) return;
+    if (retained_hashes_.empty()) retained_first_ = index;
+    retained_hashes_.push_back(feature);
+    retained_starts_.push_back(token_starts_[(tokens_ - k) % kMaxShingle]);
+    retained_ends_.push_back(end);
+    if (features_ >= window_ && (features_ - window_) % stride_ == 0) EmitWindow(windows);
+}
+
+void SimHashStream::EmitWindow(std::vector<Window>* windows) {
+    const uint64_t from = features_ - window_;
+    const uint64_t to = features_;
+    // Feature i is retained_hashes_[i - retained_first_]
+    const uint64_t* hashes = retained_hashes_.data();
+    if (window_to_ <= from) {
+        window_sum_.Reset();
+        window_sum_.Add(hashes + (from - retained_first_), window_);
+    } else {
+        window_sum_.Remove(hashes + (window_from_ - retained_first_), from - window_from_);
+        window_sum_.Add(hashes + (window_to_ - retained_first_), to - window_to_);
+    }
+    window_from_ = from;
+    window_to_ = to;
+    windows->push_back({window_sum_.Digest(), retained_starts_[from - retained_first_],
+                        retained_ends_[to - 1 - retained_first_]});
+
+    // Overlapping windows slide out of this one; the others start afresh
+    next_window_ = from + stride_;
+    const uint64_t keep = std::min(stride_ < window_ ? from : next_window_, to);
+    const size_t drop = static_cast<size_t>(keep - retained_first_);
+    retained_hashes_.erase(retained_hashes_.begin(), retained_hashes_.begin() + drop);
+    retained_starts_.erase(retained_starts_.begin(), retained_starts_.begin() + drop);
+    retained_ends_.erase(retained_ends_.begin(), retained_ends_.begin() + drop);
+    retained_first_ = keep;
+}
+
+// The next window must find every feature it reads among the retained ones
+bool SimHashStream::Consistent() const {
+    const uint64_t retained = retained_hashes_.size();
+    if (window_ == 0) return retained == 0 && window_to_ == 0 && next_window_ == 0;
+    if (window_to_ == 0 ? window_from_ != 0 || next_window_ != 0
+                        : window_to_ - window_from_ != window_ || next_window_ != window_from_ + stride_) {
+        return false;
+    }
+    if (window_to_ > features_ || (retained > 0 && retained_first_ + retained != features_)) return false;
+    if (features_ <= next_window_) return true;
+    const uint64_t needed = window_to_ > next_window_ ? window_from_ : next_window_;
+    return retained > 0 && retained_first_ <= needed;
+}
+
+void SimHashStream::Flush() {
+    total_.Add(batch_.data(), batch_.size());
+    batch_.clear();
+}
+
+uint64_t SimHashStream::Digest() const {
+    const size_t k = options_.shingle;
+    uint64_t ring[kMaxShingle];
+    std::copy(std::begin(token_hashes_), std::end(token_hashes_), ring);
+    uint64_t tokens = tokens_;
+    if (!carry_.empty()) {
+        ring[tokens++ % kMaxShingle] = TokenHash(carry_.data(), carry_.size(), options_.lowercase, false);
+    }
+
+    // Same rules as SimHash(): one feature for short text, 0 for none
+    if (tokens == 0) return 0;
+    if (tokens < k) return ShingleHash(ring, tokens, tokens);
+    if (tokens == tokens_) return total_.Digest();
+    SimHashAccumulator total = total_;
+    total.Add(ShingleHash(ring, tokens, k));
+    return total.Digest();
+}
+
+// Layout (little-endian): "ECESIMS1", u32 shingle, u32 lowercase, u32
+// window, u32 stride, u64 bytes, u64 tokens, u64 features, i32 total[64],
+// u64 token hashes[16], starts[16], ends[16], u64 carry length + bytes,
+// u64 window_from, window_to, next_window, retained_first, retained count,
+// i32 window_sum[64], u64 retained hashes[n], starts[n], ends[n]
+std::string SimHashStream::Serialize() const {
+    std::string out(kStreamMagic, sizeof(kStreamMagic));
+    const uint32_t lowercase = options_.lowercase ? 1 : 0;
+    Put(&out, &options_.shingle);
+    Put(&out, &lowercase);
+    Put(&out, &window_);
+    Put(&out, &stride_);
+    Put(&out, &bytes_);
+    Put(&out, &tokens_);
+    Put(&out, &features_);
+    Put(&out, total_.counters(), 64);
+    Put(&out, token_hashes_, kMaxShingle);
+    Put(&out, token_starts_, kMaxShingle);
+    Put(&out, token_ends_, kMaxShingle);
+    const uint64_t carry = carry_.size();
+    Put(&out, &carry);
+    out.append(carry_);
+    const uint64_t retained = retained_hashes_.size();
+    Put(&out, &window_from_);
+    Put(&out, &window_to_);
+    Put(&out, &next_window_);
+    Put(&out, &retained_first_);
+    Put(&out, &retained);
+    Put(&out, window_sum_.counters(), 64);
+    Put(&out, retained_hashes_.data(), retained);
+    Put(&out, retained_starts_.data(), retained);
+    Put(&out, retained_ends_.data(), retained);
+    return out;
+}
+
+bool SimHashStream::Deserialize(std::string_view state, std::string* error) {
+    StateReader reader(state);
+    char magic[sizeof(kStreamMagic)];
+    if (!reader.Get(magic, sizeof(magic)) || std::memcmp(magic, kStreamMagic, sizeof(magic)) != 0) {
+        *error = "Invalid simhash stream state (bad header)";
+        return false;
+    }
+
+    uint32_t shingle = 0, lowercase = 0, window = 0, stride = 0;
+    uint64_t carry = 0, retained = 0;
+    int32_t counters[64] = {};
+    SimHashStream next;
+    bool ok = reader.Get(&shingle) && reader.Get(&lowercase) && reader.Get(&window) && reader.Get(&stride) &&
+              shingle >= 1 && shingle <= kMaxShingle && (window == 0 ? stride == 0 : stride >= 1);
+    if (ok) {
+        next = SimHashStream(SimHashOptions{shingle, lowercase != 0}, window, stride);
+        ok = reader.Get(&next.bytes_) && reader.Get(&next.tokens_) && reader.Get(&next.features_) &&
+             reader.Get(counters, 64) && reader.Get(next.token_hashes_, kMaxShingle) &&
+             reader.Get(next.token_starts_, kMaxShingle) && reader.Get(next.token_ends_, kMaxShingle) &&
+             reader.Get(&carry) && reader.Bytes(&next.carry_, carry);
+        next.total_.Restore(counters);
+    }
+    ok = ok && reader.Get(&next.window_from_) && reader.Get(&next.window_to_) && reader.Get(&next.next_window_) &&
+         reader.Get(&next.retained_first_) && reader.Get(&retained) && reader.Get(counters, 64) &&
+         retained <= state.size() / 24;
+    if (ok) {
+        next.window_sum_.Restore(counters);
+        next.retained_hashes_.resize(static_cast<size_t>(retained));
+        next.retained_starts_.resize(static_cast<size_t>(retained));
+        next.retained_ends_.resize(static_cast<size_t>(retained));
+        ok = reader.Get(next.retained_hashes_.data(), retained) && reader.Get(next.retained_starts_.data(), retained) &&
+             reader.Get(next.retained_ends_.data(), retained) && reader.AtEnd();
+    }
+    if (!ok || next.carry_.size() > next.bytes_ || !next.Consistent()) {
+        *error = "Invalid simhash stream state (truncated or inconsistent)";
+        return false;
+    }
+    *this = std::move(next);
+    return true;
+}
+
+void HammingDistances(uint64_t query, const uint64_t* candidates, size_t count, uint8_t* out) {
+    XorDistances<false>(candidates, &query, count, out);
+}
+
+void HammingDistancesPairwise(const uint64_t* a, const uint64_t* b, size_t count, uint8_t* out) {
+    XorDistances<true>(a, b, count, out);
+}
+
+std::vector<std::pair<uint32_t, uint8_t>> NearestK(uint64_t query, const uint64_t* candidates, size_t count,
+                                                   size_t k, int max_distance) {
+    std::vector<std::pair<uint32_t, uint8_t>> nearest;
+    max_distance = std::min(max_distance, 64);
+    if (k == 0 || count == 0 || max_distance < 0) return nearest;
+
+    std::vector<uint8_t> distances(count);
+    HammingDistances(query, candidates, count, distances.data());
+
+    size_t histogram[65] = {};
+    for (uint8_t d : distances) ++histogram[d];
+
+    // Smallest cutoff admitting k candidates; at the cutoff only the first
+    // few by index fit. Bucket starts give each distance its output slots.
+    size_t next[65];
+    size_t taken = 0;
+    int cutoff = max_distance;
+    for (int d = 0; d <= max_distance; ++d) {
+        next[d] = taken;
+        if (taken + histogram[d] >= k) {
+            histogram[d] = k - taken;
+            taken = k;
+            cutoff = d;
+            break;
+        }
+        taken += histogram[d];
+    }
+
+    nearest.resize(taken);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t d = distances[i];
+        if (d > cutoff || histogram[d] == 0) continue;
+        --histogram[d];
+        nearest[next[d]++] = {static_cast<uint32_t>(i), d};
+    }
+    return nearest;
+}
+
+// --- N-API: SimHashStream ---
+
+Napi::FunctionReference SimHashStreamObject::constructor;
+
+Napi::Object SimHashStreamObject::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SimHashStream", {
+        InstanceMethod("append", &SimHashStreamObject::Append),
+        InstanceMethod("digest", &SimHashStreamObject::Digest),
+        InstanceMethod("serialize", &SimHashStreamObject::Serialize),
+        InstanceMethod("reset", &SimHashStreamObject::Reset),
+        InstanceAccessor("bytes", &SimHashStreamObject::GetBytes, nullptr)
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("SimHashStream", func);
+    return exports;
+}
+
+// Constructor: new SimHashStream({ shingle?, lowercase?, window?, stride? })
+// starts empty; new SimHashStream(buffer) resumes a serialize()d stream.
+SimHashStreamObject::SimHashStreamObject(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SimHashStreamObject>(info) {
+    Napi::Env env = info.Env();
+    if (info.Length() > 0 && info[0].IsBuffer()) {
+        Napi::Buffer<char> state = info[0].As<Napi::Buffer<char>>();
+        std::string error;
+        if (!stream_.Deserialize(std::string_view(state.Data(), state.Length()), &error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        }
+        return;
+    }
+
+    SimHashOptions options;
+    uint32_t window = 0;
+    uint32_t stride = 0;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object opts = info[0].As<Napi::Object>();
+        options = ReadSimHashOptions(opts);
+        const Napi::Value window_value = opts.Get("window");
+        const Napi::Value stride_value = opts.Get("stride");
+        if ((!window_value.IsUndefined() && !window_value.IsNumber()) ||
+            (!stride_value.IsUndefined() && !stride_value.IsNumber())) {
+            Napi::TypeError::New(env, "window and stride must be numbers").ThrowAsJavaScriptException();
+            return;
+        }
+        if (window_value.IsNumber()) {
+            const int64_t value = window_value.As<Napi::Number>().Int64Value();
+            window = static_cast<uint32_t>(std::clamp<int64_t>(value, 0, UINT32_MAX));
+        }
+        if (stride_value.IsNumber()) {
+            const int64_t value = stride_value.As<Napi::Number>().Int64Value();
+            stride = static_cast<uint32_t>(std::clamp<int64_t>(value, 0, UINT32_MAX));
+        }
+    }
+    stream_ = SimHashStream(options, window, stride);
+}
+
+// append(text: string | Buffer) -> { hashes: BigUint64Array, starts, ends }
+// for the windows the text completed; starts/ends are Float64Array byte
+// offsets into the whole stream.
+Napi::Value SimHashStreamObject::Append(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || (!info[0].IsString() && !info[0].IsBuffer())) {
+        Napi::TypeError::New(env, "String or Buffer expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::vector<SimHashStream::Window> windows;
+    if (info[0].IsBuffer()) {
+        Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+        stream_.Append(std::string_view(buffer.Data(), buffer.Length()), &windows);
+    } else {
+        stream_.Append(info[0].As<Napi::String>().Utf8Value(), &windows);
+    }
+
+    Napi::BigUint64Array hashes = Napi::BigUint64Array::New(env, windows.size());
+    Napi::Float64Array starts = Napi::Float64Array::New(env, windows.size());
+    Napi::Float64Array ends = Napi::Float64Array::New(env, windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        hashes[i] = windows[i].hash;
+        starts[i] = static_cast<double>(windows[i].start);
+        ends[i] = static_cast<double>(windows[i].end);
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("hashes", hashes);
+    result.Set("starts", starts);
+    result.Set("ends", ends);
+    return result;
+}
+
+// digest() -> bigint, equal to fingerprint() of everything appended
+Napi::Value SimHashStreamObject::Digest(const Napi::CallbackInfo& info) {
+    return Napi::BigInt::New(info.Env(), stream_.Digest());
+}
+
+// serialize() -> Buffer for new SimHashStream(buffer)
+Napi::Value SimHashStreamObject::Serialize(const Napi::CallbackInfo& info) {
+    const std::string state = stream_.Serialize();
+    return Napi::Buffer<char>::Copy(info.Env(), state.data(), state.size());
+}
+
+Napi::Value SimHashStreamObject::Reset(const Napi::CallbackInfo& info) {
+    stream_.Reset();
+    return info.Env().Undefined();
+}
+
+Napi::Value SimHashStreamObject::GetBytes(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(stream_.bytes()));
+}
+
+Napi::Object InitFingerprint(Napi::Env env, Napi::Object exports) {
+    exports.Set("fingerprint", Napi::Function::New(env, Fingerprint));
+    exports.Set("distance", Napi::Function::New(env, Distance));
+    exports.Set("distanceBatch", Napi::Function::New(env, DistanceBatch));
+    exports.Set("nearestK", Napi::Function::New(env, NearestKBinding));
+    SimHashStreamObject::Init(env, exports);
+    return exports;
+}
+
+} // namespace ece
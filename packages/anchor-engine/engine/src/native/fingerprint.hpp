@@ -0,0 +1,170 @@
+#pragma once
+#include <napi.h>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ece {
+
+struct SimHashOptions {
+    uint32_t shingle = 2;  // whitespace tokens per feature (1-16)
+    bool lowercase = true; // ASCII case folding before hashing
+};
+
+// Fast 64-bit hash of a byte string (multiply-mix over 8-byte words with a
+// murmur finalizer). Stable across platforms and releases: fingerprints are
+// persisted, so changing it invalidates every stored simhash.
+uint64_t HashBytes(std::string_view bytes, uint64_t seed = 0);
+
+// The 64 signed counters behind a SimHash: every feature moves counter i by
+// +1 where bit i of its hash is set and by -1 where it is clear. Batches are
+// accumulated eight lanes at a time with AVX2 (SSE2 and scalar fallbacks).
+class SimHashAccumulator {
+public:
+    void Add(const uint64_t* features, size_t count);
+    void Add(uint64_t feature) { Add(&feature, 1); }
+    // Undoes Add() of the same features (sliding windows).
+    void Remove(const uint64_t* features, size_t count);
+    void Reset();
+    void Restore(const int32_t* counters);
+
+    // Bit i is set when counter i is positive.
+    uint64_t Digest() const;
+    const int32_t* counters() const { return counters_; }
+
+private:
+    void Accumulate(const uint64_t* features, size_t count, int32_t sign);
+
+    alignas(32) int32_t counters_[64] = {};
+};
+
+// SimHash of `text` over overlapping shingles of `options.shingle` tokens.
+// Text with fewer tokens than that is one feature; empty text hashes to 0.
+uint64_t SimHash(std::string_view text, const SimHashOptions& options = {});
+
+// The shingle hashes SimHash() accumulates, in text order (repeats kept).
+void ShingleFeatures(std::string_view text, const SimHashOptions& options, std::vector<uint64_t>* features);
+
+// SimHash of text that arrives in pieces, e.g. a log file that grows: each
+// Append() hashes only the new bytes, and Digest() always equals SimHash()
+// of everything appended so far. A token split across appends is carried
+// until whitespace ends it.
+//
+// With a window of W features (shingles) and a stride of S, Append() also
+// reports the fingerprint of features [i*S, i*S + W) as soon as the last of
+// them is complete, with the byte range it covers. Overlapping windows
+// update one set of counters (S features in, S out) instead of recounting.
+//
+// Serialize() captures the counters, the last tokens and the window state,
+// so a source can resume where it stopped after a restart.
+class SimHashStream {
+public:
+    struct Window {
+        uint64_t hash;
+        uint64_t start; // byte offset of the first token
+        uint64_t end;   // byte offset just past the last token
+    };
+
+    // window 0 disables windowed fingerprints; stride 0 means stride = window.
+    explicit SimHashStream(const SimHashOptions& options = {}, uint32_t window = 0, uint32_t stride = 0);
+
+    // Feeds the next bytes; windows they complete are appended to *windows.
+    void Append(std::string_view text, std::vector<Window>* windows);
+    uint64_t Digest() const;
+    void Reset();
+
+    uint64_t bytes() const { return bytes_; }
+
+    std::string Serialize() const;
+    // Replaces the state (options included); on failure nothing changes.
+    bool Deserialize(std::string_view state, std::string* error);
+
+private:
+    void AddToken(uint64_t hash, uint64_t start, uint64_t end, std::vector<Window>* windows);
+    void EmitWindow(std::vector<Window>* windows);
+    void Flush();
+    bool Consistent() const;
+
+    SimHashOptions options_;
+    uint32_t window_ = 0;
+    uint32_t stride_ = 0;
+
+    uint64_t bytes_ = 0;
+    uint64_t tokens_ = 0;
+    uint64_t features_ = 0;
+    // The last 16 tokens (hash and byte range), by token index mod 16
+    uint64_t token_hashes_[16] = {};
+    uint64_t token_starts_[16] = {};
+    uint64_t token_ends_[16] = {};
+    std::string carry_; // unterminated last token
+    SimHashAccumulator total_;
+    std::vector<uint64_t> batch_; // features not yet in total_; empty between calls
+
+    // Features from retained_first_ on that a coming window still needs;
+    // window_sum_ holds features [window_from_, window_to_)
+    uint64_t retained_first_ = 0;
+    std::vector<uint64_t> retained_hashes_;
+    std::vector<uint64_t> retained_starts_;
+    std::vector<uint64_t> retained_ends_;
+    SimHashAccumulator window_sum_;
+    uint64_t window_from_ = 0;
+    uint64_t window_to_ = 0;
+    uint64_t next_window_ = 0;
+};
+
+inline int HammingDistance(uint64_t a, uint64_t b) {
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+// out[i] = HammingDistance(query, candidates[i]). Four hashes per AVX2 step:
+// XOR, nibble popcount by table shuffle (vpshufb), byte sums with vpsadbw.
+void HammingDistances(uint64_t query, const uint64_t* candidates, size_t count, uint8_t* out);
+
+// out[i] = HammingDistance(a[i], b[i]).
+void HammingDistancesPairwise(const uint64_t* a, const uint64_t* b, size_t count, uint8_t* out);
+
+// Up to `k` candidates within `max_distance` of `query` as (index, distance),
+// nearest first and by index among equals. Linear: distances are bucketed,
+// never sorted.
+std::vector<std::pair<uint32_t, uint8_t>> NearestK(uint64_t query, const uint64_t* candidates, size_t count,
+                                                   size_t k, int max_distance);
+
+// Reads a 64-bit hash given as a BigInt, a hex string (optional 0x, as
+// stored in the simhash columns) or a non-negative integer Number.
+bool ReadHash(const Napi::Value& value, uint64_t* out);
+
+// { shingle?, lowercase? } as accepted by fingerprint(); shingle is clamped
+// to 1-16.
+SimHashOptions ReadSimHashOptions(const Napi::Object& opts);
+
+// BigUint64Array (or BigInt64Array; the bits are the same) contents in place.
+bool ReadHashArray(const Napi::Value& value, const uint64_t** data, size_t* count);
+
+// JS wrapper: new SimHashStream({ shingle?, lowercase?, window?, stride? })
+// or new SimHashStream(serializedState)
+class SimHashStreamObject : public Napi::ObjectWrap<SimHashStreamObject> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SimHashStreamObject(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Append(const Napi::CallbackInfo& info);
+    Napi::Value Digest(const Napi::CallbackInfo& info);
+    Napi::Value Serialize(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value GetBytes(const Napi::CallbackInfo& info);
+
+    SimHashStream stream_;
+};
+
+// Registers fingerprint(), distance(), distanceBatch(), nearestK() and the
+// SimHashStream class on the module exports.
+Napi::Object InitFingerprint(Napi::Env env, Napi::Object exports);
+
+} // namespace ece
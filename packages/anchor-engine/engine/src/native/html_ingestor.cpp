@@ -1,16 +1,1724 @@
 #include "html_ingestor.hpp"
-#include <sstream>
+#include "charset.hpp"
+#include "worker_pool.hpp"
 #include <algorithm>
-#include <cctype>
+#include <cstring>
+#include <mutex>
 #include <unordered_set>
 
 namespace ece {
 
+namespace {
+
+// Tags carrying huge inline data (base64 images, JSON blobs in attributes)
+// are clipped; the name and leading attributes are all we ever need.
+constexpr size_t kMaxTagBytes = 64 * 1024;
+constexpr size_t kMaxEntityBytes = 32;
+// How much of a document the charset prescan looks at
+constexpr size_t kCharsetPrescanBytes = 1024;
+
+inline bool IsAsciiAlpha(char c) {
+    const char l = static_cast<char>(c | 0x20);
+    return l >= 'a' && l <= 'z';
+}
+
+inline bool IsAsciiAlnum(char c) {
+    return IsAsciiAlpha(c) || (c >= '0' && c <= '9');
+}
+
+inline bool IsHtmlSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline char AsciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (AsciiLower(a[i]) != AsciiLower(b[i])) return false;
+    }
+    return true;
+}
+
+void AppendUtf8(uint32_t cp, std::string& out) {
+    if (cp == 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) cp = 0xFFFD;
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Decodes the body of "&name;" (without '&' and ';'). Returns false for
+// unknown entities so the caller can emit them verbatim.
+bool DecodeEntity(std::string_view name, std::string& out) {
+    if (name.empty()) return false;
+
+    if (name[0] == '#') {
+        uint32_t cp = 0;
+        size_t i = 1;
+        const bool hex = name.size() > 1 && (name[1] == 'x' || name[1] == 'X');
+        if (hex) ++i;
+        if (i >= name.size()) return false;
+        for (; i < name.size(); ++i) {
+            const char c = name[i];
+            uint32_t digit;
+            if (c >= '0' && c <= '9') digit = static_cast<uint32_t>(c - '0');
+            else if (hex && AsciiLower(c) >= 'a' && AsciiLower(c) <= 'f') digit = static_cast<uint32_t>(AsciiLower(c) - 'a' + 10);
+            else return false;
+            cp = cp * (hex ? 16 : 10) + digit;
+            if (cp > 0x10FFFF) cp = 0x110000; // clamp, reported as U+FFFD
+        }
+        AppendUtf8(cp, out);
+        return true;
+    }
+
+    struct Named { const char* name; const char* utf8; };
+    static const Named kNamed[] = {
+        {"amp", "&"}, {"lt", "<"}, {"gt", ">"}, {"quot", "\""}, {"apos", "'"},
+        {"nbsp", " "}, {"ensp", " "}, {"emsp", " "}, {"thinsp", " "},
+        {"copy", "\xC2\xA9"}, {"reg", "\xC2\xAE"}, {"trade", "\xE2\x84\xA2"},
+        {"hellip", "\xE2\x80\xA6"}, {"mdash", "\xE2\x80\x94"}, {"ndash", "\xE2\x80\x93"},
+        {"lsquo", "\xE2\x80\x98"}, {"rsquo", "\xE2\x80\x99"},
+        {"ldquo", "\xE2\x80\x9C"}, {"rdquo", "\xE2\x80\x9D"},
+        {"laquo", "\xC2\xAB"}, {"raquo", "\xC2\xBB"}, {"bull", "\xE2\x80\xA2"},
+        {"middot", "\xC2\xB7"}, {"deg", "\xC2\xB0"}, {"times", "\xC3\x97"},
+        {"divide", "\xC3\xB7"}, {"euro", "\xE2\x82\xAC"}, {"pound", "\xC2\xA3"},
+        {"yen", "\xC2\xA5"}, {"cent", "\xC2\xA2"}, {"sect", "\xC2\xA7"},
+        {"para", "\xC2\xB6"}, {"larr", "\xE2\x86\x90"}, {"rarr", "\xE2\x86\x92"},
+    };
+    for (const Named& entry : kNamed) {
+        if (name == entry.name) {
+            out.append(entry.utf8);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Calls fn(name, raw_value) for every attribute in `raw` until fn returns true.
+template <typename Fn>
+void ForEachAttr(std::string_view raw, Fn&& fn) {
+    size_t i = 0;
+    const size_t n = raw.size();
+    while (i < n) {
+        while (i < n && (IsHtmlSpace(raw[i]) || raw[i] == '/')) ++i;
+        const size_t name_start = i;
+        while (i < n && !IsHtmlSpace(raw[i]) && raw[i] != '=' && raw[i] != '/') ++i;
+        const std::string_view name = raw.substr(name_start, i - name_start);
+
+        while (i < n && IsHtmlSpace(raw[i])) ++i;
+        std::string_view value;
+        if (i < n && raw[i] == '=') {
+            ++i;
+            while (i < n && IsHtmlSpace(raw[i])) ++i;
+            if (i < n && (raw[i] == '"' || raw[i] == '\'')) {
+                const char quote = raw[i++];
+                const size_t value_start = i;
+                while (i < n && raw[i] != quote) ++i;
+                value = raw.substr(value_start, i - value_start);
+                if (i < n) ++i;
+            } else {
+                const size_t value_start = i;
+                while (i < n && !IsHtmlSpace(raw[i])) ++i;
+                value = raw.substr(value_start, i - value_start);
+            }
+        }
+
+        if (!name.empty() && fn(name, value)) return;
+    }
+}
+
+// Length of the longest prefix of `s` that does not end inside a UTF-8
+// sequence. Buffers pushed from JS may split a character across chunks.
+size_t Utf8CompleteLength(std::string_view s) {
+    const size_t n = s.size();
+    size_t i = n;
+    for (int k = 0; k < 4 && i > 0; ++k) {
+        const unsigned char c = static_cast<unsigned char>(s[--i]);
+        if ((c & 0xC0) == 0x80) continue;
+        size_t need = 1;
+        if ((c & 0xE0) == 0xC0) need = 2;
+        else if ((c & 0xF0) == 0xE0) need = 3;
+        else if ((c & 0xF8) == 0xF0) need = 4;
+        return (n - i >= need) ? n : i;
+    }
+    return n;
+}
+
+// Separator a block element boundary maps to: 0 = space (table cells),
+// 1 = line break, 2 = paragraph break.
+int BreakLevel(std::string_view tag_name) {
+    if (tag_name == "td" || tag_name == "th") return 0;
+    if (tag_name == "li" || tag_name == "tr" || tag_name == "br" ||
+        tag_name == "dt" || tag_name == "dd") {
+        return 1;
+    }
+    return 2;
+}
+
+// Collapses whitespace runs to a single space. With block breaks enabled,
+// block boundaries become "\n" or "\n\n" so paragraph structure survives for
+// the atomizer. Separators are emitted lazily, so the output never carries
+// leading or trailing whitespace and can be drained at any point.
+class TextCollector : public HtmlSink {
+public:
+    TextCollector(std::string* out, bool block_breaks) : out_(out), block_breaks_(block_breaks) {}
+
+    void Reset() {
+        started_ = false;
+        pending_space_ = false;
+        pending_break_ = 0;
+    }
+
+    void OnText(std::string_view text) override {
+        size_t i = 0;
+        const size_t n = text.size();
+        while (i < n) {
+            if (IsHtmlSpace(text[i])) {
+                pending_space_ = true;
+                ++i;
+                continue;
+            }
+            size_t run_end = i + 1;
+            while (run_end < n && !IsHtmlSpace(text[run_end])) ++run_end;
+
+            if (started_) {
+                if (pending_break_ == 2) out_->append("\n\n");
+                else if (pending_break_ == 1) out_->push_back('\n');
+                else if (pending_space_) out_->push_back(' ');
+            }
+            pending_break_ = 0;
+            pending_space_ = false;
+            started_ = true;
+            out_->append(text.data() + i, run_end - i);
+            i = run_end;
+        }
+    }
+
+    void OnStartTag(const HtmlTag& tag) override { Separate(tag.name); }
+    void OnEndTag(std::string_view name) override { Separate(name); }
+
+private:
+    void Separate(std::string_view name) {
+        if (!HtmlIngestor::IsBlockElement(name)) return;
+        const int level = block_breaks_ ? BreakLevel(name) : 0;
+        if (level == 0) pending_space_ = true;
+        else pending_break_ = std::max(pending_break_, level);
+    }
+
+    std::string* out_;
+    bool block_breaks_;
+    bool started_ = false;
+    bool pending_space_ = false;
+    int pending_break_ = 0;
+};
+
+// Incremental twin of the atomizer's prose strategy: an atom is cut at the
+// first sentence or paragraph boundary past the target size, or forced at 3x.
+// Only the unfinished atom is held, so memory stays bounded by the chunk size.
+class StreamAtomizer {
+public:
+    explicit StreamAtomizer(size_t max_chunk_size)
+        : target_(max_chunk_size), hard_limit_(max_chunk_size * 3) {}
+
+    void Append(std::string_view text, std::vector<std::string>& atoms) {
+        pending_.append(text);
+        const size_t len = pending_.size();
+        size_t start = 0;
+        size_t i = std::max(scan_, target_);
+
+        while (i < len) {
+            const size_t current = i - start;
+            const char c = pending_[i];
+            size_t cut = 0;
+
+            if (c == '\n' || c == '.' || c == '!' || c == '?') {
+                if (i + 1 >= len) break; // boundary needs one byte of lookahead
+                const char next = pending_[i + 1];
+                if (c == '\n') {
+                    if (next == '\n') cut = current + 2;
+                } else if (next == ' ' || next == '\n') {
+                    cut = current + 1;
+                }
+            }
+            if (cut == 0 && current >= hard_limit_) {
+                size_t end = i + 1;
+                while (end > start + 1 && end < len &&
+                       (static_cast<unsigned char>(pending_[end]) & 0xC0) == 0x80) {
+                    --end;
+                }
+                cut = end - start;
+            }
+
+            if (cut != 0) {
+                atoms.emplace_back(pending_, start, cut);
+                start += cut;
+                i = start + target_;
+            } else {
+                ++i;
+            }
+        }
+
+        pending_.erase(0, start);
+        scan_ = i - start;
+    }
+
+    void Flush(std::vector<std::string>& atoms) {
+        if (!pending_.empty()) atoms.push_back(std::move(pending_));
+        pending_.clear();
+        scan_ = 0;
+    }
+
+private:
+    std::string pending_;
+    size_t scan_ = 0; // resume offset into pending_
+    size_t target_;
+    size_t hard_limit_;
+};
+
+// --- Main-content extraction (readability-style) ---
+
+constexpr uint32_t kNil = 0xFFFFFFFFu;
+
+struct DomNode {
+    uint32_t parent = kNil;
+    uint32_t first_child = kNil;
+    uint32_t last_child = kNil;
+    uint32_t next_sibling = kNil;
+    uint32_t name_offset = 0; // element name, or text range, in the arena pools
+    uint32_t name_length = 0;
+    uint32_t attr_offset = 0; // raw attributes, kept only for serialized tags
+    uint32_t attr_length = 0;
+    uint32_t text_length = 0; // aggregated over the subtree
+    uint32_t link_length = 0;
+    uint32_t commas = 0;
+    float score = 0.0f;
+    int16_t class_weight = 0;
+    bool is_text = false;
+    bool removed = false;     // boilerplate or hidden subtree
+    bool preformatted = false;
+    bool candidate = false;
+    bool has_block_child = false;
+};
+
+bool ContainsAny(std::string_view haystack, const char* const* needles, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (haystack.find(needles[i]) != std::string_view::npos) return true;
+    }
+    return false;
+}
+
+// Class/id weighting in the spirit of Readability: +25 for names that usually
+// wrap the article, -25 for navigation, promos, consent banners and the like.
+int ClassWeight(const HtmlTag& tag) {
+    static const char* const kPositive[] = {
+        "article", "body", "content", "entry", "hentry", "main", "page",
+        "post", "text", "blog", "story", "prose"
+    };
+    static const char* const kNegative[] = {
+        "hidden", "banner", "combx", "comment", "com-", "contact", "foot",
+        "footnote", "gdpr", "masthead", "meta", "outbrain", "promo", "related",
+        "scroll", "share", "shoutbox", "sidebar", "skyscraper", "sponsor",
+        "shopping", "tags", "tool", "widget", "cookie", "consent", "nav",
+        "menu", "breadcrumb", "subscribe", "newsletter", "popup", "modal",
+        "social", "advert", "ad-", "-ad", "ads"
+    };
+
+    std::string names = tag.Attr("class");
+    names.push_back(' ');
+    names.append(tag.Attr("id"));
+    if (names.size() == 1) return 0;
+    std::transform(names.begin(), names.end(), names.begin(), AsciiLower);
+
+    int weight = 0;
+    if (ContainsAny(names, kNegative, sizeof(kNegative) / sizeof(kNegative[0]))) weight -= 25;
+    if (ContainsAny(names, kPositive, sizeof(kPositive) / sizeof(kPositive[0]))) weight += 25;
+    return weight;
+}
+
+bool IsVoidElement(std::string_view name) {
+    static const std::unordered_set<std::string_view> kVoid = {
+        "area", "base", "br", "col", "embed", "hr", "img", "input",
+        "link", "meta", "param", "source", "track", "wbr"
+    };
+    return kVoid.count(name) > 0;
+}
+
+// Subtrees that never hold article text
+bool IsBoilerplateElement(std::string_view name) {
+    static const std::unordered_set<std::string_view> kBoilerplate = {
+        "head", "nav", "footer", "aside", "form", "button", "select", "noscript",
+        "svg", "iframe", "template", "dialog", "menu", "object", "canvas"
+    };
+    return kBoilerplate.count(name) > 0;
+}
+
+bool IsHidden(const HtmlTag& tag) {
+    if (tag.HasAttr("hidden")) return true;
+    if (EqualsIgnoreCase(tag.Attr("aria-hidden"), "true")) return true;
+    std::string style = tag.Attr("style");
+    style.erase(std::remove_if(style.begin(), style.end(), IsHtmlSpace), style.end());
+    std::transform(style.begin(), style.end(), style.begin(), AsciiLower);
+    return style.find("display:none") != std::string::npos ||
+           style.find("visibility:hidden") != std::string::npos;
+}
+
+// Lightweight DOM built straight from tokenizer events. Nodes live in one
+// contiguous vector and all text and names in one string pool, indexed by
+// offset, so building costs a handful of reallocations and teardown is free.
+// Nodes are appended in document order, so every child index is larger than
+// its parent's and subtree aggregation is a single reverse sweep.
+class DomArena : public HtmlSink {
+public:
+    DomArena() {
+        nodes_.reserve(1024);
+        Reset();
+    }
+
+    // Clears the tree but keeps the allocations for the next document.
+    void Reset() {
+        nodes_.clear();
+        pool_.clear();
+        open_.clear();
+        nodes_.emplace_back(); // synthetic document root
+        open_.push_back(0);
+    }
+
+    void OnText(std::string_view text) override {
+        const uint32_t parent = open_.back();
+        if (nodes_[parent].removed) return;
+
+        // Collapse whitespace on the way into the pool, except inside <pre>
+        const size_t begin = pool_.size();
+        const bool preformatted = nodes_[parent].preformatted;
+        bool space = false;
+        for (char c : text) {
+            if (preformatted) {
+                pool_.push_back(c);
+            } else if (IsHtmlSpace(c)) {
+                if (!space) pool_.push_back(' ');
+                space = true;
+            } else {
+                pool_.push_back(c);
+                space = false;
+            }
+        }
+        if (pool_.size() == begin) return;
+
+        DomNode& node = Append(parent);
+        node.preformatted = preformatted;
+        node.is_text = true;
+        node.name_offset = static_cast<uint32_t>(begin);
+        node.name_length = static_cast<uint32_t>(pool_.size() - begin);
+        for (size_t i = begin; i < pool_.size(); ++i) {
+            if (!IsHtmlSpace(pool_[i])) ++node.text_length;
+            if (pool_[i] == ',') ++node.commas;
+        }
+    }
+
+    void OnStartTag(const HtmlTag& tag) override {
+        // Implicitly close elements HTML does not nest
+        const std::string_view top = Name(open_.back());
+        if (top == tag.name && (top == "p" || top == "li" || top == "dt" || top == "dd" ||
+                                top == "tr" || top == "td" || top == "th" || top == "option")) {
+            open_.pop_back();
+        } else if (top == "p" && HtmlIngestor::IsBlockElement(tag.name)) {
+            open_.pop_back();
+        }
+
+        const uint32_t parent = open_.back();
+        const bool parent_removed = nodes_[parent].removed;
+        if (HtmlIngestor::IsBlockElement(tag.name)) nodes_[parent].has_block_child = true;
+
+        const uint32_t name_offset = static_cast<uint32_t>(pool_.size());
+        pool_.append(tag.name);
+        const uint32_t attr_offset = static_cast<uint32_t>(pool_.size());
+        const bool keep_attrs = tag.name == "a" || tag.name == "img" || tag.name == "pre" ||
+                                tag.name == "code" || tag.name == "ol";
+        if (keep_attrs) pool_.append(tag.raw_attrs);
+
+        DomNode& node = Append(parent);
+        node.name_offset = name_offset;
+        node.name_length = static_cast<uint32_t>(tag.name.size());
+        node.attr_offset = attr_offset;
+        node.attr_length = keep_attrs ? static_cast<uint32_t>(tag.raw_attrs.size()) : 0;
+        node.preformatted = nodes_[parent].preformatted || tag.name == "pre";
+        node.removed = parent_removed;
+        if (!parent_removed) {
+            node.class_weight = static_cast<int16_t>(ClassWeight(tag));
+            // Unlikely candidates are dropped unless they also look like content
+            node.removed = IsBoilerplateElement(tag.name) || IsHidden(tag) ||
+                           node.class_weight <= -25;
+        }
+
+        if (!tag.self_closing && !IsVoidElement(tag.name)) {
+            open_.push_back(static_cast<uint32_t>(nodes_.size() - 1));
+        }
+    }
+
+    void OnEndTag(std::string_view name) override {
+        // Pop to the nearest matching open element; stray end tags are ignored
+        for (size_t i = open_.size(); i-- > 1;) {
+            if (Name(open_[i]) == name) {
+                open_.resize(i);
+                return;
+            }
+        }
+    }
+
+    // Scores paragraph-like nodes, picks the best-scoring ancestor and emits it
+    // (plus related siblings) into `sink`. Returns false if nothing qualified.
+    bool EmitMainContent(HtmlSink& sink) {
+        Aggregate();
+
+        uint32_t top = kNil;
+        for (uint32_t i = 1; i < nodes_.size(); ++i) {
+            DomNode& node = nodes_[i];
+            if (!node.candidate || node.removed) continue;
+            node.score *= 1.0f - LinkDensity(node);
+            if (top == kNil || node.score > nodes_[top].score) top = i;
+        }
+        if (top == kNil) return false;
+
+        const DomNode& best = nodes_[top];
+        const uint32_t parent = best.parent == kNil ? top : best.parent;
+        if (parent == top) {
+            Emit(top, sink);
+            return true;
+        }
+
+        const float threshold = std::max(10.0f, best.score * 0.2f);
+        for (uint32_t child = nodes_[parent].first_child; child != kNil; child = nodes_[child].next_sibling) {
+            const DomNode& node = nodes_[child];
+            if (node.removed || node.is_text) continue;
+
+            bool keep = child == top;
+            if (!keep && node.candidate) {
+                float bonus = (node.class_weight == best.class_weight && best.class_weight > 0) ? best.score * 0.2f : 0.0f;
+                keep = node.score + bonus >= threshold;
+            }
+            if (!keep && Name(child) == "p") {
+                const float density = LinkDensity(node);
+                keep = (node.text_length > 80 && density < 0.25f) ||
+                       (node.text_length > 0 && density == 0.0f && EndsWithPeriod(child));
+            }
+            if (keep) Emit(child, sink);
+        }
+        return true;
+    }
+
+    // Emits every non-removed node; used when scoring finds no candidate.
+    void EmitAll(HtmlSink& sink) { Emit(0, sink); }
+
+private:
+    DomNode& Append(uint32_t parent) {
+        const uint32_t index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        DomNode& node = nodes_.back();
+        node.parent = parent;
+        DomNode& p = nodes_[parent];
+        if (p.last_child == kNil) p.first_child = index;
+        else nodes_[p.last_child].next_sibling = index;
+        p.last_child = index;
+        return node;
+    }
+
+    std::string_view Name(uint32_t index) const {
+        const DomNode& node = nodes_[index];
+        if (node.is_text || index == 0) return std::string_view();
+        return std::string_view(pool_).substr(node.name_offset, node.name_length);
+    }
+
+    std::string_view Text(const DomNode& node) const {
+        return std::string_view(pool_).substr(node.name_offset, node.name_length);
+    }
+
+    static float LinkDensity(const DomNode& node) {
+        return node.text_length == 0 ? 0.0f
+            : static_cast<float>(node.link_length) / static_cast<float>(node.text_length);
+    }
+
+    bool EndsWithPeriod(uint32_t index) const {
+        const DomNode& node = nodes_[index];
+        for (uint32_t child = node.last_child; child != kNil;) {
+            const DomNode& c = nodes_[child];
+            if (c.is_text) {
+                const std::string_view text = Text(c);
+                const size_t last = text.find_last_not_of(" \t\n\r\f\v");
+                return last != std::string_view::npos && text[last] == '.';
+            }
+            child = c.last_child;
+        }
+        return false;
+    }
+
+    static float TagScore(std::string_view name) {
+        if (name == "div" || name == "article" || name == "main") return 5.0f;
+        if (name == "pre" || name == "td" || name == "blockquote") return 3.0f;
+        if (name == "address" || name == "ol" || name == "ul" || name == "dl" ||
+            name == "dd" || name == "dt" || name == "li" || name == "form") return -3.0f;
+        if (name == "h1" || name == "h2" || name == "h3" || name == "h4" ||
+            name == "h5" || name == "h6" || name == "th") return -5.0f;
+        return 0.0f;
+    }
+
+    void Aggregate() {
+        // Subtree totals: children always follow their parent in the arena
+        for (size_t i = nodes_.size(); i-- > 1;) {
+            DomNode& node = nodes_[i];
+            if (node.removed) continue;
+            if (!node.is_text && Name(static_cast<uint32_t>(i)) == "a") node.link_length = node.text_length;
+            DomNode& parent = nodes_[node.parent];
+            parent.text_length += node.text_length;
+            parent.link_length += node.link_length;
+            parent.commas += node.commas;
+        }
+
+        // Paragraph-like nodes feed their score to three levels of ancestors
+        for (uint32_t i = 1; i < nodes_.size(); ++i) {
+            const DomNode& node = nodes_[i];
+            if (node.removed || node.is_text || node.text_length < 25) continue;
+            const std::string_view name = Name(i);
+            const bool paragraph = name == "p" || name == "pre" || name == "td" || name == "blockquote" ||
+                ((name == "div" || name == "section" || name == "article") && !node.has_block_child);
+            if (!paragraph) continue;
+
+            const float content = 1.0f + static_cast<float>(node.commas) +
+                std::min(static_cast<float>(node.text_length) / 100.0f, 3.0f);
+
+            uint32_t ancestor = node.parent;
+            for (int level = 0; level < 3 && ancestor != kNil && ancestor != 0; ++level) {
+                DomNode& a = nodes_[ancestor];
+                if (!a.candidate) {
+                    a.candidate = true;
+                    a.score = TagScore(Name(ancestor)) + static_cast<float>(a.class_weight);
+                }
+                a.score += content / (level == 0 ? 1.0f : level == 1 ? 2.0f : 6.0f);
+                ancestor = a.parent;
+            }
+        }
+    }
+
+    // Iterative pre-order replay of a subtree as tokenizer events, so any
+    // HtmlSink (text, markdown, ...) can serialize the extracted content.
+    void Emit(uint32_t root, HtmlSink& sink) const {
+        uint32_t n = root;
+        for (;;) {
+            const DomNode& node = nodes_[n];
+            bool descend = false;
+            if (!node.removed) {
+                if (node.is_text) {
+                    sink.OnText(Text(node));
+                } else {
+                    HtmlTag tag;
+                    tag.name = Name(n);
+                    tag.raw_attrs = std::string_view(pool_).substr(node.attr_offset, node.attr_length);
+                    if (n != 0) sink.OnStartTag(tag);
+                    if (node.first_child != kNil) descend = true;
+                    else if (n != 0) sink.OnEndTag(tag.name);
+                }
+            }
+            if (descend) {
+                n = node.first_child;
+                continue;
+            }
+            while (n != root && nodes_[n].next_sibling == kNil) {
+                n = nodes_[n].parent;
+                if (n != 0) sink.OnEndTag(Name(n));
+            }
+            if (n == root) break;
+            n = nodes_[n].next_sibling;
+        }
+    }
+
+    std::vector<DomNode> nodes_;
+    std::vector<uint32_t> open_; // stack of open element indices
+    std::string pool_;
+};
+
+// --- Markdown conversion ---
+
+// Renders tokenizer events as Markdown: headings, nested lists, links and
+// images, emphasis, inline code, fenced code blocks, blockquotes and pipe
+// tables. Opening markers are held in pending_open_ until the first text of
+// the element arrives, so empty elements leave no stray "**" or "[]()".
+class MarkdownWriter : public HtmlSink {
+public:
+    explicit MarkdownWriter(std::string* out) : out_(out) {}
+
+    void OnText(std::string_view text) override {
+        if (skip_depth_ > 0) return;
+
+        if (pre_depth_ > 0) {
+            if (pending_fence_) {
+                Flush();
+                out_->append("```").append(fence_lang_).push_back('\n');
+                pending_fence_ = false;
+                fence_open_ = true;
+                if (!text.empty() && text[0] == '\n') text.remove_prefix(1);
+            }
+            out_->append(text);
+            return;
+        }
+
+        size_t i = 0;
+        const size_t n = text.size();
+        while (i < n) {
+            if (IsHtmlSpace(text[i])) {
+                pending_space_ = true;
+                ++i;
+                continue;
+            }
+            size_t run_end = i + 1;
+            while (run_end < n && !IsHtmlSpace(text[run_end])) ++run_end;
+            Flush();
+            AppendEscaped(text.substr(i, run_end - i));
+            i = run_end;
+        }
+    }
+
+    void OnStartTag(const HtmlTag& tag) override {
+        const std::string_view name = tag.name;
+        const bool has_body = !tag.self_closing && !IsVoidElement(name);
+
+        if (IsSkippedElement(name)) {
+            if (has_body) ++skip_depth_;
+            return;
+        }
+        if (skip_depth_ > 0) return;
+
+        if (pre_depth_ > 0) {
+            if (name == "pre") ++pre_depth_;
+            else if (name == "code" && pending_fence_ && fence_lang_.empty()) fence_lang_ = LanguageOf(tag);
+            else if (name == "br") OnText("\n");
+            return;
+        }
+
+        if (name.size() == 2 && name[0] == 'h' && name[1] >= '1' && name[1] <= '6') {
+            Block(2);
+            pending_open_.assign(static_cast<size_t>(name[1] - '0'), '#').push_back(' ');
+        } else if (name == "li") {
+            if (!lists_.empty() && lists_.back().item_open) OnEndTag("li"); // implied </li>
+            if (!lists_.empty()) lists_.back().item_open = true;
+            Block(1);
+            if (!lists_.empty() && lists_.back().ordered) {
+                pending_open_ = std::to_string(lists_.back().next++) + ". ";
+            } else {
+                pending_open_ = "- ";
+            }
+            pending_marker_ = true;
+            ++item_depth_;
+        } else if (name == "ul" || name == "ol") {
+            Block(lists_.empty() ? 2 : 1);
+            List list{name == "ol", 1, false};
+            if (list.ordered) {
+                const std::string start = tag.Attr("start");
+                if (!start.empty()) list.next = std::max(0, std::atoi(start.c_str()));
+            }
+            lists_.push_back(list);
+        } else if (name == "blockquote") {
+            Block(2);
+            ++quote_depth_;
+        } else if (name == "pre") {
+            Block(2);
+            ++pre_depth_;
+            pending_fence_ = true;
+            fence_lang_ = LanguageOf(tag);
+        } else if (name == "code") {
+            pending_open_.push_back('`');
+            ++code_depth_;
+        } else if (name == "strong" || name == "b") {
+            pending_open_.append("**");
+        } else if (name == "em" || name == "i") {
+            pending_open_.push_back('*');
+        } else if (name == "del" || name == "s" || name == "strike") {
+            pending_open_.append("~~");
+        } else if (name == "a") {
+            std::string href = tag.Attr("href");
+            const bool linkable = !href.empty() && href[0] != '#' && href.compare(0, 11, "javascript:") != 0;
+            if (linkable) pending_open_.push_back('[');
+            links_.push_back(linkable ? std::move(href) : std::string());
+        } else if (name == "img") {
+            const std::string src = tag.Attr("src");
+            if (!src.empty() && src.compare(0, 5, "data:") != 0) {
+                Flush();
+                out_->append("![").append(tag.Attr("alt")).append("](").append(src).push_back(')');
+            }
+        } else if (name == "br") {
+            Block(1);
+        } else if (name == "hr") {
+            Block(2);
+            Flush();
+            out_->append("---");
+            Block(2);
+        } else if (name == "table") {
+            Block(2);
+            tables_.push_back(Table{});
+        } else if (name == "tr" && !tables_.empty()) {
+            Block(1);
+            Flush();
+            out_->push_back('|');
+            tables_.back().columns = 0;
+        } else if ((name == "td" || name == "th") && !tables_.empty()) {
+            ++cell_depth_;
+            ++tables_.back().columns;
+            pending_space_ = true;
+        } else if (HtmlIngestor::IsBlockElement(name)) {
+            Block(BreakLevel(name) == 1 ? 1 : 2);
+        }
+    }
+
+    void OnEndTag(std::string_view name) override {
+        if (skip_depth_ > 0) {
+            if (IsSkippedElement(name)) --skip_depth_;
+            return;
+        }
+
+        if (pre_depth_ > 0) {
+            if (name != "pre" || --pre_depth_ > 0) return;
+            if (fence_open_) {
+                if (out_->empty() || out_->back() != '\n') out_->push_back('\n');
+                out_->append("```");
+            }
+            pending_fence_ = false;
+            fence_open_ = false;
+            fence_lang_.clear();
+            Block(2);
+            return;
+        }
+
+        if (name.size() == 2 && name[0] == 'h' && name[1] >= '1' && name[1] <= '6') {
+            pending_open_.clear();
+            Block(2);
+        } else if (name == "li") {
+            if (!lists_.empty()) {
+                if (!lists_.back().item_open) return; // stray or already implied
+                lists_.back().item_open = false;
+            }
+            if (item_depth_ > 0) --item_depth_;
+            if (pending_marker_) {
+                pending_open_.clear();
+                pending_marker_ = false;
+            }
+            Block(1);
+        } else if (name == "ul" || name == "ol") {
+            if (!lists_.empty() && lists_.back().item_open) OnEndTag("li");
+            if (!lists_.empty()) lists_.pop_back();
+            Block(lists_.empty() ? 2 : 1);
+        } else if (name == "blockquote") {
+            if (quote_depth_ > 0) --quote_depth_;
+            Block(2);
+        } else if (name == "code") {
+            if (code_depth_ > 0) --code_depth_;
+            Close("`");
+        } else if (name == "strong" || name == "b") {
+            Close("**");
+        } else if (name == "em" || name == "i") {
+            Close("*");
+        } else if (name == "del" || name == "s" || name == "strike") {
+            Close("~~");
+        } else if (name == "a") {
+            if (links_.empty()) return;
+            const std::string href = std::move(links_.back());
+            links_.pop_back();
+            if (href.empty()) return;
+            if (!pending_open_.empty() && pending_open_.back() == '[') {
+                pending_open_.pop_back(); // no anchor text
+            } else {
+                out_->append("](").append(href).push_back(')');
+            }
+        } else if ((name == "td" || name == "th") && cell_depth_ > 0) {
+            --cell_depth_;
+            pending_space_ = false;
+            Flush();
+            out_->append(" |");
+        } else if (name == "tr" && !tables_.empty()) {
+            Table& table = tables_.back();
+            if (table.rows++ == 0) {
+                Block(1);
+                Flush();
+                out_->push_back('|');
+                for (int c = 0; c < std::max(table.columns, 1); ++c) out_->append(" --- |");
+            }
+            Block(1);
+        } else if (name == "table") {
+            if (!tables_.empty()) tables_.pop_back();
+            Block(2);
+        } else if (HtmlIngestor::IsBlockElement(name)) {
+            Block(BreakLevel(name) == 1 ? 1 : 2);
+        }
+    }
+
+    // Closes an unterminated code fence at end of input.
+    void Finish() {
+        if (fence_open_) {
+            if (out_->empty() || out_->back() != '\n') out_->push_back('\n');
+            out_->append("```");
+        }
+    }
+
+private:
+    struct List { bool ordered; int next; bool item_open; };
+    struct Table { int rows = 0; int columns = 0; };
+
+    // Non-content elements and page chrome (what Turndown was told to
+    // remove); script and style bodies never reach the sink at all
+    static bool IsSkippedElement(std::string_view name) {
+        return name == "head" || name == "template" || name == "noscript" || name == "svg" ||
+               name == "script" || name == "style" || name == "iframe" || name == "nav" ||
+               name == "header" || name == "footer";
+    }
+
+    static std::string LanguageOf(const HtmlTag& tag) {
+        const std::string cls = tag.Attr("class");
+        for (const char* prefix : {"language-", "lang-"}) {
+            const size_t at = cls.find(prefix);
+            if (at == std::string::npos) continue;
+            const size_t begin = at + std::strlen(prefix);
+            size_t end = begin;
+            while (end < cls.size() && !IsHtmlSpace(cls[end])) ++end;
+            return cls.substr(begin, end - begin);
+        }
+        return std::string();
+    }
+
+    void Block(int level) {
+        if (cell_depth_ > 0) pending_space_ = true; // pipe tables are single-line
+        else pending_break_ = std::max(pending_break_, level);
+    }
+
+    void Close(const char* marker) {
+        const size_t len = std::strlen(marker);
+        if (pending_open_.size() >= len &&
+            pending_open_.compare(pending_open_.size() - len, len, marker) == 0) {
+            pending_open_.resize(pending_open_.size() - len); // element had no text
+        } else {
+            out_->append(marker);
+        }
+    }
+
+    // Blank separator lines only carry the quote markers shared by the lines
+    // around them, so entering or leaving a blockquote starts a new block.
+    void AppendLinePrefix(bool blank) {
+        const int quotes = blank ? std::min(quote_depth_, line_quote_depth_) : quote_depth_;
+        for (int q = 0; q < quotes; ++q) out_->append(blank ? ">" : "> ");
+        if (blank) return;
+        line_quote_depth_ = quote_depth_;
+        const int indent = item_depth_ - (pending_marker_ ? 1 : 0);
+        for (int d = 0; d < indent; ++d) out_->append("  ");
+    }
+
+    // Emits pending separators and opening markers ahead of new output.
+    void Flush() {
+        if (started_) {
+            if (pending_break_ > 0) {
+                for (int k = 0; k < pending_break_; ++k) {
+                    out_->push_back('\n');
+                    AppendLinePrefix(k + 1 < pending_break_);
+                }
+            } else if (pending_space_) {
+                out_->push_back(' ');
+            }
+        } else {
+            AppendLinePrefix(false);
+        }
+        out_->append(pending_open_);
+        pending_open_.clear();
+        pending_marker_ = false;
+        pending_break_ = 0;
+        pending_space_ = false;
+        started_ = true;
+    }
+
+    void AppendEscaped(std::string_view run) {
+        if (code_depth_ > 0) {
+            out_->append(run);
+            return;
+        }
+        for (char c : run) {
+            if (c == '*' || c == '`' || c == '[' || c == ']' || c == '\\' || (c == '|' && cell_depth_ > 0)) {
+                out_->push_back('\\');
+            }
+            out_->push_back(c);
+        }
+    }
+
+    std::string* out_;
+    std::string pending_open_;
+    std::string fence_lang_;
+    std::vector<List> lists_;
+    std::vector<Table> tables_;
+    std::vector<std::string> links_;
+    int pending_break_ = 0;
+    int skip_depth_ = 0;
+    int pre_depth_ = 0;
+    int code_depth_ = 0;
+    int quote_depth_ = 0;
+    int line_quote_depth_ = 0;
+    int item_depth_ = 0;
+    int cell_depth_ = 0;
+    bool pending_space_ = false;
+    bool pending_marker_ = false;
+    bool pending_fence_ = false;
+    bool fence_open_ = false;
+    bool started_ = false;
+};
+
+// --- Metadata and batch extraction ---
+
+void CollapseWhitespace(std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    bool space = false;
+    for (char c : s) {
+        if (IsHtmlSpace(c)) {
+            space = !out.empty();
+            continue;
+        }
+        if (space) out.push_back(' ');
+        space = false;
+        out.push_back(c);
+    }
+    s.swap(out);
+}
+
+std::string AsciiLowered(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), AsciiLower);
+    return s;
+}
+
+// Pulls <title>, description, keywords/article:tag and the canonical URL.
+// Attributes are only parsed for <meta> and <link>, so riding along with the
+// content pass costs almost nothing.
+class MetadataCollector : public HtmlSink {
+public:
+    explicit MetadataCollector(HtmlMetadata* meta) : meta_(meta) {}
+
+    void Reset(HtmlMetadata* meta) {
+        meta_ = meta;
+        og_title_.clear();
+        in_title_ = false;
+        seen_title_ = false;
+    }
+
+    void OnText(std::string_view text) override {
+        if (in_title_ && meta_->title.size() < 1024) meta_->title.append(text);
+    }
+
+    void OnStartTag(const HtmlTag& tag) override {
+        if (tag.name == "title") {
+            in_title_ = !seen_title_;
+        } else if (tag.name == "meta") {
+            std::string key = AsciiLowered(tag.Attr("name"));
+            if (key.empty()) key = AsciiLowered(tag.Attr("property"));
+            if (key.empty()) return;
+
+            if (key == "description" || (key == "og:description" && meta_->description.empty())) {
+                meta_->description = tag.Attr("content");
+            } else if (key == "og:title") {
+                og_title_ = tag.Attr("content");
+            } else if (key == "keywords" || key == "article:tag") {
+                const std::string content = tag.Attr("content");
+                size_t start = 0;
+                while (start <= content.size()) {
+                    size_t comma = content.find(',', start);
+                    if (comma == std::string::npos) comma = content.size();
+                    std::string keyword = content.substr(start, comma - start);
+                    CollapseWhitespace(keyword);
+                    if (!keyword.empty()) meta_->tags.push_back(std::move(keyword));
+                    start = comma + 1;
+                }
+            }
+        } else if (tag.name == "link" && meta_->canonical.empty()) {
+            if (AsciiLowered(tag.Attr("rel")).find("canonical") != std::string::npos) {
+                meta_->canonical = tag.Attr("href");
+            }
+        }
+    }
+
+    void OnEndTag(std::string_view name) override {
+        if (name == "title" && in_title_) {
+            in_title_ = false;
+            seen_title_ = true;
+        }
+    }
+
+    void Finish() {
+        if (meta_->title.empty()) meta_->title = og_title_;
+        CollapseWhitespace(meta_->title);
+        CollapseWhitespace(meta_->description);
+    }
+
+private:
+    HtmlMetadata* meta_;
+    std::string og_title_;
+    bool in_title_ = false;
+    bool seen_title_ = false;
+};
+
+// Fans tokenizer events out to two sinks so content and metadata come out of
+// a single pass.
+class TeeSink : public HtmlSink {
+public:
+    TeeSink(HtmlSink* first, HtmlSink* second) : first_(first), second_(second) {}
+    void OnText(std::string_view text) override {
+        first_->OnText(text);
+        second_->OnText(text);
+    }
+    void OnStartTag(const HtmlTag& tag) override {
+        first_->OnStartTag(tag);
+        second_->OnStartTag(tag);
+    }
+    void OnEndTag(std::string_view name) override {
+        first_->OnEndTag(name);
+        second_->OnEndTag(name);
+    }
+
+private:
+    HtmlSink* first_;
+    HtmlSink* second_;
+};
+
+Napi::Object MetadataToObject(Napi::Env env, const HtmlMetadata& meta) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("title", Napi::String::New(env, meta.title));
+    result.Set("description", Napi::String::New(env, meta.description));
+    result.Set("canonical", Napi::String::New(env, meta.canonical));
+    Napi::Array tags = Napi::Array::New(env, meta.tags.size());
+    for (size_t i = 0; i < meta.tags.size(); ++i) {
+        tags[static_cast<uint32_t>(i)] = Napi::String::New(env, meta.tags[i]);
+    }
+    result.Set("tags", tags);
+    return result;
+}
+
+// Per-thread tokenizer state for batch extraction. Pool threads are long
+// lived, so buffers grown by one document are reused by every later one.
+struct BatchScratch {
+    std::string decoded; // Buffer input transcoded to UTF-8
+    std::string text;
+    TextCollector collector{&text, false};
+    MetadataCollector metadata{nullptr};
+    TeeSink content_tee{&collector, &metadata};
+    HtmlTokenizer content_tokenizer{&content_tee};
+
+    DomArena dom;
+    TeeSink dom_tee{&dom, &metadata};
+    HtmlTokenizer dom_tokenizer{&dom_tee};
+};
+
+// Cleans and extracts metadata for many documents on the shared worker pool.
+// Strings are copied up front; Buffers are read in place (and transcoded on
+// the worker if they are not UTF-8), kept alive by a reference to the input
+// array until the promise settles.
+class BatchExtractWorker : public Napi::AsyncWorker {
+public:
+    BatchExtractWorker(Napi::Env env, Napi::Array inputs, bool main_content, bool block_breaks)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          main_content_(main_content),
+          block_breaks_(block_breaks) {
+        // Buffers are copied like strings: the caller may replace array
+        // elements or detach an ArrayBuffer while the workers are reading.
+        const uint32_t count = inputs.Length();
+        docs_.resize(count);
+        is_buffer_.resize(count);
+        texts_.resize(count);
+        metas_.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            Napi::Value value = inputs.Get(i);
+            if (value.IsBuffer()) {
+                Napi::Buffer<char> buffer = value.As<Napi::Buffer<char>>();
+                docs_[i].assign(buffer.Data(), buffer.Length());
+                is_buffer_[i] = true;
+            } else {
+                docs_[i] = value.As<Napi::String>().Utf8Value();
+            }
+        }
+    }
+
+    Napi::Promise GetPromise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::mutex error_mutex;
+        std::string error;
+
+        WorkerPool::Shared().ParallelFor(docs_.size(), [&](size_t i) {
+            thread_local BatchScratch scratch;
+            try {
+                std::string_view doc = docs_[i];
+                if (is_buffer_[i]) {
+                    size_t bom = 0;
+                    const Charset charset = HtmlIngestor::SniffCharset(doc, &bom);
+                    doc.remove_prefix(bom);
+                    if (charset != Charset::Utf8) {
+                        scratch.decoded.clear();
+                        Utf8Transcoder decoder(charset);
+                        decoder.Append(doc, &scratch.decoded);
+                        decoder.Finish(&scratch.decoded);
+                        doc = scratch.decoded;
+                    }
+                }
+
+                scratch.text.clear();
+                scratch.metadata.Reset(&metas_[i]);
+                if (main_content_) {
+                    scratch.dom.Reset();
+                    scratch.dom_tokenizer.Feed(doc);
+                    scratch.dom_tokenizer.Finish();
+                    TextCollector collector(&scratch.text, block_breaks_);
+                    if (!scratch.dom.EmitMainContent(collector)) scratch.dom.EmitAll(collector);
+                } else {
+                    scratch.collector.Reset();
+                    scratch.content_tokenizer.Feed(doc);
+                    scratch.content_tokenizer.Finish();
+                }
+                scratch.metadata.Finish();
+                texts_[i] = scratch.text; // exact-size copy; scratch keeps its capacity
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (error.empty()) error = "Document " + std::to_string(i) + ": " + e.what();
+            }
+        });
+
+        if (!error.empty()) SetError(error);
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::HandleScope scope(env);
+
+        Napi::Array contents = Napi::Array::New(env, texts_.size());
+        Napi::Array metadata = Napi::Array::New(env, metas_.size());
+        for (size_t i = 0; i < texts_.size(); ++i) {
+            contents[static_cast<uint32_t>(i)] = Napi::String::New(env, texts_[i]);
+            metadata[static_cast<uint32_t>(i)] = MetadataToObject(env, metas_[i]);
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("contents", contents);
+        result.Set("metadata", metadata);
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& e) override {
+        deferred_.Reject(e.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<std::string> docs_;
+    std::vector<bool> is_buffer_;
+    std::vector<std::string> texts_;
+    std::vector<HtmlMetadata> metas_;
+    bool main_content_;
+    bool block_breaks_;
+};
+
+// --- Hyperlink extraction ---
+
+bool HasUrlScheme(std::string_view url) {
+    if (url.empty() || !IsAsciiAlpha(url[0])) return false;
+    for (size_t i = 1; i < url.size(); ++i) {
+        const char c = url[i];
+        if (c == ':') return true;
+        if (!IsAsciiAlnum(c) && c != '+' && c != '-' && c != '.') return false;
+    }
+    return false;
+}
+
+// Collapses "." and ".." segments of an absolute path.
+std::string RemoveDotSegments(std::string_view path) {
+    std::vector<std::string_view> segments;
+    size_t pos = 1;
+    while (pos <= path.size()) {
+        size_t slash = path.find('/', pos);
+        if (slash == std::string_view::npos) slash = path.size();
+        std::string_view segment = path.substr(pos, slash - pos);
+        const bool last = slash == path.size();
+        if (segment == "..") {
+            if (!segments.empty()) segments.pop_back();
+            if (last) segments.emplace_back();
+        } else if (segment == ".") {
+            if (last) segments.emplace_back();
+        } else {
+            segments.push_back(segment);
+        }
+        pos = slash + 1;
+    }
+    std::string out;
+    for (std::string_view segment : segments) {
+        out.push_back('/');
+        out.append(segment);
+    }
+    return out.empty() ? "/" : out;
+}
+
+// RFC 3986 reference resolution, reduced to what hrefs in the wild need.
+// Without a usable base the href is returned untouched.
+std::string ResolveUrl(std::string_view base, std::string_view href) {
+    if (HasUrlScheme(href) || !HasUrlScheme(base)) return std::string(href);
+
+    const size_t scheme_end = base.find(':');
+    if (href.substr(0, 2) == "//") return std::string(base.substr(0, scheme_end + 1)).append(href);
+
+    size_t path_start = scheme_end + 1;
+    if (base.substr(path_start, 2) == "//") {
+        path_start = base.find_first_of("/?#", path_start + 2);
+        if (path_start == std::string_view::npos) path_start = base.size();
+    }
+    const std::string_view authority = base.substr(0, path_start);
+    std::string_view base_path = base.substr(path_start);
+    base_path = base_path.substr(0, base_path.find_first_of("?#"));
+
+    if (href.empty() || href[0] == '#' || href[0] == '?') {
+        const size_t cut = href.empty() || href[0] == '#'
+            ? base.find('#')
+            : path_start + base_path.size();
+        return std::string(base.substr(0, cut)).append(href);
+    }
+
+    const size_t suffix = href.find_first_of("?#");
+    const std::string_view href_path = href.substr(0, suffix);
+    const std::string_view href_rest = suffix == std::string_view::npos ? std::string_view() : href.substr(suffix);
+
+    std::string path;
+    if (href_path[0] == '/') {
+        path = std::string(href_path);
+    } else {
+        const size_t dir = base_path.rfind('/');
+        path = dir == std::string_view::npos ? "/" : std::string(base_path.substr(0, dir + 1));
+        path.append(href_path);
+    }
+    return std::string(authority).append(RemoveDotSegments(path)).append(href_rest);
+}
+
+// Rides along with the cleaning pass and records each <a href> together with
+// the byte span its anchor text occupies in the cleaned output.
+class LinkCollector : public HtmlSink {
+public:
+    LinkCollector(std::string* out, std::string_view base_url, std::vector<HtmlLink>* links)
+        : out_(out), text_(out, false), base_(base_url), links_(links) {}
+
+    void OnText(std::string_view text) override { text_.OnText(text); }
+
+    void OnStartTag(const HtmlTag& tag) override {
+        text_.OnStartTag(tag);
+        if (tag.name == "base" && !base_overridden_) {
+            const std::string href = tag.Attr("href");
+            if (!href.empty()) {
+                base_ = ResolveUrl(base_, href);
+                base_overridden_ = true;
+            }
+        } else if (tag.name == "a") {
+            CloseLink(); // <a> cannot nest; a new one closes the previous
+            std::string href = tag.Attr("href");
+            const size_t first = href.find_first_not_of(" \t\n\r\f");
+            if (first == std::string::npos || href[first] == '#') return;
+            href.erase(0, first);
+            href.erase(href.find_last_not_of(" \t\n\r\f") + 1);
+            if (EqualsIgnoreCase(std::string_view(href).substr(0, 11), "javascript:")) return;
+
+            open_ = true;
+            links_->push_back(HtmlLink{ResolveUrl(base_, href), out_->size(), out_->size()});
+        }
+    }
+
+    void OnEndTag(std::string_view name) override {
+        text_.OnEndTag(name);
+        if (name == "a") CloseLink();
+    }
+
+    void Finish() { CloseLink(); }
+
+private:
+    void CloseLink() {
+        if (!open_) return;
+        open_ = false;
+        HtmlLink& link = links_->back();
+        link.end = out_->size();
+        // Separators are written lazily, so any whitespace right after the
+        // recorded start belongs to the boundary before the anchor text.
+        while (link.start < link.end && IsHtmlSpace((*out_)[link.start])) ++link.start;
+    }
+
+    std::string* out_;
+    TextCollector text_;
+    std::string base_;
+    std::vector<HtmlLink>* links_;
+    bool base_overridden_ = false;
+    bool open_ = false;
+};
+
+// Rewrites ascending UTF-8 byte offsets into UTF-16 code unit offsets so the
+// spans index the JS string directly.
+uint32_t Utf16Advance(std::string_view text, size_t& byte_pos, size_t target, uint32_t units) {
+    while (byte_pos < target) {
+        const unsigned char c = static_cast<unsigned char>(text[byte_pos]);
+        if (c < 0x80) { byte_pos += 1; units += 1; }
+        else if (c < 0xE0) { byte_pos += 2; units += 1; }
+        else if (c < 0xF0) { byte_pos += 3; units += 1; }
+        else { byte_pos += 4; units += 2; }
+    }
+    return units;
+}
+
+// --- Charset sniffing ---
+
+// Pulls the charset out of an http-equiv content value such as
+// "text/html; charset=ISO-8859-1".
+std::string CharsetFromContentType(std::string_view content) {
+    for (size_t pos = 0; pos + 7 <= content.size(); ++pos) {
+        if (!EqualsIgnoreCase(content.substr(pos, 7), "charset")) continue;
+        size_t i = pos + 7;
+        while (i < content.size() && IsHtmlSpace(content[i])) ++i;
+        if (i >= content.size() || content[i] != '=') continue;
+        ++i;
+        while (i < content.size() && IsHtmlSpace(content[i])) ++i;
+        if (i < content.size() && (content[i] == '"' || content[i] == '\'')) {
+            const size_t close = content.find(content[i], i + 1);
+            if (close == std::string_view::npos) return std::string();
+            return std::string(content.substr(i + 1, close - i - 1));
+        }
+        size_t end = i;
+        while (end < content.size() && content[end] != ';' && !IsHtmlSpace(content[end])) ++end;
+        return std::string(content.substr(i, end - i));
+    }
+    return std::string();
+}
+
+// Looks for <meta charset> or <meta http-equiv="content-type"> in the first
+// 1024 bytes, as browsers do before they start tokenizing.
+bool PrescanMetaCharset(std::string_view bytes, Charset* charset) {
+    bytes = bytes.substr(0, kCharsetPrescanBytes);
+    size_t i = 0;
+    while ((i = bytes.find('<', i)) != std::string_view::npos) {
+        if (bytes.compare(i, 4, "<!--") == 0) {
+            const size_t end = bytes.find("-->", i + 4);
+            if (end == std::string_view::npos) return false;
+            i = end + 3;
+            continue;
+        }
+        if (i + 6 <= bytes.size() && EqualsIgnoreCase(bytes.substr(i + 1, 4), "meta") &&
+            (IsHtmlSpace(bytes[i + 5]) || bytes[i + 5] == '/')) {
+            size_t end = bytes.find('>', i + 5);
+            if (end == std::string_view::npos) end = bytes.size();
+
+            HtmlTag tag;
+            tag.name = "meta";
+            tag.raw_attrs = bytes.substr(i + 5, end - i - 5);
+            std::string label = tag.Attr("charset");
+            if (label.empty() && EqualsIgnoreCase(tag.Attr("http-equiv"), "content-type")) {
+                label = CharsetFromContentType(tag.Attr("content"));
+            }
+            if (!label.empty() && CharsetFromLabel(label, charset)) {
+                // A declaration readable as ASCII cannot be UTF-16
+                if (*charset == Charset::Utf16LE || *charset == Charset::Utf16BE) *charset = Charset::Utf8;
+                return true;
+            }
+            i = end;
+            continue;
+        }
+        ++i;
+    }
+    return false;
+}
+
+// Whether the head of a streamed document is enough to pick its charset: a
+// BOM, a complete <meta> declaration, a whole non-ASCII sequence to validate,
+// or all the bytes the prescan would look at.
+bool CharsetSettled(std::string_view head) {
+    if (head.size() >= kCharsetPrescanBytes) return true;
+    Charset charset;
+    if (DetectBom(head, &charset) > 0) return true;
+    const size_t closed = head.rfind('>');
+    if (closed != std::string_view::npos && PrescanMetaCharset(head.substr(0, closed + 1), &charset)) return true;
+    for (size_t i = 0; i < head.size(); ++i) {
+        if (static_cast<unsigned char>(head[i]) >= 0x80) return head.size() >= i + 4;
+    }
+    return false;
+}
+
+// Reads argument `index` as HTML text: strings are already UTF-8, Buffers are
+// sniffed and transcoded. Returns false with a TypeError pending otherwise.
+bool ReadHtmlArg(const Napi::CallbackInfo& info, size_t index, std::string* html) {
+    if (info.Length() > index && info[index].IsString()) {
+        *html = info[index].As<Napi::String>().Utf8Value();
+        return true;
+    }
+    if (info.Length() > index && info[index].IsBuffer()) {
+        Napi::Buffer<char> buffer = info[index].As<Napi::Buffer<char>>();
+        *html = HtmlIngestor::DecodeHtml(std::string_view(buffer.Data(), buffer.Length()));
+        return true;
+    }
+    Napi::TypeError::New(info.Env(), "String or Buffer expected").ThrowAsJavaScriptException();
+    return false;
+}
+
+} // namespace
+
+// --- HtmlTag ---
+
+std::string HtmlTag::Attr(std::string_view key) const {
+    std::string result;
+    ForEachAttr(raw_attrs, [&](std::string_view name, std::string_view value) {
+        if (!EqualsIgnoreCase(name, key)) return false;
+        result = HtmlIngestor::DecodeEntities(value);
+        return true;
+    });
+    return result;
+}
+
+bool HtmlTag::HasAttr(std::string_view key) const {
+    bool found = false;
+    ForEachAttr(raw_attrs, [&](std::string_view name, std::string_view) {
+        found = EqualsIgnoreCase(name, key);
+        return found;
+    });
+    return found;
+}
+
+// --- HtmlTokenizer ---
+
+void HtmlTokenizer::Feed(std::string_view chunk) {
+    const char* p = chunk.data();
+    const char* const end = p + chunk.size();
+
+    while (p < end) {
+        switch (state_) {
+        case State::Data: {
+            const char* q = p;
+            while (q < end && *q != '<' && *q != '&') ++q;
+            if (q > p) sink_->OnText(std::string_view(p, static_cast<size_t>(q - p)));
+            if (q == end) return;
+            state_ = (*q == '<') ? State::TagOpen : State::Entity;
+            buf_.clear();
+            p = q + 1;
+            break;
+        }
+        case State::TagOpen: {
+            // '<' only opens markup when followed by a name, '/', '!' or '?'
+            const char c = *p;
+            if (IsAsciiAlpha(c) || c == '/' || c == '!' || c == '?') {
+                state_ = State::Tag;
+                quote_ = 0;
+                prev_sig_ = 0;
+            } else {
+                sink_->OnText("<");
+                state_ = State::Data;
+            }
+            break;
+        }
+        case State::Tag: {
+            while (p < end) {
+                const char c = *p++;
+                if (quote_) {
+                    if (c == quote_) quote_ = 0;
+                } else if (c == '>') {
+                    EmitTag();
+                    break;
+                } else if ((c == '"' || c == '\'') && prev_sig_ == '=') {
+                    quote_ = c;
+                }
+                if (!IsHtmlSpace(c)) prev_sig_ = c;
+                if (buf_.size() < kMaxTagBytes) buf_.push_back(c);
+                if (buf_.size() == 3 && buf_[0] == '!' && buf_[1] == '-' && buf_[2] == '-') {
+                    state_ = State::Comment;
+                    dashes_ = 0;
+                    break;
+                }
+            }
+            break;
+        }
+        case State::Comment: {
+            while (p < end) {
+                const char c = *p++;
+                if (c == '>' && dashes_ >= 2) {
+                    state_ = State::Data;
+                    break;
+                }
+                dashes_ = (c == '-') ? dashes_ + 1 : 0;
+            }
+            break;
+        }
+        case State::RawText: {
+            while (p < end) {
+                if (raw_match_ == 0) {
+                    const void* lt = std::memchr(p, '<', static_cast<size_t>(end - p));
+                    if (!lt) {
+                        p = end;
+                        break;
+                    }
+                    p = static_cast<const char*>(lt) + 1;
+                    raw_match_ = 1;
+                    continue;
+                }
+                const char c = AsciiLower(*p++);
+                if (c == raw_close_[raw_match_]) {
+                    if (++raw_match_ == raw_close_.size()) {
+                        // Let the tag state consume the rest of "</script ...>"
+                        buf_.assign(raw_close_, 1, std::string::npos);
+                        state_ = State::Tag;
+                        quote_ = 0;
+                        prev_sig_ = buf_.back();
+                        raw_match_ = 0;
+                        break;
+                    }
+                } else {
+                    raw_match_ = (c == '<') ? 1 : 0;
+                }
+            }
+            break;
+        }
+        case State::Entity: {
+            while (p < end) {
+                const char c = *p;
+                if (c == ';') {
+                    ++p;
+                    EmitEntity(true);
+                    break;
+                }
+                if ((IsAsciiAlnum(c) || (c == '#' && buf_.empty())) && buf_.size() < kMaxEntityBytes) {
+                    buf_.push_back(c);
+                    ++p;
+                    continue;
+                }
+                EmitEntity(false); // `c` is reprocessed by the data state
+                break;
+            }
+            break;
+        }
+        }
+    }
+}
+
+void HtmlTokenizer::Finish() {
+    if (state_ == State::Entity) {
+        EmitEntity(false);
+    } else if (state_ == State::TagOpen) {
+        sink_->OnText("<");
+    }
+    Reset();
+}
+
+void HtmlTokenizer::Reset() {
+    state_ = State::Data;
+    buf_.clear();
+    raw_match_ = 0;
+    dashes_ = 0;
+    quote_ = 0;
+    prev_sig_ = 0;
+}
+
+void HtmlTokenizer::EmitEntity(bool terminated) {
+    state_ = State::Data;
+    std::string decoded;
+    if (terminated && DecodeEntity(buf_, decoded)) {
+        sink_->OnText(decoded);
+        return;
+    }
+    decoded.reserve(buf_.size() + 2);
+    decoded.push_back('&');
+    decoded.append(buf_);
+    if (terminated) decoded.push_back(';');
+    sink_->OnText(decoded);
+}
+
+void HtmlTokenizer::EmitTag() {
+    state_ = State::Data;
+    // Doctype, CDATA and processing instructions carry no content
+    if (buf_.empty() || buf_[0] == '!' || buf_[0] == '?') return;
+
+    const bool closing = buf_[0] == '/';
+    size_t i = closing ? 1 : 0;
+    name_.clear();
+    while (i < buf_.size() && !IsHtmlSpace(buf_[i]) && buf_[i] != '/') {
+        name_.push_back(AsciiLower(buf_[i++]));
+    }
+    if (name_.empty()) return;
+
+    if (closing) {
+        sink_->OnEndTag(name_);
+        return;
+    }
+
+    size_t attrs_end = buf_.size();
+    HtmlTag tag;
+    if (attrs_end > i && buf_[attrs_end - 1] == '/') {
+        tag.self_closing = true;
+        --attrs_end;
+    }
+    tag.name = name_;
+    tag.raw_attrs = std::string_view(buf_).substr(i, attrs_end - i);
+    sink_->OnStartTag(tag);
+
+    if (!tag.self_closing && (name_ == "script" || name_ == "style")) {
+        raw_close_.assign("</");
+        raw_close_.append(name_);
+        raw_match_ = 0;
+        state_ = State::RawText;
+    }
+}
+
+// --- HtmlIngestor ---
+
+struct HtmlIngestor::Stream {
+    Stream(bool block_breaks, size_t max_chunk_size)
+        : collector(&text, block_breaks), tokenizer(&collector), atomizer(max_chunk_size) {}
+
+    // Feeds raw bytes through the chosen transcoder
+    void FeedBytes(std::string_view bytes) {
+        if (decoder->charset() == Charset::Utf8) {
+            tokenizer.Feed(bytes);
+            return;
+        }
+        decoded.clear();
+        decoder->Append(bytes, &decoded);
+        tokenizer.Feed(decoded);
+    }
+
+    // Picks the transcoder from the held-back head and feeds the head
+    void StartDecoding() {
+        size_t bom = 0;
+        decoder = std::make_unique<Utf8Transcoder>(SniffCharset(head, &bom));
+        FeedBytes(std::string_view(head).substr(bom));
+        std::string().swap(head);
+    }
+
+    std::string text; // cleaned text not yet handed back to JS
+    std::string head; // leading Buffer bytes held until the charset is known
+    std::unique_ptr<Utf8Transcoder> decoder;
+    std::string decoded;
+    TextCollector collector;
+    HtmlTokenizer tokenizer;
+    StreamAtomizer atomizer;
+};
+
 // Initialize the class and export it to Node.js
 Napi::Object HtmlIngestor::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "HtmlIngestor", {
         InstanceMethod("extractContent", &HtmlIngestor::ExtractContent),
-        InstanceMethod("extractMetadata", &HtmlIngestor::ExtractMetadata)
+        InstanceMethod("extractMetadata", &HtmlIngestor::ExtractMetadata),
+        InstanceMethod("extractMainContent", &HtmlIngestor::ExtractMainContent),
+        InstanceMethod("toMarkdown", &HtmlIngestor::ToMarkdown),
+        InstanceMethod("extractBatchAsync", &HtmlIngestor::ExtractBatchAsync),
+        InstanceMethod("extractLinks", &HtmlIngestor::ExtractLinks),
+        InstanceMethod("detectCharset", &HtmlIngestor::DetectCharset),
+        InstanceMethod("push", &HtmlIngestor::Push),
+        InstanceMethod("finish", &HtmlIngestor::Finish)
     });
 
     constructor = Napi::Persistent(func);
@@ -22,21 +1730,33 @@ Napi::Object HtmlIngestor::Init(Napi::Env env, Napi::Object exports) {
 
 Napi::FunctionReference HtmlIngestor::constructor;
 
-// Constructor
+// Constructor: new HtmlIngestor({ atomize?, maxChunkSize?, blockBreaks? })
+// atomize/maxChunkSize apply to streaming mode; blockBreaks also shapes
+// extractMainContent output.
 HtmlIngestor::HtmlIngestor(const Napi::CallbackInfo& info) : Napi::ObjectWrap<HtmlIngestor>(info) {
-    // Constructor implementation if needed
+    if (info.Length() < 1 || !info[0].IsObject()) return;
+
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (options.Has("atomize")) {
+        atomize_ = options.Get("atomize").ToBoolean().As<Napi::Boolean>().Value();
+    }
+    if (options.Has("blockBreaks")) {
+        block_breaks_ = options.Get("blockBreaks").ToBoolean().As<Napi::Boolean>().Value();
+    }
+    if (options.Has("maxChunkSize") && options.Get("maxChunkSize").IsNumber()) {
+        const int64_t size = options.Get("maxChunkSize").As<Napi::Number>().Int64Value();
+        if (size > 0) max_chunk_size_ = static_cast<size_t>(size);
+    }
 }
 
+HtmlIngestor::~HtmlIngestor() = default;
+
 // Extract content from HTML
 Napi::Value HtmlIngestor::ExtractContent(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (info.Length() < 1 || !info[0].IsString()) {
-        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
-        return Napi::String::New(env, "");
-    }
-
-    std::string html = info[0].As<Napi::String>().Utf8Value();
+    std::string html;
+    if (!ReadHtmlArg(info, 0, &html)) return Napi::String::New(env, "");
     std::string cleanContent = CleanHtml(html);
 
     return Napi::String::New(env, cleanContent);
@@ -46,150 +1766,328 @@ Napi::Value HtmlIngestor::ExtractContent(const Napi::CallbackInfo& info) {
 Napi::Value HtmlIngestor::ExtractMetadata(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    if (info.Length() < 1 || !info[0].IsString()) {
-        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
-        return Napi::Object::New(env);
+    std::string html;
+    if (!ReadHtmlArg(info, 0, &html)) return Napi::Object::New(env);
+    return MetadataToObject(env, ParseMetadata(html));
+}
+
+// extractLinks(html, baseUrl?) -> { content, targets, anchors, spans }
+// `content` equals extractContent(html). targets[i] is the resolved href of
+// the i-th link and spans[2i]..spans[2i+1] the range of its anchor text in
+// `content`, so targets can go straight to batchWriteEdges.
+Napi::Value HtmlIngestor::ExtractLinks(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string html;
+    if (!ReadHtmlArg(info, 0, &html)) return env.Null();
+    std::string base_url;
+    if (info.Length() > 1 && info[1].IsString()) {
+        base_url = info[1].As<Napi::String>().Utf8Value();
     }
 
-    std::string html = info[0].As<Napi::String>().Utf8Value();
+    std::string content;
+    std::vector<HtmlLink> links = CollectLinks(html, base_url, &content);
+
+    Napi::Array targets = Napi::Array::New(env, links.size());
+    Napi::Array anchors = Napi::Array::New(env, links.size());
+    Napi::Uint32Array spans = Napi::Uint32Array::New(env, links.size() * 2);
+    size_t byte_pos = 0;
+    uint32_t units = 0;
+    for (size_t i = 0; i < links.size(); ++i) {
+        const HtmlLink& link = links[i];
+        targets[static_cast<uint32_t>(i)] = Napi::String::New(env, link.href);
+        anchors[static_cast<uint32_t>(i)] = Napi::String::New(env, content.data() + link.start, link.end - link.start);
+        units = Utf16Advance(content, byte_pos, link.start, units);
+        spans[i * 2] = units;
+        units = Utf16Advance(content, byte_pos, link.end, units);
+        spans[i * 2 + 1] = units;
+    }
 
-    // Create a result object
     Napi::Object result = Napi::Object::New(env);
+    result.Set("content", Napi::String::New(env, content));
+    result.Set("targets", targets);
+    result.Set("anchors", anchors);
+    result.Set("spans", spans);
+    return result;
+}
 
-    // For now, just return a basic structure
-    // In a full implementation, this would extract title, meta tags, etc.
-    result.Set("title", Napi::String::New(env, ""));
-    result.Set("description", Napi::String::New(env, ""));
-    result.Set("tags", Napi::Array::New(env));
+// detectCharset(buffer) -> WHATWG name of the encoding the Buffer will be
+// decoded with (BOM, then <meta> declaration, then a UTF-8 validity check).
+Napi::Value HtmlIngestor::DetectCharset(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
 
-    return result;
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+        Napi::TypeError::New(env, "Buffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+    size_t bom = 0;
+    return Napi::String::New(env, CharsetName(SniffCharset(std::string_view(buffer.Data(), buffer.Length()), &bom)));
 }
 
-// Internal helper to clean HTML
-std::string HtmlIngestor::CleanHtml(const std::string& raw_html) {
-    std::string clean;
-    clean.reserve(raw_html.length()); // Reserve space for efficiency
-
-    bool in_script = false;
-    bool in_style = false;
-    bool in_tag = false;
-
-    for (size_t i = 0; i < raw_html.length(); ++i) {
-        char c = raw_html[i];
-
-        if (c == '<') {
-            // Check for script or style tags
-            if (i + 6 < raw_html.length() &&
-                (raw_html.substr(i, 7) == "<script" ||
-                 raw_html.substr(i, 7) == "<SCRIPT" ||
-                 (i + 7 < raw_html.length() && raw_html.substr(i, 8) == "<script " && std::isspace(static_cast<unsigned char>(raw_html[i+7]))) ||
-                 (i + 7 < raw_html.length() && raw_html.substr(i, 8) == "<SCRIPT " && std::isspace(static_cast<unsigned char>(raw_html[i+7]))))) {
-                in_script = true;
-            } else if (i + 5 < raw_html.length() &&
-                      (raw_html.substr(i, 6) == "<style" ||
-                       raw_html.substr(i, 6) == "<STYLE" ||
-                       (i + 6 < raw_html.length() && raw_html.substr(i, 7) == "<style " && std::isspace(static_cast<unsigned char>(raw_html[i+6]))) ||
-                       (i + 6 < raw_html.length() && raw_html.substr(i, 7) == "<STYLE " && std::isspace(static_cast<unsigned char>(raw_html[i+6]))))) {
-                in_style = true;
-            }
-
-            in_tag = true;
-            continue;
-        }
+// extractBatchAsync(docs, { mainContent? }) -> Promise<{ contents, metadata }>
+// Documents (strings or Buffers) are processed on the native worker pool;
+// both result arrays follow input order.
+Napi::Value HtmlIngestor::ExtractBatchAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
 
-        if (c == '>') {
-            in_tag = false;
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Array of strings or Buffers expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
 
-            // Check if this is a closing script or style tag
-            if (in_script && i + 8 < raw_html.length()) {
-                // Look back to see if we just closed a script tag
-                size_t pos = i;
-                while (pos > 0 && raw_html[pos] != '<') pos--;
-                if (pos > 0 && (raw_html.substr(pos, 9) == "</script>" || raw_html.substr(pos, 9) == "</SCRIPT>")) {
-                    in_script = false;
-                }
-            } else if (in_style && i + 7 < raw_html.length()) {
-                // Look back to see if we just closed a style tag
-                size_t pos = i;
-                while (pos > 0 && raw_html[pos] != '<') pos--;
-                if (pos > 0 && (raw_html.substr(pos, 8) == "</style>" || raw_html.substr(pos, 8) == "</STYLE>")) {
-                    in_style = false;
-                }
-            }
-            continue;
+    Napi::Array inputs = info[0].As<Napi::Array>();
+    for (uint32_t i = 0; i < inputs.Length(); ++i) {
+        Napi::Value value = inputs.Get(i);
+        if (!value.IsBuffer() && !value.IsString()) {
+            Napi::TypeError::New(env, "Element " + std::to_string(i) + " is not a string or Buffer").ThrowAsJavaScriptException();
+            return env.Undefined();
         }
+    }
 
-        // Skip content inside script or style tags
-        if (in_script || in_style) {
-            continue;
+    bool main_content = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("mainContent")) {
+            main_content = options.Get("mainContent").ToBoolean().As<Napi::Boolean>().Value();
         }
+    }
 
-        // If we're in a tag, skip it
-        if (in_tag) {
-            continue;
-        }
+    auto* worker = new BatchExtractWorker(env, inputs, main_content, block_breaks_);
+    Napi::Promise promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+}
 
-        // Preserve newlines
-        if (c == '\n' || c == '\r') {
-            if (clean.empty() || clean.back() != '\n') {
-                clean += '\n';
-            }
-            continue;
-        }
+// Extract only the main content subtree, dropping navigation, footers,
+// sidebars, cookie banners and other boilerplate.
+Napi::Value HtmlIngestor::ExtractMainContent(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
 
-        // Convert HTML entities
-        if (c == '&' && i + 1 < raw_html.length()) {
-            // Look for common HTML entities
-            if (i + 4 < raw_html.length() && raw_html.substr(i, 5) == "&amp;") {
-                clean += '&';
-                i += 4; // Skip the rest of the entity
-                continue;
-            } else if (i + 5 < raw_html.length() && raw_html.substr(i, 6) == "&lt;") {
-                clean += '<';
-                i += 3;
-                continue;
-            } else if (i + 5 < raw_html.length() && raw_html.substr(i, 6) == "&gt;") {
-                clean += '>';
-                i += 3;
-                continue;
-            } else if (i + 5 < raw_html.length() && raw_html.substr(i, 6) == "&quot;") {
-                clean += '"';
-                i += 5;
-                continue;
-            } else if (i + 4 < raw_html.length() && raw_html.substr(i, 5) == "&#39;") {
-                clean += '\'';
-                i += 4;
-                continue;
-            }
+    std::string html;
+    if (!ReadHtmlArg(info, 0, &html)) return Napi::String::New(env, "");
+    return Napi::String::New(env, ExtractMainText(html, block_breaks_));
+}
+
+// Convert HTML to Markdown: toMarkdown(html, { mainContent? })
+Napi::Value HtmlIngestor::ToMarkdown(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::string html;
+    if (!ReadHtmlArg(info, 0, &html)) return Napi::String::New(env, "");
+
+    bool main_content = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("mainContent")) {
+            main_content = options.Get("mainContent").ToBoolean().As<Napi::Boolean>().Value();
         }
+    }
+
+    return Napi::String::New(env, HtmlToMarkdown(html, main_content));
+}
+
+// Feed the next slice of a document. Accepts a string or a Buffer; Buffers
+// may split characters or tags at any byte. Leading Buffer bytes are held
+// back until the charset can be sniffed (see CharsetSettled), then the whole
+// stream is transcoded to match.
+Napi::Value HtmlIngestor::Push(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
 
-        // Add character to clean content if it's not a tag character
-        clean += c;
+    if (info.Length() < 1 || (!info[0].IsBuffer() && !info[0].IsString())) {
+        Napi::TypeError::New(env, "String or Buffer expected").ThrowAsJavaScriptException();
+        return env.Undefined();
     }
 
-    // Normalize whitespace
-    std::string normalized;
-    normalized.reserve(clean.length());
-    bool last_was_space = false;
+    if (!stream_) stream_ = std::make_unique<Stream>(block_breaks_, max_chunk_size_);
+    Stream& stream = *stream_;
 
-    for (char c : clean) {
-        if (std::isspace(static_cast<unsigned char>(c))) {
-            if (!last_was_space) {
-                normalized += ' ';
-                last_was_space = true;
-            }
+    if (info[0].IsString()) {
+        if (!stream.head.empty()) stream.StartDecoding();
+        stream.tokenizer.Feed(info[0].As<Napi::String>().Utf8Value());
+        return StreamResult(env, false);
+    }
+
+    Napi::Buffer<char> buffer = info[0].As<Napi::Buffer<char>>();
+    const std::string_view chunk(buffer.Data(), buffer.Length());
+    if (stream.decoder) {
+        stream.FeedBytes(chunk);
+    } else {
+        stream.head.append(chunk);
+        if (CharsetSettled(stream.head)) stream.StartDecoding();
+    }
+    return StreamResult(env, false);
+}
+
+// Flush whatever the stream still holds and reset it for the next document.
+Napi::Value HtmlIngestor::Finish(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!stream_) {
+        if (atomize_) return Napi::Array::New(env);
+        return Napi::String::New(env, "");
+    }
+
+    if (!stream_->head.empty()) stream_->StartDecoding();
+    if (stream_->decoder) {
+        stream_->decoded.clear();
+        stream_->decoder->Finish(&stream_->decoded);
+        stream_->tokenizer.Feed(stream_->decoded);
+    }
+    stream_->tokenizer.Finish();
+    Napi::Value result = StreamResult(env, true);
+    stream_.reset();
+    return result;
+}
+
+// Hands the completed part of the stream to JS: a string in text mode, an
+// array of atoms when atomizing.
+Napi::Value HtmlIngestor::StreamResult(Napi::Env env, bool final) {
+    Stream& stream = *stream_;
+    const size_t ready = final ? stream.text.size() : Utf8CompleteLength(stream.text);
+
+    if (!atomize_) {
+        Napi::String result = Napi::String::New(env, stream.text.data(), ready);
+        stream.text.erase(0, ready);
+        return result;
+    }
+
+    std::vector<std::string> atoms;
+    stream.atomizer.Append(std::string_view(stream.text.data(), ready), atoms);
+    stream.text.erase(0, ready);
+    if (final) stream.atomizer.Flush(atoms);
+
+    Napi::Array result = Napi::Array::New(env, atoms.size());
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        result[static_cast<uint32_t>(i)] = Napi::String::New(env, atoms[i]);
+    }
+    return result;
+}
+
+// Internal helper to clean HTML
+std::string HtmlIngestor::CleanHtml(const std::string& raw_html) {
+    std::string clean;
+    clean.reserve(raw_html.length() / 2);
+
+    TextCollector collector(&clean, false);
+    HtmlTokenizer tokenizer(&collector);
+    tokenizer.Feed(raw_html);
+    tokenizer.Finish();
+
+    return clean;
+}
+
+// Readability-style extraction: one tokenizer pass builds the arena DOM,
+// then scoring picks the subtree that holds the article text.
+std::string HtmlIngestor::ExtractMainText(std::string_view html, bool block_breaks) {
+    DomArena dom;
+    HtmlTokenizer tokenizer(&dom);
+    tokenizer.Feed(html);
+    tokenizer.Finish();
+
+    std::string text;
+    TextCollector collector(&text, block_breaks);
+    if (!dom.EmitMainContent(collector)) dom.EmitAll(collector);
+    return text;
+}
+
+// Markdown straight off the tokenizer, or off the arena DOM when only the
+// main content subtree is wanted.
+std::string HtmlIngestor::HtmlToMarkdown(std::string_view html, bool main_content) {
+    std::string markdown;
+    markdown.reserve(html.size() / 2);
+    MarkdownWriter writer(&markdown);
+
+    if (main_content) {
+        DomArena dom;
+        HtmlTokenizer tokenizer(&dom);
+        tokenizer.Feed(html);
+        tokenizer.Finish();
+        if (!dom.EmitMainContent(writer)) dom.EmitAll(writer);
+    } else {
+        HtmlTokenizer tokenizer(&writer);
+        tokenizer.Feed(html);
+        tokenizer.Finish();
+    }
+
+    writer.Finish();
+    return markdown;
+}
+
+std::vector<HtmlLink> HtmlIngestor::CollectLinks(std::string_view html, std::string_view base_url, std::string* content) {
+    std::vector<HtmlLink> links;
+    content->reserve(html.size() / 2);
+    LinkCollector collector(content, base_url, &links);
+    HtmlTokenizer tokenizer(&collector);
+    tokenizer.Feed(html);
+    tokenizer.Finish();
+    collector.Finish();
+    return links;
+}
+
+// Undeclared documents that are not valid UTF-8 are almost always legacy
+// Windows-1252 exports, so that is the fallback.
+Charset HtmlIngestor::SniffCharset(std::string_view bytes, size_t* bom_length) {
+    Charset charset = Charset::Utf8;
+    *bom_length = DetectBom(bytes, &charset);
+    if (*bom_length > 0) return charset;
+    if (PrescanMetaCharset(bytes, &charset)) return charset;
+    return IsValidUtf8(bytes, true) ? Charset::Utf8 : Charset::Windows1252;
+}
+
+std::string HtmlIngestor::DecodeHtml(std::string_view bytes) {
+    size_t bom = 0;
+    const Charset charset = SniffCharset(bytes, &bom);
+    bytes.remove_prefix(bom);
+    if (charset == Charset::Utf8) return std::string(bytes);
+
+    std::string out;
+    Utf8Transcoder decoder(charset);
+    decoder.Append(bytes, &out);
+    decoder.Finish(&out);
+    return out;
+}
+
+HtmlMetadata HtmlIngestor::ParseMetadata(std::string_view html) {
+    HtmlMetadata meta;
+    MetadataCollector collector(&meta);
+    HtmlTokenizer tokenizer(&collector);
+    tokenizer.Feed(html);
+    tokenizer.Finish();
+    collector.Finish();
+    return meta;
+}
+
+// Decode character references in attribute values or other raw text
+std::string HtmlIngestor::DecodeEntities(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+
+    size_t i = 0;
+    while (i < text.size()) {
+        const size_t amp = text.find('&', i);
+        if (amp == std::string_view::npos) {
+            out.append(text.data() + i, text.size() - i);
+            break;
+        }
+        out.append(text.data() + i, amp - i);
+
+        const size_t semi = text.find(';', amp + 1);
+        if (semi != std::string_view::npos && semi - amp - 1 <= kMaxEntityBytes &&
+            DecodeEntity(text.substr(amp + 1, semi - amp - 1), out)) {
+            i = semi + 1;
         } else {
-            normalized += c;
-            last_was_space = false;
+            out.push_back('&');
+            i = amp + 1;
         }
     }
-
-    return normalized;
+    return out;
 }
 
 // Check if an element is a block-level element
-bool HtmlIngestor::IsBlockElement(const std::string& tag_name) {
-    static const std::unordered_set<std::string> block_elements = {
+bool HtmlIngestor::IsBlockElement(std::string_view tag_name) {
+    static const std::unordered_set<std::string_view> block_elements = {
         "div", "p", "h1", "h2", "h3", "h4", "h5", "h6",
         "section", "article", "aside", "header", "footer",
         "nav", "main", "figure", "figcaption", "form",
@@ -198,10 +2096,11 @@ bool HtmlIngestor::IsBlockElement(const std::string& tag_name) {
         "pre", "hr", "br", "address", "fieldset", "legend"
     };
 
-    std::string lower_tag = tag_name;
-    std::transform(lower_tag.begin(), lower_tag.end(), lower_tag.begin(), ::tolower);
+    char lower[16];
+    if (tag_name.empty() || tag_name.size() > sizeof(lower)) return false;
+    for (size_t i = 0; i < tag_name.size(); ++i) lower[i] = AsciiLower(tag_name[i]);
 
-    return block_elements.count(lower_tag) > 0;
+    return block_elements.count(std::string_view(lower, tag_name.size())) > 0;
 }
 
 } // namespace ece
\ No newline at end of file
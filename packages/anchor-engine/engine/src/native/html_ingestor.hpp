@@ -1,25 +1,122 @@
 #pragma once
 #include <napi.h>
+#include "charset.hpp"
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ece {
 
+// A start tag as seen by the tokenizer. Views point into tokenizer-owned
+// buffers and are only valid for the duration of the sink callback.
+struct HtmlTag {
+    std::string_view name;      // lower-cased tag name
+    std::string_view raw_attrs; // undecoded attribute text after the name
+    bool self_closing = false;
+
+    // Decoded value of the attribute `key` (lower-case), empty if absent.
+    std::string Attr(std::string_view key) const;
+    bool HasAttr(std::string_view key) const;
+};
+
+// Receives tokenizer events in document order.
+class HtmlSink {
+public:
+    virtual ~HtmlSink() = default;
+    // Entity-decoded text with whitespace untouched. Script/style bodies and
+    // comments never reach the sink.
+    virtual void OnText(std::string_view text) = 0;
+    virtual void OnStartTag(const HtmlTag& tag) { (void)tag; }
+    virtual void OnEndTag(std::string_view name) { (void)name; }
+};
+
+// Incremental HTML tokenizer. Feed() accepts arbitrary slices of a document:
+// a tag, comment or entity may straddle two calls, and all partial state lives
+// here so callers never need to hold the whole document in memory.
+class HtmlTokenizer {
+public:
+    explicit HtmlTokenizer(HtmlSink* sink) : sink_(sink) {}
+
+    void Feed(std::string_view chunk);
+    void Finish(); // Flushes partial state and resets for the next document
+    void Reset();
+
+private:
+    enum class State { Data, TagOpen, Tag, Comment, RawText, Entity };
+
+    void EmitTag();
+    void EmitEntity(bool terminated);
+
+    HtmlSink* sink_;
+    State state_ = State::Data;
+    std::string buf_;       // pending tag or entity bytes
+    std::string name_;      // lower-cased name of the last tag
+    std::string raw_close_; // "</script" while inside a raw text element
+    size_t raw_match_ = 0;
+    int dashes_ = 0;
+    char quote_ = 0;
+    char prev_sig_ = 0;
+};
+
+struct HtmlMetadata {
+    std::string title;
+    std::string description;
+    std::string canonical;
+    std::vector<std::string> tags; // meta keywords and article:tag
+};
+
+// An <a href> with the byte range of its anchor text in the cleaned output.
+struct HtmlLink {
+    std::string href; // resolved against the base URL when one is known
+    size_t start = 0;
+    size_t end = 0;
+};
+
 class HtmlIngestor : public Napi::ObjectWrap<HtmlIngestor> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     HtmlIngestor(const Napi::CallbackInfo& info);
+    ~HtmlIngestor();
 
     // Exposed Methods (The "API" Node.js sees)
     Napi::Value ExtractContent(const Napi::CallbackInfo& info);
     Napi::Value ExtractMetadata(const Napi::CallbackInfo& info);
+    Napi::Value ExtractMainContent(const Napi::CallbackInfo& info);
+    Napi::Value ToMarkdown(const Napi::CallbackInfo& info);
+    Napi::Value ExtractBatchAsync(const Napi::CallbackInfo& info);
+    Napi::Value ExtractLinks(const Napi::CallbackInfo& info);
+    Napi::Value DetectCharset(const Napi::CallbackInfo& info);
+
+    // Streaming mode: push(chunk) returns the text (or atoms) completed so far,
+    // finish() flushes the remainder and readies the instance for a new document.
+    Napi::Value Push(const Napi::CallbackInfo& info);
+    Napi::Value Finish(const Napi::CallbackInfo& info);
 
     // Internal Helpers (Pure C++ Speed)
     static std::string CleanHtml(const std::string& raw_html);
-    static bool IsBlockElement(const std::string& tag_name);
+    static std::string ExtractMainText(std::string_view html, bool block_breaks);
+    static std::string HtmlToMarkdown(std::string_view html, bool main_content);
+    static HtmlMetadata ParseMetadata(std::string_view html);
+    static std::vector<HtmlLink> CollectLinks(std::string_view html, std::string_view base_url, std::string* content);
+    // Raw bytes -> UTF-8: BOM, then <meta charset>/http-equiv, then a UTF-8
+    // validity check decide the encoding.
+    static Charset SniffCharset(std::string_view bytes, size_t* bom_length);
+    static std::string DecodeHtml(std::string_view bytes);
+    static bool IsBlockElement(std::string_view tag_name);
+    static std::string DecodeEntities(std::string_view text);
 
 private:
+    struct Stream;
+
+    Napi::Value StreamResult(Napi::Env env, bool final);
+
     static Napi::FunctionReference constructor;
+
+    bool atomize_ = false;
+    bool block_breaks_ = true;
+    size_t max_chunk_size_ = 512;
+    std::unique_ptr<Stream> stream_;
 };
 
 } // namespace ece
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "key_assassin.hpp"
+#include <cstring>
+
+namespace ece {
+
+namespace {
+
+constexpr std::string_view kFence = "```";
+
+// Keys removed together with their string value ("type": "...",)
+constexpr std::string_view kValueKeys[] = {"\"type\"", "\"timestamp\"", "\"source\""};
+// Keys removed on their own, leaving the value text ("content": ...)
+constexpr std::string_view kBareKeys[] = {"\"response_content\"", "\"thinking_content\"", "\"content\""};
+
+inline bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline size_t SkipSpaces(const char* data, size_t p, size_t limit) {
+    while (p < limit && IsSpace(data[p])) ++p;
+    return p;
+}
+
+// Sweep 1: every backslash run before ", n or t collapses to the character
+// it escapes, so any depth of JSON escaping unwinds in one pass. Other runs
+// are kept for the slash collapse.
+size_t Unescape(char* data, size_t size) {
+    size_t w = 0;
+    size_t r = 0;
+    while (r < size) {
+        const void* slash = std::memchr(data + r, '\\', size - r);
+        const size_t run = slash ? static_cast<size_t>(static_cast<const char*>(slash) - data) : size;
+        if (w != r) std::memmove(data + w, data + r, run - r);
+        w += run - r;
+        r = run;
+        if (r == size) break;
+
+        size_t end = r;
+        while (end < size && data[end] == '\\') ++end;
+        const char next = end < size ? data[end] : '\0';
+        if (next == '"' || next == 'n' || next == 't') {
+            data[w++] = next == 'n' ? '\n' : next == 't' ? '\t' : '"';
+            r = end + 1;
+        } else {
+            if (w != r) std::memmove(data + w, data + r, end - r);
+            w += end - r;
+            r = end;
+        }
+    }
+    return w;
+}
+
+// Length of a metadata key match at `p` (which holds '"'), 0 for none.
+// Matches never extend to `limit`, the start of the next fenced block.
+size_t MatchMetadataKey(const char* data, size_t p, size_t limit) {
+    const std::string_view rest(data + p, limit - p);
+    for (std::string_view key : kValueKeys) {
+        if (rest.compare(0, key.size(), key) != 0) continue;
+        size_t q = SkipSpaces(data, p + key.size(), limit);
+        if (q == limit || data[q] != ':') return 0;
+        q = SkipSpaces(data, q + 1, limit);
+        if (q == limit || data[q] != '"') return 0;
+        // A failed search leaves no '"' before limit, so it cannot repeat
+        const void* close = std::memchr(data + q + 1, '"', limit - q - 1);
+        if (!close) return 0;
+        q = static_cast<size_t>(static_cast<const char*>(close) - data) + 1;
+        if (q < limit && data[q] == ',') ++q;
+        return q - p;
+    }
+    for (std::string_view key : kBareKeys) {
+        if (rest.compare(0, key.size(), key) != 0) continue;
+        size_t q = SkipSpaces(data, p + key.size(), limit);
+        if (q == limit || data[q] != ':') return 0;
+        return SkipSpaces(data, q + 1, limit) - p;
+    }
+    return 0;
+}
+
+// Length of `} , {` at `p` (which holds '}'), 0 for none
+size_t MatchRecordJoin(const char* data, size_t p, size_t limit) {
+    size_t q = SkipSpaces(data, p + 1, limit);
+    if (q == limit || data[q] != ',') return 0;
+    q = SkipSpaces(data, q + 1, limit);
+    if (q == limit || data[q] != '{') return 0;
+    return q + 1 - p;
+}
+
+// The next closed ``` block at or after `from`, as [start, end) including
+// both fences; start == size when there is none
+void NextFence(std::string_view text, size_t from, size_t* start, size_t* end) {
+    const size_t open = text.find(kFence, from);
+    const size_t close = open == std::string_view::npos ? open : text.find(kFence, open + kFence.size());
+    if (close == std::string_view::npos) {
+        *start = *end = text.size();
+        return;
+    }
+    *start = open;
+    *end = close + kFence.size();
+}
+
+// Sweep 2: copies fenced blocks verbatim and cleans everything between them
+size_t Cleanup(char* data, size_t size) {
+    const std::string_view text(data, size);
+    size_t fence_start = 0;
+    size_t fence_end = 0;
+    NextFence(text, 0, &fence_start, &fence_end);
+
+    size_t w = 0;
+    size_t r = 0;
+    while (r < size) {
+        if (r == fence_start) {
+            if (w != r) std::memmove(data + w, data + r, fence_end - r);
+            w += fence_end - r;
+            r = fence_end;
+            NextFence(text, r, &fence_start, &fence_end);
+            continue;
+        }
+
+        const char c = data[r];
+        size_t match = 0;
+        if (c == '"' && (match = MatchMetadataKey(data, r, fence_start)) != 0) {
+            r += match;
+        } else if (c == '}' && (match = MatchRecordJoin(data, r, fence_start)) != 0) {
+            data[w++] = '\n';
+            data[w++] = '\n';
+            r += match;
+        } else if (c == '\\') {
+            size_t end = r + 1;
+            while (end < size && data[end] == '\\') ++end;
+            if (end - r >= 2) {
+                data[w++] = '/';
+            } else {
+                data[w++] = '\\';
+            }
+            r = end;
+        } else {
+            data[w++] = c;
+            ++r;
+        }
+    }
+    return w;
+}
+
+} // namespace
+
+std::string_view CleanseInPlace(char* data, size_t size) {
+    size = Unescape(data, size);
+    size = Cleanup(data, size);
+
+    size_t first = 0;
+    size_t last = size;
+    while (first < last && IsSpace(data[first])) ++first;
+    while (last > first && IsSpace(data[last - 1])) --last;
+    if (last - first >= 2 && data[first] == '[' && data[last - 1] == ']') {
+        ++first;
+        --last;
+    }
+    return std::string_view(data + first, last - first);
+}
+
+std::string Cleanse(std::string_view text) {
+    std::string buffer(text);
+    const std::string_view clean = CleanseInPlace(buffer.data(), buffer.size());
+    return std::string(clean);
+}
+
+// --- N-API ---
+
+namespace {
+
+// cleanse(text: string | Buffer) -> string
+Napi::Value CleanseBinding(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || (!info[0].IsString() && !info[0].IsBuffer())) {
+        Napi::TypeError::New(env, "String or Buffer expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string buffer;
+    if (info[0].IsBuffer()) {
+        Napi::Buffer<char> input = info[0].As<Napi::Buffer<char>>();
+        buffer.assign(input.Data(), input.Length()); // the caller's Buffer is left alone
+    } else {
+        buffer = info[0].As<Napi::String>().Utf8Value();
+    }
+    const std::string_view clean = CleanseInPlace(buffer.data(), buffer.size());
+    return Napi::String::New(env, clean.data(), clean.size());
+}
+
+} // namespace
+
+Napi::Object InitKeyAssassin(Napi::Env env, Napi::Object exports) {
+    exports.Set("cleanse", Napi::Function::New(env, CleanseBinding));
+    return exports;
+}
+
+} // namespace ece
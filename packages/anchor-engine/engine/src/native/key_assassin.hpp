@@ -0,0 +1,33 @@
+#pragma once
+#include <napi.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ece {
+
+// The Key Assassin: strips the JSON transport layer from exported chat logs
+// so only the conversation text is left.
+//
+//   1. Un-escape: a run of backslashes before ", n or t becomes that
+//      character, whatever the escaping depth (\" and \\\" both give ").
+//   2. Outside ``` fenced blocks: purge the metadata keys ("type",
+//      "timestamp" and "source" with their string values; the
+//      "response_content", "thinking_content" and "content" keys alone),
+//      turn record joins `} , {` into a blank line and collapse backslash
+//      runs to '/'.
+//   3. Trim, and drop one enclosing [ ] pair.
+//
+// Two linear sweeps over one buffer (un-escape, then cleanup, both writing
+// behind their read position); no regex, no recursion, so deeply escaped or
+// nested input cannot exhaust the stack.
+
+// Cleans data[0, size) in place; returns the cleaned range within it.
+std::string_view CleanseInPlace(char* data, size_t size);
+
+std::string Cleanse(std::string_view text);
+
+// Registers cleanse() on the module exports.
+Napi::Object InitKeyAssassin(Napi::Env env, Napi::Object exports);
+
+} // namespace ece
@@ -0,0 +1,520 @@
+#include "minhash.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#if defined(__AVX2__) && !defined(_MSC_VER)
+#include <immintrin.h>
+#endif
+
+namespace ece {
+
+namespace {
+
+constexpr uint32_t kEmptySlot = UINT32_MAX;
+// Earlier bucket members each entry is verified against when clustering;
+// bounds the work in huge buckets, whose members other bands still connect
+constexpr size_t kBucketProbes = 16;
+
+// Permutation parameters: fixed, so signatures are comparable across runs
+struct Permutations {
+    alignas(32) uint64_t a[kMinHashPermutations];
+    alignas(32) uint64_t b[kMinHashPermutations];
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    // Per group of eight: permutations 0, 2, 4, 6 and 1, 3, 5, 7 as 64-bit
+    // lanes, so the high halves of their products blend into slot order
+    alignas(32) uint64_t even_a[kMinHashPermutations / 2];
+    alignas(32) uint64_t even_a_hi[kMinHashPermutations / 2];
+    alignas(32) uint64_t even_b[kMinHashPermutations / 2];
+    alignas(32) uint64_t odd_a[kMinHashPermutations / 2];
+    alignas(32) uint64_t odd_a_hi[kMinHashPermutations / 2];
+    alignas(32) uint64_t odd_b[kMinHashPermutations / 2];
+#endif
+
+    Permutations() {
+        uint64_t state = 0x4D696E4861736801ULL; // splitmix64
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        for (size_t i = 0; i < kMinHashPermutations; ++i) {
+            a[i] = next() | 1;
+            b[i] = next();
+        }
+#if defined(__AVX2__) && !defined(_MSC_VER)
+        for (size_t i = 0; i < kMinHashPermutations / 2; ++i) {
+            even_a[i] = a[2 * i];
+            even_a_hi[i] = a[2 * i] >> 32;
+            even_b[i] = b[2 * i];
+            odd_a[i] = a[2 * i + 1];
+            odd_a_hi[i] = a[2 * i + 1] >> 32;
+            odd_b[i] = b[2 * i + 1];
+        }
+#endif
+    }
+};
+
+const Permutations& Params() {
+    static const Permutations params;
+    return params;
+}
+
+inline uint32_t Fold(uint64_t feature) {
+    return static_cast<uint32_t>(feature ^ (feature >> 32));
+}
+
+#if defined(__AVX2__) && !defined(_MSC_VER)
+// Low 64 bits of a * x + b per lane, x < 2^32: a_lo * x + (a_hi * x << 32) + b
+inline __m256i MulAdd(__m256i a, __m256i a_hi, __m256i b, __m256i x) {
+    const __m256i low = _mm256_mul_epu32(a, x);
+    const __m256i high = _mm256_slli_epi64(_mm256_mul_epu32(a_hi, x), 32);
+    return _mm256_add_epi64(_mm256_add_epi64(low, high), b);
+}
+#endif
+
+} // namespace
+
+void MinHashSignature(const uint64_t* features, size_t count, uint32_t* signature) {
+    const Permutations& p = Params();
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    // One group of eight permutations at a time over all features: its
+    // parameters and running minimum stay in registers, and the features,
+    // folded once, are re-read from cache
+    thread_local std::vector<uint64_t> folded;
+    folded.resize(count);
+    for (size_t i = 0; i < count; ++i) folded[i] = Fold(features[i]);
+    auto load = [](const uint64_t* values) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(values)); };
+    for (size_t g = 0; g < kMinHashPermutations / 8; ++g) {
+        const __m256i even_a = load(p.even_a + 4 * g), even_a_hi = load(p.even_a_hi + 4 * g);
+        const __m256i odd_a = load(p.odd_a + 4 * g), odd_a_hi = load(p.odd_a_hi + 4 * g);
+        const __m256i even_b = load(p.even_b + 4 * g), odd_b = load(p.odd_b + 4 * g);
+        __m256i min0 = _mm256_set1_epi32(-1);
+        __m256i min1 = min0;
+        auto hashes = [&](uint64_t value) {
+            const __m256i x = _mm256_set1_epi64x(static_cast<long long>(value));
+            // 32-bit lane 2j <- high half of even[j], lane 2j + 1 <- high half of odd[j]
+            return _mm256_blend_epi32(_mm256_srli_epi64(MulAdd(even_a, even_a_hi, even_b, x), 32),
+                                      MulAdd(odd_a, odd_a_hi, odd_b, x), 0xAA);
+        };
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            min0 = _mm256_min_epu32(min0, hashes(folded[i]));
+            min1 = _mm256_min_epu32(min1, hashes(folded[i + 1]));
+        }
+        if (i < count) min0 = _mm256_min_epu32(min0, hashes(folded[i]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(signature + 8 * g), _mm256_min_epu32(min0, min1));
+    }
+#else
+    std::fill(signature, signature + kMinHashPermutations, kEmptySlot);
+    for (size_t f = 0; f < count; ++f) {
+        const uint64_t x = Fold(features[f]);
+        for (size_t i = 0; i < kMinHashPermutations; ++i) {
+            signature[i] = std::min(signature[i], static_cast<uint32_t>((p.a[i] * x + p.b[i]) >> 32));
+        }
+    }
+#endif
+}
+
+size_t MinHashSignature(std::string_view text, const SimHashOptions& options, uint32_t* signature) {
+    thread_local std::vector<uint64_t> features;
+    ShingleFeatures(text, options, &features);
+    // Repeated shingles do not change the minimum, only the set size
+    std::sort(features.begin(), features.end());
+    features.erase(std::unique(features.begin(), features.end()), features.end());
+    MinHashSignature(features.data(), features.size(), signature);
+    return features.size();
+}
+
+bool MinHashEmpty(const uint32_t* signature) {
+    return std::all_of(signature, signature + kMinHashPermutations, [](uint32_t v) { return v == kEmptySlot; });
+}
+
+double MinHashSimilarity(const uint32_t* a, const uint32_t* b) {
+    size_t equal = 0;
+    size_t i = 0;
+#if defined(__AVX2__) && !defined(_MSC_VER)
+    for (; i < kMinHashPermutations; i += 8) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        equal += static_cast<size_t>(
+            __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)))));
+    }
+#endif
+    for (; i < kMinHashPermutations; ++i) equal += a[i] == b[i];
+    return static_cast<double>(equal) / kMinHashPermutations;
+}
+
+double MinHashContainment(double jaccard, uint32_t size_a, uint32_t size_b) {
+    if (size_a == 0 || size_b == 0) return jaccard;
+    const double shared = jaccard * (static_cast<double>(size_a) + size_b) / (1.0 + jaccard);
+    return std::min(1.0, shared / std::min(size_a, size_b));
+}
+
+MinHashLSH::MinHashLSH(uint32_t bands, uint32_t rows)
+    : bands_(std::max<uint32_t>(bands, 1)), rows_(std::max<uint32_t>(rows, 1)) {
+    if (static_cast<size_t>(bands_) * rows_ > kMinHashPermutations) {
+        bands_ = static_cast<uint32_t>(kMinHashPermutations / rows_);
+    }
+    band_entries_.resize(bands_);
+}
+
+uint32_t MinHashLSH::BandKey(const uint32_t* signature, uint32_t band) const {
+    const char* bytes = reinterpret_cast<const char*>(signature + static_cast<size_t>(band) * rows_);
+    return static_cast<uint32_t>(HashBytes(std::string_view(bytes, rows_ * sizeof(uint32_t)), band));
+}
+
+bool MinHashLSH::Insert(uint32_t id, const uint32_t* signature, uint32_t shingles) {
+    if (MinHashEmpty(signature)) return false;
+    ids_.push_back(id);
+    shingles_.push_back(shingles);
+    signatures_.insert(signatures_.end(), signature, signature + kMinHashPermutations);
+    return true;
+}
+
+void MinHashLSH::Clear() {
+    ids_.clear();
+    shingles_.clear();
+    signatures_.clear();
+    for (auto& entries : band_entries_) entries.clear();
+    indexed_ = 0;
+}
+
+void MinHashLSH::Build() {
+    if (indexed_ == ids_.size()) return;
+    const size_t first = indexed_;
+    WorkerPool::Shared().ParallelFor(bands_, [&](size_t band) {
+        std::vector<uint64_t>& entries = band_entries_[band];
+        const size_t old_size = entries.size();
+        for (size_t slot = first; slot < ids_.size(); ++slot) {
+            entries.push_back(uint64_t{BandKey(SignatureAt(slot), static_cast<uint32_t>(band))} << 32 | slot);
+        }
+        std::sort(entries.begin() + old_size, entries.end());
+        std::inplace_merge(entries.begin(), entries.begin() + old_size, entries.end());
+    });
+    indexed_ = ids_.size();
+}
+
+std::vector<MinHashLSH::Match> MinHashLSH::Query(const uint32_t* signature, double threshold, uint32_t shingles) {
+    std::vector<Match> matches;
+    if (MinHashEmpty(signature)) return matches;
+    Build();
+
+    std::vector<uint32_t> candidates;
+    for (uint32_t band = 0; band < bands_; ++band) {
+        const uint64_t key = uint64_t{BandKey(signature, band)} << 32;
+        const auto& entries = band_entries_[band];
+        auto it = std::lower_bound(entries.begin(), entries.end(), key);
+        for (; it != entries.end() && (*it & ~uint64_t{UINT32_MAX}) == key; ++it) {
+            candidates.push_back(static_cast<uint32_t>(*it));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (uint32_t slot : candidates) {
+        const double similarity =
+            MinHashContainment(MinHashSimilarity(signature, SignatureAt(slot)), shingles, shingles_[slot]);
+        if (similarity >= threshold) matches.push_back({ids_[slot], static_cast<float>(similarity)});
+    }
+    std::sort(matches.begin(), matches.end(), [](const Match& x, const Match& y) {
+        return x.similarity != y.similarity ? x.similarity > y.similarity : x.id < y.id;
+    });
+    return matches;
+}
+
+std::vector<std::vector<uint32_t>> MinHashLSH::Clusters(double threshold) {
+    Build();
+    std::vector<uint32_t> parent(ids_.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](uint32_t x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    };
+
+    for (const auto& entries : band_entries_) {
+        for (size_t run = 0; run < entries.size();) {
+            const uint64_t key = entries[run] >> 32;
+            size_t end = run + 1;
+            while (end < entries.size() && entries[end] >> 32 == key) ++end;
+            for (size_t j = run + 1; j < end; ++j) {
+                const uint32_t b = static_cast<uint32_t>(entries[j]);
+                for (size_t i = j - std::min(j - run, kBucketProbes); i < j; ++i) {
+                    const uint32_t a = static_cast<uint32_t>(entries[i]);
+                    const uint32_t root_a = find(a);
+                    const uint32_t root_b = find(b);
+                    if (root_a == root_b) continue;
+                    const double jaccard = MinHashSimilarity(SignatureAt(a), SignatureAt(b));
+                    if (MinHashContainment(jaccard, shingles_[a], shingles_[b]) >= threshold) {
+                        parent[std::max(root_a, root_b)] = std::min(root_a, root_b);
+                    }
+                }
+            }
+            run = end;
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> groups(ids_.size());
+    for (uint32_t slot = 0; slot < ids_.size(); ++slot) groups[find(slot)].push_back(ids_[slot]);
+    std::vector<std::vector<uint32_t>> clusters;
+    for (auto& group : groups) {
+        if (group.size() < 2) continue;
+        std::sort(group.begin(), group.end());
+        clusters.push_back(std::move(group));
+    }
+    std::sort(clusters.begin(), clusters.end(), [](const auto& x, const auto& y) {
+        return x.size() != y.size() ? x.size() > y.size() : x.front() < y.front();
+    });
+    return clusters;
+}
+
+// --- N-API ---
+
+namespace {
+
+bool IsUint32Array(const Napi::Value& value) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_uint32_array;
+}
+
+// As for fingerprint(), but shingles default to three words: short molecules
+// need overlap at a finer grain than whole-document fingerprints
+SimHashOptions ReadOptions(const Napi::CallbackInfo& info, size_t index) {
+    SimHashOptions options;
+    if (info.Length() > index && info[index].IsObject()) {
+        Napi::Object opts = info[index].As<Napi::Object>();
+        options = ReadSimHashOptions(opts);
+        if (!opts.Has("shingle")) options.shingle = 3;
+    } else {
+        options.shingle = 3;
+    }
+    return options;
+}
+
+std::string_view TextOf(const Napi::Value& value, std::string* owned) {
+    if (value.IsBuffer()) {
+        Napi::Buffer<char> buffer = value.As<Napi::Buffer<char>>();
+        return std::string_view(buffer.Data(), buffer.Length());
+    }
+    *owned = value.As<Napi::String>().Utf8Value();
+    return *owned;
+}
+
+// minhash(text: string | Buffer, { shingle = 3, lowercase? }?) -> Uint32Array(128)
+Napi::Value MinHash(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || (!info[0].IsString() && !info[0].IsBuffer())) {
+        Napi::TypeError::New(env, "String or Buffer expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string owned;
+    Napi::Uint32Array signature = Napi::Uint32Array::New(env, kMinHashPermutations);
+    MinHashSignature(TextOf(info[0], &owned), ReadOptions(info, 1), signature.Data());
+    return signature;
+}
+
+// minhashBatch(texts: (string | Buffer)[], options?)
+//   -> { signatures: Uint32Array, 128 slots per text, sizes: Uint32Array }
+// in input order, computed on the native worker pool. sizes[i] is the number
+// of distinct shingles in texts[i], for MinHashLSH insert() and query().
+Napi::Value MinHashBatch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Array of strings or Buffers expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Array inputs = info[0].As<Napi::Array>();
+    const uint32_t count = inputs.Length();
+    std::vector<std::string> owned(count);
+    std::vector<std::string_view> texts(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        Napi::Value value = inputs.Get(i);
+        if (!value.IsBuffer() && !value.IsString()) {
+            Napi::TypeError::New(env, "Element " + std::to_string(i) + " is not a string or Buffer")
+                .ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        texts[i] = TextOf(value, &owned[i]);
+    }
+
+    const SimHashOptions options = ReadOptions(info, 1);
+    Napi::Uint32Array signatures = Napi::Uint32Array::New(env, size_t{count} * kMinHashPermutations);
+    Napi::Uint32Array sizes = Napi::Uint32Array::New(env, count);
+    uint32_t* out = signatures.Data();
+    uint32_t* out_sizes = sizes.Data();
+    WorkerPool::Shared().ParallelFor(count, [&](size_t i) {
+        const size_t shingles = MinHashSignature(texts[i], options, out + i * kMinHashPermutations);
+        out_sizes[i] = static_cast<uint32_t>(std::min<size_t>(shingles, UINT32_MAX));
+    });
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("signatures", signatures);
+    result.Set("sizes", sizes);
+    return result;
+}
+
+bool ReadThreshold(const Napi::CallbackInfo& info, size_t index, double* threshold) {
+    if (info.Length() <= index || info[index].IsUndefined()) return true;
+    if (!info[index].IsNumber()) return false;
+    *threshold = info[index].As<Napi::Number>().DoubleValue();
+    return *threshold >= 0 && *threshold <= 1;
+}
+
+} // namespace
+
+Napi::FunctionReference MinHashLSHObject::constructor;
+
+Napi::Object MinHashLSHObject::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "MinHashLSH", {
+        InstanceMethod("insert", &MinHashLSHObject::Insert),
+        InstanceMethod("query", &MinHashLSHObject::Query),
+        InstanceMethod("clusters", &MinHashLSHObject::Clusters),
+        InstanceMethod("clear", &MinHashLSHObject::Clear),
+        InstanceAccessor("size", &MinHashLSHObject::GetSize, nullptr)
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("MinHashLSH", func);
+    return exports;
+}
+
+// Constructor: new MinHashLSH({ bands = 32, rows = 4 }); bands * rows <= 128
+MinHashLSHObject::MinHashLSHObject(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<MinHashLSHObject>(info) {
+    uint32_t bands = 32;
+    uint32_t rows = 4;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object opts = info[0].As<Napi::Object>();
+        const Napi::Value bands_value = opts.Get("bands");
+        const Napi::Value rows_value = opts.Get("rows");
+        if ((!bands_value.IsUndefined() && !bands_value.IsNumber()) ||
+            (!rows_value.IsUndefined() && !rows_value.IsNumber())) {
+            Napi::TypeError::New(info.Env(), "bands and rows must be numbers").ThrowAsJavaScriptException();
+            return;
+        }
+        if (bands_value.IsNumber()) {
+            bands = static_cast<uint32_t>(std::clamp<int64_t>(bands_value.As<Napi::Number>().Int64Value(), 1,
+                                                              kMinHashPermutations));
+        }
+        if (rows_value.IsNumber()) {
+            rows = static_cast<uint32_t>(std::clamp<int64_t>(rows_value.As<Napi::Number>().Int64Value(), 1,
+                                                             kMinHashPermutations));
+        }
+    }
+    if (size_t{bands} * rows > kMinHashPermutations) {
+        Napi::RangeError::New(info.Env(), "bands * rows must not exceed 128").ThrowAsJavaScriptException();
+        return;
+    }
+    index_ = MinHashLSH(bands, rows);
+}
+
+// insert(ids: Uint32Array, signatures: Uint32Array of 128 per id,
+//        sizes?: Uint32Array) -> number of ids indexed (empty signatures are
+// skipped). Without the shingle counts from minhashBatch(), pairs are
+// verified on Jaccard similarity instead of containment.
+Napi::Value MinHashLSHObject::Insert(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !IsUint32Array(info[0]) || !IsUint32Array(info[1]) ||
+        (info.Length() > 2 && !info[2].IsUndefined() && !IsUint32Array(info[2]))) {
+        Napi::TypeError::New(env, "Expected (Uint32Array ids, Uint32Array signatures, Uint32Array sizes?)")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Uint32Array ids = info[0].As<Napi::Uint32Array>();
+    Napi::Uint32Array signatures = info[1].As<Napi::Uint32Array>();
+    if (signatures.ElementLength() != ids.ElementLength() * kMinHashPermutations) {
+        Napi::RangeError::New(env, "signatures must hold 128 slots per id").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    const uint32_t* sizes = nullptr;
+    if (info.Length() > 2 && IsUint32Array(info[2])) {
+        Napi::Uint32Array sizes_array = info[2].As<Napi::Uint32Array>();
+        if (sizes_array.ElementLength() != ids.ElementLength()) {
+            Napi::RangeError::New(env, "sizes must hold one count per id").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        sizes = sizes_array.Data();
+    }
+    uint32_t inserted = 0;
+    for (size_t i = 0; i < ids.ElementLength(); ++i) {
+        inserted += index_.Insert(ids[i], signatures.Data() + i * kMinHashPermutations, sizes ? sizes[i] : 0);
+    }
+    return Napi::Number::New(env, inserted);
+}
+
+// query(signature: Uint32Array(128), threshold = 0.5, size?: number)
+//   -> { ids: Uint32Array, similarities: Float32Array }, most similar first.
+// `size` is the query text's shingle count; similarities are containments
+// when both it and the entry's count are known.
+Napi::Value MinHashLSHObject::Query(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    double threshold = 0.5;
+    if (info.Length() < 1 || !IsUint32Array(info[0]) ||
+        info[0].As<Napi::Uint32Array>().ElementLength() != kMinHashPermutations) {
+        Napi::TypeError::New(env, "Uint32Array signature of 128 slots expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (!ReadThreshold(info, 1, &threshold)) {
+        Napi::RangeError::New(env, "threshold must be between 0 and 1").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    uint32_t shingles = 0;
+    if (info.Length() > 2 && !info[2].IsUndefined()) {
+        if (!info[2].IsNumber()) {
+            Napi::TypeError::New(env, "size must be a number").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        shingles = static_cast<uint32_t>(std::clamp<int64_t>(info[2].As<Napi::Number>().Int64Value(), 0, UINT32_MAX));
+    }
+
+    const auto matches = index_.Query(info[0].As<Napi::Uint32Array>().Data(), threshold, shingles);
+    Napi::Uint32Array ids = Napi::Uint32Array::New(env, matches.size());
+    Napi::Float32Array similarities = Napi::Float32Array::New(env, matches.size());
+    for (size_t i = 0; i < matches.size(); ++i) {
+        ids[i] = matches[i].id;
+        similarities[i] = matches[i].similarity;
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("similarities", similarities);
+    return result;
+}
+
+// clusters(threshold = 0.5) -> Uint32Array[] of ids, largest first
+Napi::Value MinHashLSHObject::Clusters(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    double threshold = 0.5;
+    if (!ReadThreshold(info, 0, &threshold)) {
+        Napi::RangeError::New(env, "threshold must be between 0 and 1").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    const auto clusters = index_.Clusters(threshold);
+    Napi::Array result = Napi::Array::New(env, clusters.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        Napi::Uint32Array ids = Napi::Uint32Array::New(env, clusters[c].size());
+        std::copy(clusters[c].begin(), clusters[c].end(), ids.Data());
+        result[static_cast<uint32_t>(c)] = ids;
+    }
+    return result;
+}
+
+Napi::Value MinHashLSHObject::Clear(const Napi::CallbackInfo& info) {
+    index_.Clear();
+    return info.Env().Undefined();
+}
+
+Napi::Value MinHashLSHObject::GetSize(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(index_.size()));
+}
+
+Napi::Object InitMinHash(Napi::Env env, Napi::Object exports) {
+    exports.Set("minhash", Napi::Function::New(env, MinHash));
+    exports.Set("minhashBatch", Napi::Function::New(env, MinHashBatch));
+    MinHashLSHObject::Init(env, exports);
+    return exports;
+}
+
+} // namespace ece
@@ -0,0 +1,114 @@
+#pragma once
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "fingerprint.hpp"
+
+namespace ece {
+
+constexpr size_t kMinHashPermutations = 128;
+
+// MinHash signature of a set of 64-bit features: slot i is the minimum of
+// h_i(x) = high 32 bits of (a_i * x + b_i) mod 2^64 over the features
+// (multiply-shift, a_i odd; x is the feature folded to 32 bits). Eight
+// permutations per AVX2 step with a lane-wise unsigned min. An empty set
+// leaves every slot at UINT32_MAX.
+void MinHashSignature(const uint64_t* features, size_t count, uint32_t* signature);
+
+// Signature over the same word shingles SimHash() uses. Returns the number
+// of distinct shingles, the set size MinHashContainment() needs.
+size_t MinHashSignature(std::string_view text, const SimHashOptions& options, uint32_t* signature);
+
+bool MinHashEmpty(const uint32_t* signature);
+
+// Fraction of equal slots: an unbiased estimate of the Jaccard similarity of
+// the two feature sets.
+double MinHashSimilarity(const uint32_t* a, const uint32_t* b);
+
+// Share of the smaller set found in the larger, from a Jaccard estimate and
+// both set sizes: |A n B| = J (|A| + |B|) / (1 + J). A paragraph quoted in a
+// longer message has a low Jaccard similarity to it but a containment near
+// 1. Returns `jaccard` itself when either size is unknown (0).
+double MinHashContainment(double jaccard, uint32_t size_a, uint32_t size_b);
+
+// LSH banding over MinHash signatures: the first bands * rows slots are cut
+// into bands of `rows`, and entries sharing any band are candidates. Pairs
+// are only reported once their containment (MinHashContainment over the
+// full signatures and the shingle counts given at insert and query) is at
+// least `threshold`, so banding only decides what gets compared.
+//
+// Banding still works on Jaccard similarity: with b bands of r rows, a pair
+// of Jaccard similarity s becomes a candidate with probability
+// 1 - (1 - s^r)^b. A quote that is a fraction f of its host has s of about
+// f, so at 32 x 4 it is found 87% of the time at f = 1/2 but only 33% at
+// f = 1/3; more bands of fewer rows (64 x 2: 98% at f = 1/4) trade
+// candidate volume for recall of short quotes.
+//
+// Bands are kept as sorted (key, slot) arrays; inserts are merged in on the
+// next query, so bulk loading costs one sort per band.
+class MinHashLSH {
+public:
+    struct Match {
+        uint32_t id;
+        float similarity;
+    };
+
+    // bands * rows <= 128.
+    MinHashLSH(uint32_t bands = 32, uint32_t rows = 4);
+
+    uint32_t bands() const { return bands_; }
+    uint32_t rows() const { return rows_; }
+    size_t size() const { return ids_.size(); }
+
+    // Empty signatures (no features) are not indexed; returns false for them.
+    // `shingles` is the set size MinHashSignature() returned, 0 if unknown.
+    bool Insert(uint32_t id, const uint32_t* signature, uint32_t shingles = 0);
+    void Clear();
+
+    // Indexed entries within `threshold`, most similar first, then by id.
+    std::vector<Match> Query(const uint32_t* signature, double threshold, uint32_t shingles = 0);
+
+    // Groups of ids linked by verified pairs (single linkage), each sorted,
+    // largest group first; singletons are left out.
+    std::vector<std::vector<uint32_t>> Clusters(double threshold);
+
+private:
+    uint32_t BandKey(const uint32_t* signature, uint32_t band) const;
+    const uint32_t* SignatureAt(size_t slot) const { return signatures_.data() + slot * kMinHashPermutations; }
+    // Merges entries inserted since the last call into the band arrays.
+    void Build();
+
+    uint32_t bands_;
+    uint32_t rows_;
+    std::vector<uint32_t> ids_;
+    std::vector<uint32_t> shingles_; // per slot, 0 = unknown
+    std::vector<uint32_t> signatures_;
+    std::vector<std::vector<uint64_t>> band_entries_; // key << 32 | slot, sorted
+    size_t indexed_ = 0;
+};
+
+// JS wrapper: new MinHashLSH({ bands?, rows? })
+class MinHashLSHObject : public Napi::ObjectWrap<MinHashLSHObject> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    MinHashLSHObject(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Insert(const Napi::CallbackInfo& info);
+    Napi::Value Query(const Napi::CallbackInfo& info);
+    Napi::Value Clusters(const Napi::CallbackInfo& info);
+    Napi::Value Clear(const Napi::CallbackInfo& info);
+    Napi::Value GetSize(const Napi::CallbackInfo& info);
+
+    MinHashLSH index_;
+};
+
+// Registers minhash(), minhashBatch() and the MinHashLSH class on the module
+// exports.
+Napi::Object InitMinHash(Napi::Env env, Napi::Object exports);
+
+} // namespace ece
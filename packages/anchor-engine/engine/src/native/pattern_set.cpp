@@ -0,0 +1,341 @@
+#include "pattern_set.hpp"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace ece {
+
+namespace {
+
+inline bool IsWord(uint8_t c) {
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_';
+}
+
+inline uint8_t Fold(uint8_t c, bool case_insensitive) {
+    return case_insensitive && c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+struct TrieNode {
+    std::vector<std::pair<uint32_t, uint32_t>> children; // (code, node)
+    std::vector<uint32_t> patterns;
+    int32_t state = 0;
+};
+
+} // namespace
+
+PatternSet::PatternSet(const std::vector<std::string>& patterns, const PatternSetOptions& options)
+    : options_(options) {
+    // Codes for the bytes the patterns use, in byte order
+    std::array<bool, 256> used{};
+    for (const std::string& pattern : patterns) {
+        for (unsigned char c : pattern) used[Fold(c, options_.case_insensitive)] = true;
+    }
+    uint16_t code = 0;
+    for (int c = 0; c < 256; ++c) {
+        if (used[c]) codes_[c] = ++code;
+    }
+    if (options_.case_insensitive) {
+        for (int c = 'A'; c <= 'Z'; ++c) codes_[c] = codes_[c | 0x20];
+    }
+
+    // Plain trie first
+    std::vector<TrieNode> trie(1);
+    lengths_.reserve(patterns.size());
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+        lengths_.push_back(static_cast<uint32_t>(patterns[id].size()));
+        if (patterns[id].empty()) continue;
+        uint32_t node = 0;
+        for (unsigned char c : patterns[id]) {
+            const uint32_t next_code = codes_[c];
+            auto& children = trie[node].children;
+            auto it = std::find_if(children.begin(), children.end(),
+                                   [&](const auto& child) { return child.first == next_code; });
+            if (it == children.end()) {
+                children.emplace_back(next_code, static_cast<uint32_t>(trie.size()));
+                node = static_cast<uint32_t>(trie.size());
+                trie.emplace_back();
+            } else {
+                node = it->second;
+            }
+        }
+        trie[node].patterns.push_back(id);
+    }
+
+    // Pack it into the double array breadth first: each node's children go
+    // at the lowest base where all their slots are free. Free slots are kept
+    // in a list, so the search skips the packed stretches.
+    units_.resize(1);
+    units_[0].check = -2; // the root has no parent but is not free
+    std::vector<int32_t> next_free{-1};
+    std::vector<int32_t> prev_free{-1};
+    int32_t free_head = -1;
+    int32_t free_tail = -1;
+    const auto grow = [&](size_t size) {
+        for (size_t t = units_.size(); t < size; ++t) {
+            units_.emplace_back();
+            next_free.push_back(-1);
+            prev_free.push_back(free_tail);
+            (free_tail < 0 ? free_head : next_free[free_tail]) = static_cast<int32_t>(t);
+            free_tail = static_cast<int32_t>(t);
+        }
+    };
+    const auto take = [&](size_t t) {
+        const int32_t prev = prev_free[t];
+        const int32_t next = next_free[t];
+        (prev < 0 ? free_head : next_free[prev]) = next;
+        (next < 0 ? free_tail : prev_free[next]) = prev;
+    };
+
+    std::vector<uint32_t> order{0};
+    for (size_t k = 0; k < order.size(); ++k) {
+        TrieNode& node = trie[order[k]];
+        if (node.children.empty()) continue;
+        std::sort(node.children.begin(), node.children.end());
+        const size_t first = node.children.front().first;
+        const size_t last = node.children.back().first;
+
+        size_t base = 0;
+        for (int32_t e = free_head;; e = next_free[e]) {
+            if (e < 0) {
+                // Everything past the end is free
+                base = std::max(units_.size(), first + 1) - first;
+                break;
+            }
+            if (static_cast<size_t>(e) <= first) continue;
+            base = e - first;
+            const bool fits = std::all_of(node.children.begin() + 1, node.children.end(), [&](const auto& child) {
+                const size_t t = base + child.first;
+                return t >= units_.size() || units_[t].check == -1;
+            });
+            if (fits) break;
+        }
+        grow(base + last + 1);
+
+        units_[node.state].base = static_cast<int32_t>(base);
+        for (const auto& [child_code, child] : node.children) {
+            units_[base + child_code].check = node.state;
+            take(base + child_code);
+            trie[child].state = static_cast<int32_t>(base + child_code);
+            order.push_back(child);
+        }
+    }
+    states_ = order.size();
+
+    links_.resize(units_.size());
+    for (uint32_t node : order) {
+        Link& link = links_[trie[node].state];
+        link.out_begin = static_cast<uint32_t>(outputs_.size());
+        outputs_.insert(outputs_.end(), trie[node].patterns.begin(), trie[node].patterns.end());
+        link.out_end = static_cast<uint32_t>(outputs_.size());
+    }
+    for (const auto& [child_code, child] : trie[0].children) root_[child_code] = trie[child].state;
+
+    // Failure links, breadth first, so every shallower state is done
+    for (uint32_t node : order) {
+        const int32_t state = trie[node].state;
+        for (const auto& [child_code, child] : trie[node].children) {
+            int32_t fail = 0;
+            if (state != 0) {
+                for (int32_t f = links_[state].fail;; f = links_[f].fail) {
+                    const int32_t next = f == 0 ? root_[child_code] : Next(f, child_code);
+                    if (next > 0) {
+                        fail = next;
+                        break;
+                    }
+                    if (f == 0) break;
+                }
+            }
+            Link& link = links_[trie[child].state];
+            link.fail = fail;
+            link.dict = links_[fail].out_begin != links_[fail].out_end ? fail : links_[fail].dict;
+        }
+    }
+}
+
+template <typename OnMatch>
+bool PatternSet::Scan(std::string_view text, OnMatch&& on_match) const {
+    if (states_ <= 1) return true;
+    const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+    const size_t n = text.size();
+    int32_t state = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t code = codes_[data[i]];
+        if (code == 0) {
+            state = 0;
+            continue;
+        }
+        int32_t next;
+        while ((next = state == 0 ? root_[code] : Next(state, code)) < 0) state = links_[state].fail;
+        state = next;
+
+        const Link& link = links_[state];
+        for (int32_t o = link.out_begin != link.out_end ? state : link.dict; o != 0; o = links_[o].dict) {
+            for (uint32_t k = links_[o].out_begin; k < links_[o].out_end; ++k) {
+                const uint32_t id = outputs_[k];
+                const size_t start = i + 1 - lengths_[id];
+                if (options_.word_boundary &&
+                    ((start > 0 && IsWord(data[start - 1])) || (i + 1 < n && IsWord(data[i + 1])))) {
+                    continue;
+                }
+                if (!on_match(id, start)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<PatternSet::Match> PatternSet::FindAll(std::string_view text) const {
+    std::vector<Match> matches;
+    Scan(text, [&](uint32_t id, size_t offset) {
+        matches.push_back({id, offset});
+        return true;
+    });
+    return matches;
+}
+
+bool PatternSet::ContainsAny(std::string_view text) const {
+    return !Scan(text, [](uint32_t, size_t) { return false; });
+}
+
+void PatternSet::Count(std::string_view text, uint32_t* counts) const {
+    Scan(text, [&](uint32_t id, size_t) {
+        ++counts[id];
+        return true;
+    });
+}
+
+// --- N-API ---
+
+namespace {
+
+bool IsText(const Napi::Value& value) { return value.IsString() || value.IsBuffer(); }
+
+std::string_view TextOf(const Napi::Value& value, std::string* owned) {
+    if (value.IsBuffer()) {
+        Napi::Buffer<char> buffer = value.As<Napi::Buffer<char>>();
+        return std::string_view(buffer.Data(), buffer.Length());
+    }
+    *owned = value.As<Napi::String>().Utf8Value();
+    return *owned;
+}
+
+// Reads info[0] as the text to scan; throws and returns false otherwise
+bool ReadText(const Napi::CallbackInfo& info, std::string* owned, std::string_view* text) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !IsText(info[0])) {
+        Napi::TypeError::New(env, "String or Buffer expected").ThrowAsJavaScriptException();
+        return false;
+    }
+    *text = TextOf(info[0], owned);
+    if (text->size() > std::numeric_limits<uint32_t>::max()) {
+        Napi::RangeError::New(env, "Text exceeds 4 GiB").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+Napi::FunctionReference PatternSetObject::constructor;
+
+Napi::Object PatternSetObject::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "PatternSet", {
+        InstanceMethod("match", &PatternSetObject::Match),
+        InstanceMethod("test", &PatternSetObject::Test),
+        InstanceMethod("count", &PatternSetObject::Count),
+        InstanceAccessor("size", &PatternSetObject::GetSize, nullptr)
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("PatternSet", func);
+    return exports;
+}
+
+// Constructor: new PatternSet(patterns: (string | Buffer)[],
+//                             { caseInsensitive = false, wordBoundary = false })
+PatternSetObject::PatternSetObject(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<PatternSetObject>(info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Array of strings or Buffers expected").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Array inputs = info[0].As<Napi::Array>();
+    std::vector<std::string> patterns(inputs.Length());
+    for (uint32_t i = 0; i < inputs.Length(); ++i) {
+        Napi::Value value = inputs.Get(i);
+        if (!IsText(value)) {
+            Napi::TypeError::New(env, "Element " + std::to_string(i) + " is not a string or Buffer")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        std::string owned;
+        patterns[i] = std::string(TextOf(value, &owned));
+    }
+
+    PatternSetOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        if (opts.Has("caseInsensitive")) {
+            options.case_insensitive = opts.Get("caseInsensitive").ToBoolean().Value();
+        }
+        if (opts.Has("wordBoundary")) {
+            options.word_boundary = opts.Get("wordBoundary").ToBoolean().Value();
+        }
+    }
+    set_ = PatternSet(patterns, options);
+}
+
+// match(text: string | Buffer) -> { ids: Uint32Array, offsets: Uint32Array }
+// with UTF-8 byte offsets of the match starts, ordered by end position
+Napi::Value PatternSetObject::Match(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string owned;
+    std::string_view text;
+    if (!ReadText(info, &owned, &text)) return env.Undefined();
+
+    const auto matches = set_.FindAll(text);
+    Napi::Uint32Array ids = Napi::Uint32Array::New(env, matches.size());
+    Napi::Uint32Array offsets = Napi::Uint32Array::New(env, matches.size());
+    for (size_t i = 0; i < matches.size(); ++i) {
+        ids[i] = matches[i].pattern;
+        offsets[i] = static_cast<uint32_t>(matches[i].offset);
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("offsets", offsets);
+    return result;
+}
+
+// test(text: string | Buffer) -> boolean; stops at the first match
+Napi::Value PatternSetObject::Test(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string owned;
+    std::string_view text;
+    if (!ReadText(info, &owned, &text)) return env.Undefined();
+    return Napi::Boolean::New(env, set_.ContainsAny(text));
+}
+
+// count(text: string | Buffer) -> Uint32Array of occurrences per pattern
+Napi::Value PatternSetObject::Count(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string owned;
+    std::string_view text;
+    if (!ReadText(info, &owned, &text)) return env.Undefined();
+    Napi::Uint32Array counts = Napi::Uint32Array::New(env, set_.size());
+    set_.Count(text, counts.Data());
+    return counts;
+}
+
+Napi::Value PatternSetObject::GetSize(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(set_.size()));
+}
+
+Napi::Object InitPatternSet(Napi::Env env, Napi::Object exports) {
+    PatternSetObject::Init(env, exports);
+    return exports;
+}
+
+} // namespace ece
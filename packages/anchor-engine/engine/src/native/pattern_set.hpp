@@ -0,0 +1,105 @@
+#pragma once
+#include <napi.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ece {
+
+struct PatternSetOptions {
+    bool case_insensitive = false; // ASCII case folding
+    bool word_boundary = false;    // no word character ([A-Za-z0-9_]) directly
+                                   // before or after a match
+};
+
+// Aho-Corasick automaton over a fixed list of byte-string patterns: one
+// linear pass over the text reports every occurrence of every pattern,
+// overlapping ones included.
+//
+// The trie is packed into a double array (state t is a child of s on code c
+// when base[s] + c == t and check[t] == s), so a transition is two loads
+// from one 8-byte unit. Bytes are renumbered to the codes that occur in the
+// patterns, which keeps the array dense; a byte in no pattern resets the
+// scan to the root without a lookup. Failure and output links live in a
+// parallel array touched only on mismatches and matches.
+class PatternSet {
+public:
+    struct Match {
+        uint32_t pattern; // index in the pattern list
+        size_t offset;    // byte offset of the match start
+    };
+
+    PatternSet() = default;
+    // Empty patterns never match. Duplicates each report their own index.
+    explicit PatternSet(const std::vector<std::string>& patterns, const PatternSetOptions& options = {});
+
+    size_t size() const { return lengths_.size(); }
+    size_t states() const { return states_; }
+
+    // Every match, by end offset, longest first among those ending together.
+    std::vector<Match> FindAll(std::string_view text) const;
+
+    // Whether any pattern occurs; stops at the first match.
+    bool ContainsAny(std::string_view text) const;
+
+    // counts[i] += occurrences of pattern i; counts holds size() slots.
+    void Count(std::string_view text, uint32_t* counts) const;
+
+private:
+    struct Unit {
+        int32_t base = 0;
+        int32_t check = -1; // parent state, -1 while the slot is free
+    };
+    struct Link {
+        int32_t fail = 0;
+        int32_t dict = 0;       // nearest state on the failure chain with
+                                // patterns of its own, 0 for none
+        uint32_t out_begin = 0; // this state's patterns in outputs_
+        uint32_t out_end = 0;
+    };
+
+    // Child of a non-root state on code c, -1 for none
+    int32_t Next(int32_t state, uint32_t code) const {
+        const size_t t = static_cast<size_t>(units_[state].base) + code;
+        return t < units_.size() && units_[t].check == state ? static_cast<int32_t>(t) : -1;
+    }
+
+    // Calls on_match(pattern, offset) for each match until it returns
+    // false; returns whether the scan ran to the end.
+    template <typename OnMatch>
+    bool Scan(std::string_view text, OnMatch&& on_match) const;
+
+    PatternSetOptions options_;
+    std::array<uint16_t, 256> codes_{}; // 0: the byte is in no pattern
+    std::array<int32_t, 257> root_{};   // children of the root by code, 0 for none
+    std::vector<Unit> units_;
+    std::vector<Link> links_;           // indexed like units_
+    std::vector<uint32_t> outputs_;     // pattern ids grouped by state
+    std::vector<uint32_t> lengths_;     // byte length of each pattern
+    size_t states_ = 0;
+};
+
+// JS wrapper: new PatternSet(patterns, { caseInsensitive?, wordBoundary? })
+class PatternSetObject : public Napi::ObjectWrap<PatternSetObject> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    PatternSetObject(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Match(const Napi::CallbackInfo& info);
+    Napi::Value Test(const Napi::CallbackInfo& info);
+    Napi::Value Count(const Napi::CallbackInfo& info);
+    Napi::Value GetSize(const Napi::CallbackInfo& info);
+
+    PatternSet set_;
+};
+
+// Registers the PatternSet class on the module exports.
+Napi::Object InitPatternSet(Napi::Env env, Napi::Object exports);
+
+} // namespace ece
@@ -0,0 +1,768 @@
+#include "sanitize.hpp"
+#include "key_assassin.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <cstdint>
+
+namespace ece {
+
+namespace {
+
+constexpr size_t kNone = std::string_view::npos;
+
+constexpr std::string_view kLogVerbs[] = {"Processing", "Loading", "Indexing", "Analyzing"};
+constexpr std::string_view kMetaKeys[] = {"response_content", "thinking_content", "content", "message",
+                                          "text", "body", "type", "timestamp", "source_path"};
+constexpr size_t kMetaKeyPasses = std::size(kMetaKeys);
+constexpr std::string_view kRoleMarkers[] = {"<|user|>", "<|assistant|>", "<|system|>"};
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool IsAlpha(char c) { return (c | 0x20) >= 'a' && (c | 0x20) <= 'z'; }
+inline bool IsAlnum(char c) { return IsDigit(c) || IsAlpha(c); }
+inline bool IsWord(char c) { return IsAlnum(c) || c == '_'; }
+inline bool IsAsciiSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+inline bool IsEmailLocal(char c) {
+    return IsAlnum(c) || c == '.' || c == '_' || c == '%' || c == '+' || c == '-';
+}
+inline bool IsLogVerbStart(char c) { return c == 'P' || c == 'L' || c == 'I' || c == 'A'; }
+
+// The chain in two sweeps. The log noise rules ran before PII masking and
+// can join text around what they remove ("[===] 100%bob@x.com"), so masking
+// and everything after it run over what the noise sweep leaves.
+enum class Stage {
+    kNoise,   // line breaks, log spam, timestamps, [date] tags, progress bars
+    kContent, // PII, [Source: ...] headers, metadata keys, JSON fragments,
+              // role markers, blank-line collapse and trim
+};
+
+// What a byte can start, for copying runs of plain text in bulk. Rules that
+// begin on a word are anchored on a later byte instead (a metadata key on
+// its ':', an e-mail address on its '@', an IPv4 address on its first '.')
+// and take back the part already written.
+enum ByteClass : uint8_t {
+    kPlain,   // starts no rule
+    kSpace,   // ' ' or '\t'; starts a log spam match before a log verb only
+    kRedact,  // anchors a PII rule
+    kSpecial, // may start a rule
+};
+
+constexpr std::array<uint8_t, 256> MakeNoiseClasses() {
+    std::array<uint8_t, 256> classes{};
+    classes[' '] = classes['\t'] = kSpace;
+    // Breaks, other spaces (including the lead bytes of U+00A0, U+1680,
+    // U+2000..) and the remaining anchors
+    for (unsigned char c : {'\n', '\r', '\f', '\v', '\\', '.', '[', '\xC2', '\xE1', '\xE2', '\xE3', '\xEF'}) {
+        classes[c] = kSpecial;
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> MakeContentClasses() {
+    std::array<uint8_t, 256> classes{};
+    classes['@'] = classes['-'] = classes['.'] = kRedact;
+    for (unsigned char c : {'\n', ':', '[', '{', '<', '"'}) classes[c] = kSpecial;
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> kNoiseClasses = MakeNoiseClasses();
+constexpr std::array<uint8_t, 256> kContentClasses = MakeContentClasses();
+
+// Byte length of a non-ASCII whitespace character (JS \s) at p, 0 for none
+size_t UnicodeSpace(std::string_view s, size_t p) {
+    const auto at = [&](size_t i) { return static_cast<unsigned char>(s[p + i]); };
+    const size_t left = s.size() - p;
+    if (left >= 2 && at(0) == 0xC2 && at(1) == 0xA0) return 2; // U+00A0
+    if (left < 3) return 0;
+    switch (at(0)) {
+        case 0xE1: return at(1) == 0x9A && at(2) == 0x80 ? 3 : 0; // U+1680
+        case 0xE2:
+            if (at(1) == 0x80) {
+                const unsigned char c = at(2);
+                return (c >= 0x80 && c <= 0x8A) || c == 0xA8 || c == 0xA9 || c == 0xAF ? 3 : 0;
+            }
+            return at(1) == 0x81 && at(2) == 0x9F ? 3 : 0; // U+205F
+        case 0xE3: return at(1) == 0x80 && at(2) == 0x80 ? 3 : 0; // U+3000
+        case 0xEF: return at(1) == 0xBB && at(2) == 0xBF ? 3 : 0; // U+FEFF
+        default: return 0;
+    }
+}
+
+class Sweep {
+public:
+    Sweep(std::string_view text, Stage stage, const SanitizeOptions& options)
+        : s_(text), n_(text.size()), stage_(stage), options_(options) {}
+
+    std::string Run() {
+        out_.reserve(n_ + n_ / 16 + 16);
+        size_t p = 0;
+        while (p < n_) {
+            // Line-anchored noise rules and the leading trim need Step
+            if (stage_ == Stage::kNoise ? !at_start_ && !line_start_ : !out_.empty()) {
+                const size_t plain = PlainRunEnd(p);
+                out_.append(s_.data() + p, plain - p);
+                if ((p = plain) == n_) break;
+            }
+            p = stage_ == Stage::kNoise ? NoiseStep(p) : ContentStep(p);
+        }
+
+        if (stage_ == Stage::kContent) {
+            verbatim_ = 0;
+            out_.resize(TailSpaceStart(out_.size()));
+        }
+        return std::move(out_);
+    }
+
+private:
+    bool At(size_t p, char c) const { return p < n_ && s_[p] == c; }
+    bool Starts(size_t p, std::string_view token) const { return s_.compare(p, token.size(), token) == 0; }
+
+    bool DigitsAt(size_t p, size_t count) const {
+        if (p + count > n_) return false;
+        for (size_t i = 0; i < count; ++i) {
+            if (!IsDigit(s_[p + i])) return false;
+        }
+        return true;
+    }
+
+    size_t PlainRunEnd(size_t p) const {
+        const auto& classes = stage_ == Stage::kNoise ? kNoiseClasses : kContentClasses;
+        for (; p < n_; ++p) {
+            switch (classes[static_cast<unsigned char>(s_[p])]) {
+                case kPlain:
+                    continue;
+                case kSpace:
+                    if (!(p + 1 < n_ && IsLogVerbStart(s_[p + 1]))) continue;
+                    return p;
+                case kRedact:
+                    if (!options_.redact) continue;
+                    return p;
+                default:
+                    return p;
+            }
+        }
+        return p;
+    }
+
+    // \b between p - 1 and p
+    bool BoundaryAt(size_t p) const {
+        const bool before = p > 0 && IsWord(s_[p - 1]);
+        const bool after = p < n_ && IsWord(s_[p]);
+        return before != after;
+    }
+
+    // Length of a newline at p: \n, \r\n or a literal "\r\n" escape. The
+    // escape is expanded first, so \r followed by one is a single \r\n. The
+    // noise sweep leaves only \n.
+    size_t BreakAt(size_t p) const {
+        if (p >= n_) return 0;
+        if (s_[p] == '\n') return 1;
+        if (stage_ == Stage::kContent) return 0;
+        if (s_[p] == '\r') return At(p + 1, '\n') ? 2 : Starts(p + 1, "\\r\\n") ? 5 : 0;
+        return s_[p] == '\\' && Starts(p, "\\r\\n") ? 4 : 0;
+    }
+
+    // Length of a whitespace character (JS \s) at p
+    size_t SpaceAt(size_t p) const {
+        if (p >= n_) return 0;
+        if (size_t len = BreakAt(p)) return len;
+        if (IsAsciiSpace(s_[p])) return 1;
+        return static_cast<unsigned char>(s_[p]) >= 0x80 ? UnicodeSpace(s_, p) : 0;
+    }
+
+    size_t SkipSpaces(size_t p) const {
+        while (size_t len = SpaceAt(p)) p += len;
+        return p;
+    }
+
+    // Where JS `.` stops
+    bool LineEndAt(size_t p) const {
+        const char c = s_[p];
+        if (c == '\n' || c == '\r') return true;
+        if (c == '\\') return stage_ == Stage::kNoise && Starts(p, "\\r\\n");
+        return c == '\xE2' && (Starts(p, "\xE2\x80\xA8") || Starts(p, "\xE2\x80\xA9"));
+    }
+
+    // First `c` at or after p on the same line. A miss is remembered up to
+    // the line end, so scanning a line for the same character from many
+    // starts stays linear.
+    struct LineMiss {
+        size_t from = 0;
+        size_t to = 0;
+    };
+
+    size_t FindOnLine(size_t p, char c, LineMiss* miss) const {
+        if (p >= miss->from && p < miss->to) return kNone;
+        size_t q = p;
+        for (; q < n_ && !LineEndAt(q); ++q) {
+            if (s_[q] == c) return q;
+        }
+        *miss = {p, q};
+        return kNone;
+    }
+
+    // [YYYY-MM-DD at p
+    bool BracketDateAt(size_t p) const {
+        return At(p, '[') && DigitsAt(p + 1, 4) && At(p + 5, '-') && DigitsAt(p + 6, 2) && At(p + 8, '-') &&
+               DigitsAt(p + 9, 2);
+    }
+
+    // Whether s_[start, end) is what out_ ends with, past verbatim_, so it
+    // can be taken back
+    bool WrittenAsIs(size_t start, size_t end) const {
+        const size_t len = end - start;
+        return out_.size() - verbatim_ >= len && out_.compare(out_.size() - len, len, s_.data() + start, len) == 0;
+    }
+
+    // --- Rules; each returns the end of its match, 0 for none ---
+
+    // (?:^|\s|\.{3}\s*)(Processing|Loading|Indexing|Analyzing) '[^']+'\.{3}
+    size_t MatchLogSpam(size_t p, bool at_start) const {
+        if (at_start) {
+            if (size_t end = MatchLogVerb(p)) return end;
+        }
+        if (size_t len = SpaceAt(p)) {
+            if (size_t end = MatchLogVerb(p + len)) return end;
+        }
+        if (Starts(p, "...")) return MatchLogVerb(SkipSpaces(p + 3));
+        return 0;
+    }
+
+    size_t MatchLogVerb(size_t p) const {
+        if (p >= n_ || !IsLogVerbStart(s_[p])) return 0;
+        for (std::string_view verb : kLogVerbs) {
+            if (!Starts(p, verb)) continue;
+            const size_t open = p + verb.size() + 1;
+            if (!Starts(p + verb.size(), " '")) return 0;
+            const size_t close = s_.find('\'', open + 1);
+            if (close == kNone || close == open + 1) return 0;
+            return Starts(close + 1, "...") ? close + 4 : 0;
+        }
+        return 0;
+    }
+
+    // (?:^|\n)\s*-\s*\[\d{4}-\d{2}-\d{2}.*?\].*?Processing.*?(?:\n|$), any case
+    size_t MatchProcessingLine(size_t p, bool at_start) {
+        if (at_start) {
+            if (size_t end = MatchProcessingLineFrom(p)) return end;
+        }
+        if (size_t len = BreakAt(p)) return MatchProcessingLineFrom(p + len);
+        return 0;
+    }
+
+    size_t MatchProcessingLineFrom(size_t p) {
+        size_t q = SkipSpaces(p);
+        if (!At(q, '-')) return 0;
+        q = SkipSpaces(q + 1);
+        if (!BracketDateAt(q)) return 0;
+        const size_t close = FindOnLine(q + 11, ']', &bracket_miss_);
+        if (close == kNone) return 0;
+
+        static constexpr std::string_view kWord = "processing";
+        bool found = false;
+        for (q = close + 1; q < n_ && !LineEndAt(q); ++q) {
+            if (found || q + kWord.size() > n_) continue;
+            size_t i = 0;
+            while (i < kWord.size() && (s_[q + i] | 0x20) == kWord[i]) ++i;
+            found = i == kWord.size();
+        }
+        if (!found) return 0;
+        if (q == n_) return q;
+        const size_t len = BreakAt(q);
+        return len ? q + len : 0; // a lone \r or U+2028 ends the line without a \n
+    }
+
+    // ^\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}(?:\.\d{3})?\s*(?:AM|PM)?\s*[-:>]
+    size_t MatchLogTimestamp(size_t p) {
+        if (!(DigitsAt(p, 4) && At(p + 4, '-') && DigitsAt(p + 5, 2) && At(p + 7, '-') && DigitsAt(p + 8, 2) &&
+              At(p + 10, ' ') && DigitsAt(p + 11, 2) && At(p + 13, ':') && DigitsAt(p + 14, 2) &&
+              At(p + 16, ':') && DigitsAt(p + 17, 2))) {
+            return 0;
+        }
+        size_t q = p + 19;
+        if (At(q, '.') && DigitsAt(q + 1, 3)) q += 4;
+        q = SkipLogSpaces(q);
+        if (Starts(q, "AM") || Starts(q, "PM")) q += 2;
+        q = SkipLogSpaces(q);
+        return At(q, '-') || At(q, ':') || At(q, '>') ? q + 1 : 0;
+    }
+
+    // \s* for the timestamp rule. The log spam and processing-line passes
+    // ran before it, and what they matched was a newline by then.
+    size_t SkipLogSpaces(size_t p) {
+        for (;;) {
+            size_t end;
+            if ((end = MatchLogSpam(p, false)) || (end = MatchProcessingLine(p, false))) {
+                p = end;
+            } else if (const size_t len = SpaceAt(p)) {
+                p += len;
+            } else {
+                return p;
+            }
+        }
+    }
+
+    // \[\d{4}-\d{2}-\d{2}.*?\]
+    size_t MatchBracketDate(size_t p) {
+        if (!BracketDateAt(p)) return 0;
+        const size_t close = FindOnLine(p + 11, ']', &bracket_miss_);
+        return close == kNone ? 0 : close + 1;
+    }
+
+    // \[[#=]{0,10}\s{0,10}\]\s*\d{1,3}%
+    size_t MatchProgressBar(size_t p) const {
+        if (!At(p, '[')) return 0;
+        size_t q = p + 1;
+        for (int i = 0; i < 10 && (At(q, '#') || At(q, '=')); ++i) ++q;
+        for (int i = 0; i < 10; ++i) {
+            const size_t len = SpaceAt(q);
+            if (!len) break;
+            q += len;
+        }
+        if (!At(q, ']')) return 0;
+        q = SkipSpaces(q + 1);
+        size_t digits = 0;
+        while (digits < 3 && q < n_ && IsDigit(s_[q])) ++q, ++digits;
+        return digits > 0 && At(q, '%') ? q + 1 : 0;
+    }
+
+    // \b[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Z|a-z]{2,}\b, found at the '@'
+    // once the local part has been written; *taken is set to its length. The
+    // local part may start right where the previous address ended.
+    size_t MatchEmailAt(size_t p, size_t* taken) {
+        size_t start = p;
+        while (start > email_end_ && IsEmailLocal(s_[start - 1])) --start;
+        while (start < p && !BoundaryAt(start)) ++start;
+        if (start == p || !WrittenAsIs(start, p)) return 0;
+        const size_t end = MatchEmailDomain(p + 1);
+        if (end) {
+            *taken = p - start;
+            email_end_ = end;
+        }
+        return end;
+    }
+
+    size_t MatchEmailDomain(size_t p) const {
+        size_t e = p;
+        while (e < n_ && (IsAlnum(s_[e]) || s_[e] == '.' || s_[e] == '-')) ++e;
+        // Greedy: the last dot that leaves a valid top-level part wins
+        for (size_t dot = e; dot-- > p + 1;) {
+            if (s_[dot] != '.') continue;
+            const size_t tld = dot + 1;
+            size_t end = tld;
+            while (end < n_ && (IsAlpha(s_[end]) || s_[end] == '|')) ++end;
+            for (size_t stop = end; stop >= tld + 2; --stop) {
+                if (BoundaryAt(stop)) return stop;
+            }
+        }
+        return 0;
+    }
+
+    // Whether the e-mail local-part run through p ends in an address. The
+    // e-mail rule ran before the IPv4 and sk- rules, so they yield to it.
+    // Every position in one run shares the answer.
+    bool EmailAhead(size_t p) {
+        if (p >= email_run_end_) {
+            size_t e = p;
+            while (e < n_ && IsEmailLocal(s_[e])) ++e;
+            email_run_end_ = e;
+            email_ahead_ = At(e, '@') && MatchEmailDomain(e + 1) != 0;
+        }
+        return email_ahead_;
+    }
+
+    // \b(?:\d{1,3}\.){3}\d{1,3}\b, found at its first '.' once the first
+    // group has been written; *taken is set to that group's length
+    size_t MatchIPv4At(size_t p, size_t* taken) {
+        size_t start = p;
+        while (start > 0 && p - start < 4 && IsDigit(s_[start - 1])) --start;
+        if (start == p || p - start > 3 || !BoundaryAt(start)) return 0;
+        size_t q = p + 1;
+        for (int group = 1; group < 4; ++group) {
+            size_t digits = 0;
+            while (digits < 4 && q < n_ && IsDigit(s_[q])) ++q, ++digits;
+            if (digits == 0 || digits > 3) return 0;
+            if (group < 3) {
+                if (!At(q, '.')) return 0;
+                ++q;
+            }
+        }
+        if (!BoundaryAt(q) || !WrittenAsIs(start, p) || EmailAhead(p)) return 0;
+        *taken = p - start;
+        return q;
+    }
+
+    // sk-[a-zA-Z0-9]{32,}, found at the '-' once "sk" has been written
+    size_t MatchApiKey(size_t p) {
+        const size_t k = out_.size();
+        if (k - verbatim_ < 2 || out_.compare(k - 2, 2, "sk") != 0) return 0;
+        size_t q = p + 1;
+        while (q < n_ && IsAlnum(s_[q])) ++q;
+        return q - (p + 1) >= 32 && !EmailAhead(p) ? q : 0;
+    }
+
+    // (?:status:\s*)?\[Source: .*?\](?:\s*\(Timestamp: .*?\))?, found at
+    // the '['; a written "status:" prefix is taken back on a match, unless
+    // an earlier header was removed after it
+    size_t MatchSourceHeader(size_t p) {
+        const size_t q = SourceHeaderEnd(p);
+        if (!q) return 0;
+        const size_t k = TailSpaceStart(out_.size());
+        const size_t floor = std::max({verbatim_, source_removed_at_, key_removed_at_});
+        if (k >= floor + 7 && out_.compare(k - 7, 7, "status:") == 0) out_.resize(k - 7);
+        source_removed_at_ = out_.size();
+        return q;
+    }
+
+    size_t SourceHeaderEnd(size_t p) {
+        if (!Starts(p, "[Source: ")) return 0;
+        const size_t close = FindOnLine(p + 9, ']', &bracket_miss_);
+        if (close == kNone) return 0;
+        size_t q = close + 1;
+        const size_t stamp = SkipSpaces(q);
+        if (Starts(stamp, "(Timestamp: ")) {
+            const size_t paren = FindOnLine(stamp + 12, ')', &paren_miss_);
+            if (paren != kNone) q = paren + 1;
+        }
+        return q;
+    }
+
+    // Past the [Source: ...] headers at p, "status:" prefix included
+    size_t SkipSourceHeaders(size_t p) {
+        for (;;) {
+            const size_t end = SourceHeaderEnd(Starts(p, "status:") ? SkipSpaces(p + 7) : p);
+            if (!end) return p;
+            p = end;
+        }
+    }
+
+    // Past whitespace and what earlier passes removed ahead of p: [Source:
+    // ...] headers, and metadata keys whose pass came before `key_pass`
+    // (kMetaKeyPasses for the JSON fragment passes, which followed them all)
+    size_t SkipRemoved(size_t p, size_t key_pass) {
+        for (;;) {
+            const size_t q = SkipSpaces(p);
+            size_t end = SkipSourceHeaders(q);
+            if (end == q) end = key_pass > 0 ? MatchMetaKey(q, key_pass) : 0;
+            if (!end) return q;
+            p = end;
+        }
+    }
+
+    // ["']?key["']?\s*:\s*(?:\|-?|")?, found at the ':' with the key part
+    // already written; the key part is taken back on a match. The chain ran
+    // one pass per key, so a match may span an earlier removal only when
+    // its key's pass came later.
+    size_t MatchMetaKeyAt(size_t p) {
+        size_t k = TailSpaceStart(out_.size());
+        if (k > verbatim_ && (out_[k - 1] == '"' || out_[k - 1] == '\'')) --k;
+        for (size_t i = 0; i < kMetaKeyPasses; ++i) {
+            const std::string_view key = kMetaKeys[i];
+            if (k - verbatim_ < key.size() || out_.compare(k - key.size(), key.size(), key) != 0) continue;
+            size_t start = k - key.size();
+            if (start > verbatim_ && (out_[start - 1] == '"' || out_[start - 1] == '\'')) --start;
+            if (start < key_removed_at_ && i <= key_removed_index_) continue;
+            out_.resize(start);
+            source_removed_at_ = std::min(source_removed_at_, start);
+            // Back-to-back removals: a key spanning them must come after both
+            key_removed_index_ = start == key_removed_at_ ? std::max(key_removed_index_, i) : i;
+            key_removed_at_ = start;
+            return MetaKeyValueStart(p + 1, i);
+        }
+        return 0;
+    }
+
+    // Past the \s*(?:\|-?|")? that follows the ':' of key `key_pass`
+    size_t MetaKeyValueStart(size_t p, size_t key_pass) {
+        p = SkipRemoved(p, key_pass);
+        if (At(p, '|')) {
+            const size_t dash = SkipSourceHeaders(p + 1);
+            return At(dash, '-') ? dash + 1 : p + 1;
+        }
+        return At(p, '"') ? p + 1 : p;
+    }
+
+    // The same match looked for forwards from p, without writing anything,
+    // for keys whose pass came before `key_pass`
+    size_t MatchMetaKey(size_t p, size_t key_pass) {
+        size_t q = p;
+        if (s_[q] == '"' || s_[q] == '\'') q = SkipSourceHeaders(q + 1);
+        switch (q < n_ ? s_[q] : '\0') {
+            case 'r': case 't': case 'c': case 'm': case 'b': case 's': break;
+            default: return 0;
+        }
+        for (size_t i = 0; i < key_pass; ++i) {
+            if (!Starts(q, kMetaKeys[i])) continue;
+            size_t r = SkipSourceHeaders(q + kMetaKeys[i].size());
+            if (At(r, '"') || At(r, '\'')) ++r;
+            r = SkipRemoved(r, i);
+            if (!At(r, ':')) return 0;
+            return MetaKeyValueStart(r + 1, i);
+        }
+        return 0;
+    }
+
+    // "\s*,\s*" -> newline, or "\s*} -> nothing; *newline says which
+    size_t MatchQuoteFragment(size_t p, bool* newline) {
+        if (MatchMetaKey(p, kMetaKeyPasses)) return 0; // the key pass took the quote
+        const size_t q = SkipRemoved(p + 1, kMetaKeyPasses);
+        if (At(q, ',')) {
+            const size_t r = SkipRemoved(q + 1, kMetaKeyPasses);
+            if (!At(r, '"')) return 0;
+            *newline = true;
+            return r + 1;
+        }
+        *newline = false;
+        return At(q, '}') ? q + 1 : 0;
+    }
+
+    // {\s*", which ran last and so also reaches past removed fragments
+    size_t MatchBraceQuote(size_t p) {
+        size_t q = p + 1;
+        for (;;) {
+            q = SkipRemoved(q, kMetaKeyPasses);
+            if (!At(q, '"')) return 0;
+            bool newline;
+            const size_t end = MatchQuoteFragment(q, &newline);
+            if (!end) return q + 1;
+            q = end;
+        }
+    }
+
+    size_t MatchRoleMarker(size_t p) const {
+        for (std::string_view marker : kRoleMarkers) {
+            if (Starts(p, marker)) return p + marker.size();
+        }
+        return 0;
+    }
+
+    // --- Output ---
+
+    // Start of the whitespace at the end of out_[0, k), not reaching back
+    // past verbatim_
+    size_t TailSpaceStart(size_t k) const {
+        for (;;) {
+            if (k > verbatim_ && IsAsciiSpace(out_[k - 1])) {
+                --k;
+            } else if (k >= verbatim_ + 2 && UnicodeSpace(out_, k - 2) == 2) {
+                k -= 2;
+            } else if (k >= verbatim_ + 3 && UnicodeSpace(out_, k - 3) == 3) {
+                k -= 3;
+            } else {
+                return k;
+            }
+        }
+    }
+
+    // A newline from the noise sweep, collapsing \n{3,} and dropping
+    // leading ones
+    void EmitBreak() {
+        const size_t k = out_.size();
+        if (k == 0 || (k >= 2 && out_[k - 1] == '\n' && out_[k - 2] == '\n')) return;
+        out_.push_back('\n');
+    }
+
+    // Replaces the last `taken` bytes written with `text`
+    void EmitText(size_t taken, std::string_view text) {
+        out_.resize(out_.size() - taken);
+        out_.append(text);
+        verbatim_ = out_.size();
+    }
+
+    // Consumes what starts at p and returns where the next step begins
+    size_t NoiseStep(size_t p) {
+        const bool at_start = at_start_;
+        const bool line_start = line_start_;
+        at_start_ = false;
+        line_start_ = false;
+        size_t end;
+
+        if ((end = MatchLogSpam(p, at_start)) || (end = MatchProcessingLine(p, at_start))) {
+            out_.push_back('\n');
+            line_start_ = true;
+            return end;
+        }
+        if (size_t len = BreakAt(p)) {
+            out_.push_back('\n');
+            line_start_ = true;
+            return p + len;
+        }
+        if (line_start && (end = MatchLogTimestamp(p))) return end;
+        if (s_[p] == '[' && ((end = MatchBracketDate(p)) || (end = MatchProgressBar(p)))) return end;
+
+        // Plain text. A lone \r, U+2028 or U+2029 still starts a line for the
+        // timestamp rule.
+        if (const size_t space = SpaceAt(p)) {
+            line_start_ = LineEndAt(p);
+            out_.append(s_.data() + p, space);
+            return p + space;
+        }
+        out_.push_back(s_[p]);
+        return p + 1;
+    }
+
+    size_t ContentStep(size_t p) {
+        const char c = s_[p];
+        size_t end;
+        size_t taken = 0;
+        switch (c) {
+            case '\n':
+                EmitBreak();
+                return p + 1;
+            case '[':
+                if ((end = MatchSourceHeader(p))) return end;
+                break;
+            case '@':
+                if (options_.redact && (end = MatchEmailAt(p, &taken))) {
+                    EmitText(taken, "[EMAIL_REDACTED]");
+                    return end;
+                }
+                break;
+            case '.':
+                if (options_.redact && (end = MatchIPv4At(p, &taken))) {
+                    EmitText(taken, "[IP_REDACTED]");
+                    return end;
+                }
+                break;
+            case '-':
+                if (options_.redact && (end = MatchApiKey(p))) {
+                    EmitText(2, "sk-[REDACTED]");
+                    return end;
+                }
+                break;
+            case ':':
+                if ((end = MatchMetaKeyAt(p))) return end;
+                break;
+            case '"': {
+                bool newline;
+                if ((end = MatchQuoteFragment(p, &newline))) {
+                    if (newline) EmitBreak();
+                    verbatim_ = out_.size();
+                    return end;
+                }
+                break;
+            }
+            case '{':
+                if ((end = MatchBraceQuote(p))) {
+                    verbatim_ = out_.size();
+                    return end;
+                }
+                break;
+            case '<':
+                if ((end = MatchRoleMarker(p))) {
+                    verbatim_ = out_.size();
+                    return end;
+                }
+                break;
+            default:
+                break;
+        }
+
+        // Plain text; whitespace before the first output is trimmed
+        if (const size_t space = SpaceAt(p)) {
+            if (!out_.empty()) out_.append(s_.data() + p, space);
+            return p + space;
+        }
+        out_.push_back(c);
+        return p + 1;
+    }
+
+    std::string_view s_;
+    size_t n_;
+    Stage stage_;
+    SanitizeOptions options_;
+    std::string out_;
+
+    bool at_start_ = true;    // nothing consumed yet (for ^ without the m flag)
+    bool line_start_ = true;  // after a line break (for ^ with the m flag)
+    size_t verbatim_ = 0;     // out_ from here on may be taken back by a rule
+                              // anchored on a later byte; set past replacements
+                              // and past removals made by the chain's last passes
+    size_t key_removed_at_ = 0;    // where the last metadata key was taken out
+    size_t key_removed_index_ = 0; // and which key it was
+    size_t source_removed_at_ = 0; // where the last [Source: ...] header was
+    LineMiss bracket_miss_;
+    LineMiss paren_miss_;
+    size_t email_end_ = 0;     // end of the last e-mail address taken
+    size_t email_run_end_ = 0; // end of the last e-mail local-part run seen
+    bool email_ahead_ = false; // whether that run ends in an address
+};
+
+// The chain's first pass: a leading BOM, NULs and U+FFFD. Returns `text`
+// itself when there is nothing else to drop.
+std::string_view DropInvalid(std::string_view text, std::string* owned) {
+    if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.remove_prefix(3);
+    if (text.find('\0') == kNone && text.find("\xEF\xBF\xBD") == kNone) return text;
+    owned->reserve(text.size());
+    for (size_t p = 0; p < text.size(); ++p) {
+        if (text[p] == '\0') continue;
+        if (text.compare(p, 3, "\xEF\xBF\xBD") == 0) {
+            p += 2;
+            continue;
+        }
+        owned->push_back(text[p]);
+    }
+    return *owned;
+}
+
+} // namespace
+
+std::string Sanitize(std::string_view text, const SanitizeOptions& options) {
+    std::string valid;
+    text = DropInvalid(text, &valid);
+    const std::string quiet = Sweep(text, Stage::kNoise, options).Run();
+    return Sweep(quiet, Stage::kContent, options).Run();
+}
+
+// --- N-API ---
+
+namespace {
+
+// sanitize(text: string | Buffer, { keyAssassin = false, redact = true }?) -> string
+Napi::Value SanitizeBinding(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || (!info[0].IsString() && !info[0].IsBuffer())) {
+        Napi::TypeError::New(env, "String or Buffer expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    SanitizeOptions options;
+    bool key_assassin = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        if (opts.Has("keyAssassin")) {
+            key_assassin = opts.Get("keyAssassin").ToBoolean().Value();
+        }
+        if (opts.Has("redact")) {
+            options.redact = opts.Get("redact").ToBoolean().Value();
+        }
+    }
+
+    std::string buffer;
+    std::string_view text;
+    if (info[0].IsBuffer()) {
+        Napi::Buffer<char> input = info[0].As<Napi::Buffer<char>>();
+        text = std::string_view(input.Data(), input.Length());
+    } else {
+        buffer = info[0].As<Napi::String>().Utf8Value();
+        text = buffer;
+    }
+    if (key_assassin) {
+        if (buffer.empty()) buffer.assign(text); // the caller's Buffer is left alone
+        text = CleanseInPlace(buffer.data(), buffer.size());
+    }
+    const std::string clean = Sanitize(text, options);
+    return Napi::String::New(env, clean);
+}
+
+} // namespace
+
+Napi::Object InitSanitize(Napi::Env env, Napi::Object exports) {
+    exports.Set("sanitize", Napi::Function::New(env, SanitizeBinding));
+    return exports;
+}
+
+} // namespace ece
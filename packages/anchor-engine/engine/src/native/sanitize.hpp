@@ -0,0 +1,35 @@
+#pragma once
+#include <napi.h>
+#include <string>
+#include <string_view>
+
+namespace ece {
+
+struct SanitizeOptions {
+    bool redact = true; // mask e-mail addresses, IPv4 addresses and sk- keys
+};
+
+// The ingest sanitizer (AtomizerService.sanitize) as two forward sweeps,
+// each writing a single output buffer:
+//
+//   1. Drop a leading BOM, NULs and U+FFFD.
+//   2. Noise sweep: CRLF and literal "\r\n" escapes become newlines; log
+//      spam ("Processing '...'..." and friends, "- [date] ... Processing
+//      ..." lines, line-leading timestamps, [date ...] tags, [===] 100%
+//      progress bars).
+//   3. Content sweep over what step 2 left: PII masking (optional),
+//      [Source: ...] headers, metadata keys ("content": " and the like),
+//      JSON fragment quotes and braces, <|user|> / <|assistant|> /
+//      <|system|> role markers; runs of three or more newlines collapse to
+//      a blank line; trim.
+//
+// PII is masked on text the noise rules already cut up, so an address that
+// only forms once a progress bar is gone is still caught. Within the content
+// sweep, rules are tried in chain order and a match looks past whatever an
+// earlier rule in the chain removed, so results match the chain.
+std::string Sanitize(std::string_view text, const SanitizeOptions& options = {});
+
+// Registers sanitize() on the module exports.
+Napi::Object InitSanitize(Napi::Env env, Napi::Object exports);
+
+} // namespace ece
@@ -0,0 +1,315 @@
+#include "simhash_column.hpp"
+#include "fingerprint.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ece {
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'C', 'E', 'S', 'I', 'M', 'C', '1'};
+constexpr uint64_t kHeaderSize = 16;
+
+bool Seek(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+bool FileSize(std::FILE* file, uint64_t* size) {
+#ifdef _WIN32
+    if (_fseeki64(file, 0, SEEK_END) != 0) return false;
+    const __int64 end = _ftelli64(file);
+#else
+    if (fseeko(file, 0, SEEK_END) != 0) return false;
+    const off_t end = ftello(file);
+#endif
+    if (end < 0) return false;
+    *size = static_cast<uint64_t>(end);
+    return true;
+}
+
+std::string ErrnoText(const std::string& what, const std::string& path) {
+    return what + ": " + path + " (" + std::strerror(errno) + ")";
+}
+
+} // namespace
+
+SimHashColumn::~SimHashColumn() {
+    Close();
+}
+
+void SimHashColumn::Close() {
+    if (file_) std::fclose(file_);
+    file_ = nullptr;
+    values_.clear();
+}
+
+bool SimHashColumn::Open(const std::string& path, std::string* error) {
+    Close();
+    path_ = path;
+    file_ = std::fopen(path.c_str(), "r+b");
+    if (!file_ && errno == ENOENT) return Reset(error);
+    if (!file_) {
+        *error = ErrnoText("Cannot open simhash column", path);
+        return false;
+    }
+
+    char header[kHeaderSize];
+    uint64_t count = 0;
+    if (std::fread(header, 1, kHeaderSize, file_) != kHeaderSize || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        Close();
+        *error = "Invalid simhash column - " + path + " (bad header)";
+        return false;
+    }
+    std::memcpy(&count, header + 8, sizeof(count));
+
+    // A count past the end of the file (a header that reached the disk
+    // before the tail it counts) is rejected rather than trusted
+    uint64_t file_size = 0;
+    if (!FileSize(file_, &file_size) || count > (file_size - kHeaderSize) / 8 || !Seek(file_, kHeaderSize)) {
+        Close();
+        *error = "Invalid simhash column - " + path + " (truncated)";
+        return false;
+    }
+    values_.resize(static_cast<size_t>(count));
+    if (std::fread(values_.data(), sizeof(uint64_t), values_.size(), file_) != values_.size()) {
+        Close();
+        *error = ErrnoText("Cannot read simhash column", path);
+        return false;
+    }
+    return true;
+}
+
+bool SimHashColumn::Reset(std::string* error) {
+    if (file_) std::fclose(file_);
+    values_.clear();
+    file_ = std::fopen(path_.c_str(), "w+b");
+    if (!file_) {
+        *error = ErrnoText("Cannot create simhash column", path_);
+        return false;
+    }
+    char header[kHeaderSize] = {};
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    return WriteAt(0, header, sizeof(header), error) && Sync(error);
+}
+
+bool SimHashColumn::WriteAt(uint64_t offset, const void* data, size_t bytes, std::string* error) {
+    if (!Seek(file_, offset) || std::fwrite(data, 1, bytes, file_) != bytes) {
+        *error = ErrnoText("Cannot write simhash column", path_);
+        return false;
+    }
+    return true;
+}
+
+bool SimHashColumn::Set(const uint32_t* ordinals, const uint64_t* hashes, size_t count, std::string* error) {
+    if (!file_) {
+        *error = "Simhash column is not open";
+        return false;
+    }
+    if (count == 0) return true;
+
+    std::vector<std::pair<uint32_t, uint64_t>> updates(count);
+    for (size_t i = 0; i < count; ++i) updates[i] = {ordinals[i], hashes[i]};
+    // Stable, so the last write to a repeated ordinal wins
+    std::stable_sort(updates.begin(), updates.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    const size_t old_size = values_.size();
+    const size_t new_size = std::max<size_t>(old_size, size_t{updates.back().first} + 1);
+    values_.resize(new_size, 0);
+    for (const auto& update : updates) values_[update.first] = update.second;
+
+    // Changed slots below the old end, one write per contiguous run, then
+    // the whole grown tail
+    for (size_t i = 0; i < updates.size() && updates[i].first < old_size;) {
+        const uint32_t first = updates[i].first;
+        uint32_t last = first;
+        while (i < updates.size() && updates[i].first < old_size && updates[i].first <= last + 1) {
+            last = updates[i].first;
+            ++i;
+        }
+        if (!WriteAt(kHeaderSize + uint64_t{first} * 8, values_.data() + first, (last - first + 1) * 8, error)) {
+            return false;
+        }
+    }
+    if (new_size > old_size) {
+        if (!WriteAt(kHeaderSize + uint64_t{old_size} * 8, values_.data() + old_size, (new_size - old_size) * 8,
+                     error)) {
+            return false;
+        }
+        const uint64_t header_count = new_size;
+        if (!WriteAt(8, &header_count, sizeof(header_count), error)) return false;
+    }
+    if (std::fflush(file_) != 0) {
+        *error = ErrnoText("Cannot write simhash column", path_);
+        return false;
+    }
+    return true;
+}
+
+bool SimHashColumn::Sync(std::string* error) {
+    if (!file_) return true;
+#ifdef _WIN32
+    const bool synced = std::fflush(file_) == 0 && _commit(_fileno(file_)) == 0;
+#else
+    const bool synced = std::fflush(file_) == 0 && ::fsync(fileno(file_)) == 0;
+#endif
+    if (!synced) *error = ErrnoText("Cannot sync simhash column", path_);
+    return synced;
+}
+
+void SimHashColumn::Distances(const uint64_t* anchors, size_t anchor_count, const uint32_t* candidates,
+                              size_t candidate_count, uint8_t* out) const {
+    std::vector<uint64_t> gathered(candidate_count);
+    for (size_t c = 0; c < candidate_count; ++c) gathered[c] = Get(candidates[c]);
+    for (size_t a = 0; a < anchor_count; ++a) {
+        HammingDistances(anchors[a], gathered.data(), candidate_count, out + a * candidate_count);
+    }
+}
+
+// --- N-API ---
+
+Napi::FunctionReference SimHashColumnObject::constructor;
+
+Napi::Object SimHashColumnObject::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SimHashColumn", {
+        InstanceMethod("set", &SimHashColumnObject::Set),
+        InstanceMethod("get", &SimHashColumnObject::Get),
+        InstanceMethod("distances", &SimHashColumnObject::Distances),
+        InstanceMethod("reset", &SimHashColumnObject::Reset),
+        InstanceMethod("sync", &SimHashColumnObject::Sync),
+        InstanceMethod("close", &SimHashColumnObject::Close),
+        InstanceAccessor("size", &SimHashColumnObject::GetSize, nullptr)
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("SimHashColumn", func);
+    return exports;
+}
+
+namespace {
+
+bool IsUint32Array(const Napi::Value& value) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_uint32_array;
+}
+
+} // namespace
+
+// Constructor: new SimHashColumn(path) - opens or creates the column file;
+// throws when the file exists but is not a column.
+SimHashColumnObject::SimHashColumnObject(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SimHashColumnObject>(info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+        return;
+    }
+    std::string error;
+    if (!column_.Open(info[0].As<Napi::String>().Utf8Value(), &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    }
+}
+
+// set(ordinals: Uint32Array, hashes: BigUint64Array) -> size
+Napi::Value SimHashColumnObject::Set(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const uint64_t* hashes = nullptr;
+    size_t count = 0;
+    if (info.Length() < 2 || !IsUint32Array(info[0]) || !ReadHashArray(info[1], &hashes, &count)) {
+        Napi::TypeError::New(env, "Expected (Uint32Array, BigUint64Array)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Uint32Array ordinals = info[0].As<Napi::Uint32Array>();
+    if (ordinals.ElementLength() != count) {
+        Napi::RangeError::New(env, "ordinals and hashes must have the same length").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string error;
+    if (!column_.Set(ordinals.Data(), hashes, count, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Number::New(env, static_cast<double>(column_.size()));
+}
+
+// get(ordinal) -> bigint (0n when unset)
+Napi::Value SimHashColumnObject::Get(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    const int64_t ordinal = info[0].As<Napi::Number>().Int64Value();
+    const uint64_t hash = ordinal >= 0 && ordinal <= UINT32_MAX ? column_.Get(static_cast<uint32_t>(ordinal)) : 0;
+    return Napi::BigInt::New(env, hash);
+}
+
+// distances(anchors: Uint32Array | BigUint64Array, candidates: Uint32Array)
+//   -> Uint8Array, one row of candidates.length distances per anchor.
+// Anchors are ordinals looked up in the column, or hashes given directly.
+Napi::Value SimHashColumnObject::Distances(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !IsUint32Array(info[1])) {
+        Napi::TypeError::New(env, "Expected (anchors, candidates: Uint32Array)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::vector<uint64_t> anchors;
+    const uint64_t* anchor_hashes = nullptr;
+    size_t anchor_count = 0;
+    if (IsUint32Array(info[0])) {
+        Napi::Uint32Array ordinals = info[0].As<Napi::Uint32Array>();
+        anchors.resize(ordinals.ElementLength());
+        for (size_t a = 0; a < anchors.size(); ++a) anchors[a] = column_.Get(ordinals[a]);
+        anchor_hashes = anchors.data();
+        anchor_count = anchors.size();
+    } else if (!ReadHashArray(info[0], &anchor_hashes, &anchor_count)) {
+        Napi::TypeError::New(env, "Anchors must be a Uint32Array of ordinals or a BigUint64Array of hashes")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Uint32Array candidates = info[1].As<Napi::Uint32Array>();
+    Napi::Uint8Array out = Napi::Uint8Array::New(env, anchor_count * candidates.ElementLength());
+    column_.Distances(anchor_hashes, anchor_count, candidates.Data(), candidates.ElementLength(), out.Data());
+    return out;
+}
+
+// reset() - empties the column before a rebuild
+Napi::Value SimHashColumnObject::Reset(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string error;
+    if (!column_.Reset(&error)) Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+}
+
+// sync() - flushes written slots to stable storage
+Napi::Value SimHashColumnObject::Sync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string error;
+    if (!column_.Sync(&error)) Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+}
+
+Napi::Value SimHashColumnObject::Close(const Napi::CallbackInfo& info) {
+    column_.Close();
+    return info.Env().Undefined();
+}
+
+Napi::Value SimHashColumnObject::GetSize(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(column_.size()));
+}
+
+} // namespace ece
@@ -0,0 +1,78 @@
+#pragma once
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ece {
+
+// Dense uint64 simhash per atom ordinal, so scoring a candidate set is a
+// gather plus the SIMD distance kernel instead of parsing hex text per row.
+// Kept in memory and mirrored to a file written in place (little-endian):
+//
+//   header  "ECESIMC1", u64 count
+//   values  u64[count], slot i holding ordinal i's hash (0 = none)
+//
+// Set() writes only the slots it changed (one write per contiguous run),
+// in place, and the grown tail before the header count. Nothing reaches
+// stable storage before Sync(), so a crash can leave any mix of old and new
+// slot values; Open() rejects a header counting more slots than the file
+// holds. The column is a cache of the atoms table: callers validate it
+// against the database on open and rebuild it when it disagrees.
+class SimHashColumn {
+public:
+    SimHashColumn() = default;
+    ~SimHashColumn();
+
+    SimHashColumn(const SimHashColumn&) = delete;
+    SimHashColumn& operator=(const SimHashColumn&) = delete;
+
+    // Opens or creates the file at `path` and reads it in.
+    bool Open(const std::string& path, std::string* error);
+    void Close();
+
+    size_t size() const { return values_.size(); }
+    // 0 for ordinals never set
+    uint64_t Get(uint32_t ordinal) const { return ordinal < values_.size() ? values_[ordinal] : 0; }
+
+    bool Set(const uint32_t* ordinals, const uint64_t* hashes, size_t count, std::string* error);
+    // Truncates to empty (before a rebuild).
+    bool Reset(std::string* error);
+    bool Sync(std::string* error);
+
+    // out[a * candidate_count + c] = distance between anchor a and candidate
+    // c, each read from the column; unset ordinals count as hash 0.
+    void Distances(const uint64_t* anchors, size_t anchor_count, const uint32_t* candidates,
+                   size_t candidate_count, uint8_t* out) const;
+
+private:
+    bool WriteAt(uint64_t offset, const void* data, size_t bytes, std::string* error);
+
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    std::vector<uint64_t> values_;
+};
+
+// JS wrapper: new SimHashColumn(path)
+class SimHashColumnObject : public Napi::ObjectWrap<SimHashColumnObject> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SimHashColumnObject(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Set(const Napi::CallbackInfo& info);
+    Napi::Value Get(const Napi::CallbackInfo& info);
+    Napi::Value Distances(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value Sync(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value GetSize(const Napi::CallbackInfo& info);
+
+    SimHashColumn column_;
+};
+
+} // namespace ece
@@ -0,0 +1,516 @@
+#include "simhash_index.hpp"
+#include "fingerprint.hpp"
+#include "worker_pool.hpp"
+#include "agent/file_writer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ece {
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'C', 'E', 'S', 'I', 'M', 'X', '1'};
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kMinDelta = 4096; // entries kept unsorted before any fold
+
+inline uint64_t Rotl(uint64_t x, int r) {
+    r &= 63;
+    return (x << r) | (x >> ((64 - r) & 63));
+}
+
+inline size_t PadTo8(size_t n) {
+    return (n + 7) & ~size_t{7};
+}
+
+size_t TableBytes(int directory_bits, size_t count) {
+    return PadTo8(((size_t{1} << directory_bits) + 1) * 4) + count * 8 + PadTo8(count * 4);
+}
+
+// Block values within `radius` bits of `value` (its low `width` bits)
+template <typename Fn>
+void ForEachNeighbour(uint64_t value, int width, int radius, int from, const Fn& fn) {
+    fn(value);
+    if (radius == 0) return;
+    for (int bit = from; bit < width; ++bit) {
+        ForEachNeighbour(value ^ (uint64_t{1} << bit), width, radius - 1, bit + 1, fn);
+    }
+}
+
+// Sum of C(width, i) for i <= radius, saturating
+size_t NeighbourCount(int width, int radius) {
+    size_t total = 0, term = 1;
+    for (int i = 0; i <= radius && i <= width; ++i) {
+        total += term;
+        if (term > (size_t{1} << 40)) return size_t{1} << 40;
+        term = term * static_cast<size_t>(width - i) / static_cast<size_t>(i + 1);
+    }
+    return total;
+}
+
+template <typename T>
+void Append(std::string* out, const T* data, size_t count) {
+    if (count > 0) out->append(reinterpret_cast<const char*>(data), count * sizeof(T));
+    out->resize(PadTo8(out->size()));
+}
+
+} // namespace
+
+size_t SimHashIndex::EntryHash::operator()(const Entry& entry) const {
+    return static_cast<size_t>(entry.hash ^ (uint64_t{entry.id} * 0x9E3779B97F4A7C15ULL));
+}
+
+SimHashIndex::SimHashIndex(int max_distance) {
+    Layout(std::clamp(max_distance, 1, 7) + 1);
+    Clear();
+}
+
+void SimHashIndex::Layout(int blocks) {
+    blocks_ = blocks;
+    // The first 64 % blocks blocks are one bit wider
+    int end = 0, narrowest = 64;
+    for (int b = 0; b < blocks; ++b) {
+        const int width = 64 / blocks + (b < 64 % blocks ? 1 : 0);
+        end += width;
+        block_end_[b] = end;
+        narrowest = std::min(narrowest, width);
+    }
+    directory_bits_ = std::min(narrowest, 16);
+}
+
+void SimHashIndex::Clear() {
+    file_.Close();
+    owned_.assign(blocks_, OwnedTable{});
+    tables_.assign(blocks_, Table{});
+    for (int b = 0; b < blocks_; ++b) {
+        owned_[b].directory.assign((size_t{1} << directory_bits_) + 1, 0);
+        tables_[b].directory = owned_[b].directory.data();
+    }
+    base_count_ = 0;
+    delta_hashes_.clear();
+    delta_ids_.clear();
+    delta_index_.clear();
+    tombstones_.clear();
+}
+
+bool SimHashIndex::InBase(const Entry& entry) const {
+    if (base_count_ == 0) return false;
+    const Table& table = tables_[0];
+    const uint64_t rotated = Rotl(entry.hash, Rotation(0));
+    const size_t bucket = static_cast<size_t>(rotated >> (64 - directory_bits_));
+    const uint64_t* first = table.rotated + table.directory[bucket];
+    const uint64_t* last = table.rotated + table.directory[bucket + 1];
+    const auto range = std::equal_range(first, last, rotated);
+    for (const uint64_t* it = range.first; it != range.second; ++it) {
+        if (table.ids[it - table.rotated] == entry.id) return true;
+    }
+    return false;
+}
+
+bool SimHashIndex::Insert(uint64_t hash, uint32_t id) {
+    const Entry entry{hash, id};
+    if (tombstones_.erase(entry) > 0) return true; // still in the tables
+    if (delta_index_.count(entry) > 0 || InBase(entry)) return false;
+    delta_index_.emplace(entry, delta_hashes_.size());
+    delta_hashes_.push_back(hash);
+    delta_ids_.push_back(id);
+    MaybeCompact();
+    return true;
+}
+
+void SimHashIndex::InsertMany(const uint64_t* hashes, const uint32_t* ids, size_t count) {
+    // A batch as large as the fold threshold is sorted in directly rather
+    // than hashed into the delta first
+    if (count >= std::max(kMinDelta, base_count_ / 16)) {
+        delta_hashes_.insert(delta_hashes_.end(), hashes, hashes + count);
+        delta_ids_.insert(delta_ids_.end(), ids, ids + count);
+        Compact();
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const Entry entry{hashes[i], ids[i]};
+        if (tombstones_.erase(entry) > 0 || delta_index_.count(entry) > 0 || InBase(entry)) continue;
+        delta_index_.emplace(entry, delta_hashes_.size());
+        delta_hashes_.push_back(entry.hash);
+        delta_ids_.push_back(entry.id);
+    }
+    MaybeCompact();
+}
+
+bool SimHashIndex::Remove(uint64_t hash, uint32_t id) {
+    const Entry entry{hash, id};
+    auto it = delta_index_.find(entry);
+    if (it != delta_index_.end()) {
+        const size_t slot = it->second;
+        delta_index_.erase(it);
+        const size_t last = delta_hashes_.size() - 1;
+        if (slot != last) {
+            delta_hashes_[slot] = delta_hashes_[last];
+            delta_ids_[slot] = delta_ids_[last];
+            delta_index_[Entry{delta_hashes_[slot], delta_ids_[slot]}] = slot;
+        }
+        delta_hashes_.pop_back();
+        delta_ids_.pop_back();
+        return true;
+    }
+    if (!InBase(entry) || !tombstones_.insert(entry).second) return false;
+    MaybeCompact();
+    return true;
+}
+
+void SimHashIndex::MaybeCompact() {
+    if (delta_hashes_.size() + tombstones_.size() > std::max(kMinDelta, base_count_ / 16)) Compact();
+}
+
+void SimHashIndex::Compact() {
+    // Live entries: the sorted ones not tombstoned, then the delta (which may
+    // repeat pairs when filled by InsertMany; sorting drops them)
+    std::vector<Entry> entries;
+    entries.reserve(base_count_ - tombstones_.size() + delta_hashes_.size());
+    const Table& first = tables_[0];
+    for (size_t i = 0; i < base_count_; ++i) {
+        const Entry entry{Rotl(first.rotated[i], 64 - Rotation(0)), first.ids[i]};
+        if (tombstones_.empty() || tombstones_.count(entry) == 0) entries.push_back(entry);
+    }
+    for (size_t i = 0; i < delta_hashes_.size(); ++i) entries.push_back(Entry{delta_hashes_[i], delta_ids_[i]});
+
+    std::vector<OwnedTable> owned(blocks_);
+    WorkerPool::Shared().ParallelFor(static_cast<size_t>(blocks_), [&](size_t b) {
+        const int rotation = Rotation(static_cast<int>(b));
+        std::vector<std::pair<uint64_t, uint32_t>> sorted(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) sorted[i] = {Rotl(entries[i].hash, rotation), entries[i].id};
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+        OwnedTable& table = owned[b];
+        table.rotated.resize(sorted.size());
+        table.ids.resize(sorted.size());
+        table.directory.assign((size_t{1} << directory_bits_) + 1, 0);
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            table.rotated[i] = sorted[i].first;
+            table.ids[i] = sorted[i].second;
+            ++table.directory[(sorted[i].first >> (64 - directory_bits_)) + 1];
+        }
+        for (size_t k = 1; k < table.directory.size(); ++k) table.directory[k] += table.directory[k - 1];
+    });
+
+    file_.Close();
+    owned_ = std::move(owned);
+    base_count_ = owned_[0].rotated.size();
+    for (int b = 0; b < blocks_; ++b) {
+        tables_[b] = Table{owned_[b].directory.data(), owned_[b].rotated.data(), owned_[b].ids.data()};
+    }
+    delta_hashes_.clear();
+    delta_ids_.clear();
+    delta_index_.clear();
+    tombstones_.clear();
+}
+
+void SimHashIndex::AppendRange(int block, size_t first, size_t last, uint64_t rotated_query, int distance,
+                               std::vector<uint8_t>* scratch, std::vector<Match>* matches) const {
+    if (first >= last) return;
+    const Table& table = tables_[block];
+    // Rotation preserves Hamming distance, so rotated hashes are compared as is
+    scratch->resize(last - first);
+    HammingDistances(rotated_query, table.rotated + first, last - first, scratch->data());
+    for (size_t i = first; i < last; ++i) {
+        const uint8_t d = (*scratch)[i - first];
+        if (d > distance) continue;
+        if (!tombstones_.empty() &&
+            tombstones_.count(Entry{Rotl(table.rotated[i], 64 - Rotation(block)), table.ids[i]}) > 0) {
+            continue;
+        }
+        matches->push_back(Match{table.ids[i], d});
+    }
+}
+
+std::vector<SimHashIndex::Match> SimHashIndex::QueryWithin(uint64_t hash, int distance) const {
+    std::vector<Match> matches;
+    if (distance < 0) return matches;
+    distance = std::min(distance, 64);
+    std::vector<uint8_t> scratch;
+
+    // Some block is within distance / blocks bits of the query's
+    const int radius = distance / blocks_;
+    size_t probes = 0;
+    for (int b = 0; b < blocks_; ++b) probes += NeighbourCount(Width(b), radius);
+
+    if (probes * 16 > base_count_) {
+        // Probing would touch most buckets anyway
+        AppendRange(0, 0, base_count_, Rotl(hash, Rotation(0)), distance, &scratch, &matches);
+    } else {
+        for (int b = 0; b < blocks_; ++b) {
+            const Table& table = tables_[b];
+            const int width = Width(b);
+            const uint64_t rotated_query = Rotl(hash, Rotation(b));
+            const uint64_t key = rotated_query >> (64 - width);
+            ForEachNeighbour(key, width, radius, 0, [&](uint64_t value) {
+                const size_t bucket = static_cast<size_t>(value >> (width - directory_bits_));
+                size_t first = table.directory[bucket];
+                size_t last = table.directory[bucket + 1];
+                if (width > directory_bits_) {
+                    // Narrow the bucket to hashes whose whole block is `value`
+                    const uint64_t low = value << (64 - width);
+                    const uint64_t high = low | (~uint64_t{0} >> width);
+                    first = std::lower_bound(table.rotated + first, table.rotated + last, low) - table.rotated;
+                    last = std::upper_bound(table.rotated + first, table.rotated + last, high) - table.rotated;
+                }
+                AppendRange(b, first, last, rotated_query, distance, &scratch, &matches);
+            });
+        }
+    }
+
+    if (!delta_hashes_.empty()) {
+        scratch.resize(delta_hashes_.size());
+        HammingDistances(hash, delta_hashes_.data(), delta_hashes_.size(), scratch.data());
+        for (size_t i = 0; i < delta_hashes_.size(); ++i) {
+            if (scratch[i] <= distance) matches.push_back(Match{delta_ids_[i], scratch[i]});
+        }
+    }
+
+    // A hash close on several blocks is found once per table
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.id < b.id;
+    });
+    matches.erase(std::unique(matches.begin(), matches.end(),
+                              [](const Match& a, const Match& b) { return a.id == b.id && a.distance == b.distance; }),
+                  matches.end());
+    return matches;
+}
+
+bool SimHashIndex::Save(const std::string& path, std::string* error) {
+    if (!delta_hashes_.empty() || !tombstones_.empty()) Compact();
+
+    std::string out;
+    out.reserve(kHeaderSize + blocks_ * TableBytes(directory_bits_, base_count_));
+    out.append(kMagic, sizeof(kMagic));
+    const uint32_t header[2] = {static_cast<uint32_t>(blocks_), static_cast<uint32_t>(directory_bits_)};
+    const uint64_t count = base_count_;
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const Table& table : tables_) {
+        Append(&out, table.directory, (size_t{1} << directory_bits_) + 1);
+        Append(&out, table.rotated, base_count_);
+        Append(&out, table.ids, base_count_);
+    }
+
+    const WriteBatchResult result = WriteFilesAtomic({FileWrite{path, std::move(out), false}});
+    if (!result.error.empty()) {
+        *error = result.error;
+        return false;
+    }
+    return true;
+}
+
+bool SimHashIndex::Load(const std::string& path, std::string* error) {
+    auto fail = [&](const std::string& why) {
+        *error = "Invalid simhash index - " + path + " (" + why + ")";
+        return false;
+    };
+
+    MappedFile file;
+    if (!file.Open(path, error)) return false;
+    const std::string_view data = file.view();
+    if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        return fail("bad header");
+    }
+    uint32_t blocks = 0, directory_bits = 0;
+    uint64_t count = 0;
+    std::memcpy(&blocks, data.data() + 8, 4);
+    std::memcpy(&directory_bits, data.data() + 12, 4);
+    std::memcpy(&count, data.data() + 16, 8);
+    if (blocks < 2 || blocks > 8) return fail("unsupported block count");
+
+    if (directory_bits != std::min<uint32_t>(64 / blocks, 16)) return fail("directory size mismatch");
+    if (count > UINT32_MAX) return fail("too many entries");
+    const size_t table_bytes = TableBytes(static_cast<int>(directory_bits), static_cast<size_t>(count));
+    if (data.size() != kHeaderSize + blocks * table_bytes) return fail("truncated");
+
+    // Bounds are checked once here; queries then trust the directories
+    std::vector<Table> tables(blocks);
+    const size_t directory_size = (size_t{1} << directory_bits) + 1;
+    for (uint32_t b = 0; b < blocks; ++b) {
+        const char* base = data.data() + kHeaderSize + b * table_bytes;
+        Table& table = tables[b];
+        table.directory = reinterpret_cast<const uint32_t*>(base);
+        table.rotated = reinterpret_cast<const uint64_t*>(base + PadTo8(directory_size * 4));
+        table.ids = reinterpret_cast<const uint32_t*>(base + PadTo8(directory_size * 4) + count * 8);
+        if (table.directory[0] != 0 || table.directory[directory_size - 1] != count) return fail("bad directory");
+        for (size_t k = 1; k < directory_size; ++k) {
+            if (table.directory[k] < table.directory[k - 1]) return fail("bad directory");
+        }
+    }
+
+    Layout(static_cast<int>(blocks));
+    file_ = std::move(file);
+    tables_ = std::move(tables);
+    owned_.clear();
+    base_count_ = static_cast<size_t>(count);
+    delta_hashes_.clear();
+    delta_ids_.clear();
+    delta_index_.clear();
+    tombstones_.clear();
+    return true;
+}
+
+// --- N-API ---
+
+Napi::FunctionReference SimHashIndexObject::constructor;
+
+Napi::Object SimHashIndexObject::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SimHashIndex", {
+        InstanceMethod("insert", &SimHashIndexObject::Insert),
+        InstanceMethod("insertMany", &SimHashIndexObject::InsertMany),
+        InstanceMethod("remove", &SimHashIndexObject::Remove),
+        InstanceMethod("queryWithin", &SimHashIndexObject::QueryWithin),
+        InstanceMethod("compact", &SimHashIndexObject::Compact),
+        InstanceMethod("clear", &SimHashIndexObject::Clear),
+        InstanceMethod("save", &SimHashIndexObject::Save),
+        InstanceMethod("load", &SimHashIndexObject::Load),
+        InstanceAccessor("size", &SimHashIndexObject::GetSize, nullptr)
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("SimHashIndex", func);
+    return exports;
+}
+
+namespace {
+
+int MaxDistanceOption(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsObject()) return 3;
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (!options.Has("maxDistance")) return 3;
+    return static_cast<int>(std::clamp<int64_t>(options.Get("maxDistance").As<Napi::Number>().Int64Value(), 1, 7));
+}
+
+bool ReadId(const Napi::Value& value, uint32_t* id) {
+    if (!value.IsNumber()) return false;
+    const double number = value.As<Napi::Number>().DoubleValue();
+    if (!(number >= 0 && number <= UINT32_MAX) || number != static_cast<double>(static_cast<uint32_t>(number))) {
+        return false;
+    }
+    *id = static_cast<uint32_t>(number);
+    return true;
+}
+
+} // namespace
+
+// Constructor: new SimHashIndex({ maxDistance? }) - radius answered by exact
+// block probes (default 3, up to 7); wider queries probe block neighbours.
+SimHashIndexObject::SimHashIndexObject(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SimHashIndexObject>(info), index_(MaxDistanceOption(info)) {}
+
+// insert(hash, id) -> false if the pair was already present
+Napi::Value SimHashIndexObject::Insert(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    uint64_t hash = 0;
+    uint32_t id = 0;
+    if (info.Length() < 2 || !ReadHash(info[0], &hash) || !ReadId(info[1], &id)) {
+        Napi::TypeError::New(env, "Expected (hash, id: uint32)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Boolean::New(env, index_.Insert(hash, id));
+}
+
+// insertMany(hashes: BigUint64Array, ids: Uint32Array) -> size
+Napi::Value SimHashIndexObject::InsertMany(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const uint64_t* hashes = nullptr;
+    size_t count = 0;
+    if (info.Length() < 2 || !ReadHashArray(info[0], &hashes, &count) || !info[1].IsTypedArray() ||
+        info[1].As<Napi::TypedArray>().TypedArrayType() != napi_uint32_array) {
+        Napi::TypeError::New(env, "Expected (BigUint64Array, Uint32Array)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Uint32Array ids = info[1].As<Napi::Uint32Array>();
+    if (ids.ElementLength() != count) {
+        Napi::RangeError::New(env, "hashes and ids must have the same length").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    index_.InsertMany(hashes, ids.Data(), count);
+    return Napi::Number::New(env, static_cast<double>(index_.size()));
+}
+
+// remove(hash, id) -> false if the pair was not present
+Napi::Value SimHashIndexObject::Remove(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    uint64_t hash = 0;
+    uint32_t id = 0;
+    if (info.Length() < 2 || !ReadHash(info[0], &hash) || !ReadId(info[1], &id)) {
+        Napi::TypeError::New(env, "Expected (hash, id: uint32)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Boolean::New(env, index_.Remove(hash, id));
+}
+
+// queryWithin(hash, distance) -> { ids: Uint32Array, distances: Uint8Array },
+// nearest first
+Napi::Value SimHashIndexObject::QueryWithin(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    uint64_t hash = 0;
+    if (info.Length() < 2 || !ReadHash(info[0], &hash) || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (hash, distance)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    const int distance = static_cast<int>(std::clamp<int64_t>(info[1].As<Napi::Number>().Int64Value(), -1, 64));
+
+    const std::vector<SimHashIndex::Match> matches = index_.QueryWithin(hash, distance);
+    Napi::Uint32Array ids = Napi::Uint32Array::New(env, matches.size());
+    Napi::Uint8Array distances = Napi::Uint8Array::New(env, matches.size());
+    for (size_t i = 0; i < matches.size(); ++i) {
+        ids[i] = matches[i].id;
+        distances[i] = matches[i].distance;
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ids", ids);
+    result.Set("distances", distances);
+    return result;
+}
+
+Napi::Value SimHashIndexObject::Compact(const Napi::CallbackInfo& info) {
+    index_.Compact();
+    return info.Env().Undefined();
+}
+
+Napi::Value SimHashIndexObject::Clear(const Napi::CallbackInfo& info) {
+    index_.Clear();
+    return info.Env().Undefined();
+}
+
+// save(path) - compacts, then writes atomically (temp file + rename)
+Napi::Value SimHashIndexObject::Save(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string error;
+    if (!index_.Save(info[0].As<Napi::String>().Utf8Value(), &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+// load(path) -> size. Maps the file; the index keeps its maxDistance from
+// the file. On failure the current contents stay and an Error is thrown.
+Napi::Value SimHashIndexObject::Load(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string error;
+    if (!index_.Load(info[0].As<Napi::String>().Utf8Value(), &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return Napi::Number::New(env, static_cast<double>(index_.size()));
+}
+
+Napi::Value SimHashIndexObject::GetSize(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(index_.size()));
+}
+
+} // namespace ece
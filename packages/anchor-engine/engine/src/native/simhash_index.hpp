@@ -0,0 +1,133 @@
+#pragma once
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "agent/mapped_file.hpp"
+
+namespace ece {
+
+// Near-duplicate lookup over (hash, id) entries by multi-index hashing
+// (Manku, Jain & Das Sarma, WWW '07). The 64 bits are cut into
+// max_distance + 1 blocks and each block gets a table of the hashes rotated
+// so that block leads, sorted. Two hashes within max_distance bits agree
+// exactly on at least one block, so a query reads one directory bucket per
+// table and verifies the few hashes in it. Wider queries still work: with m
+// blocks some block is within d / m bits, and those neighbours are probed.
+//
+// Inserts land in an unsorted delta scanned with the SIMD distance kernel
+// and removals of sorted entries become tombstones; both are folded into the
+// tables once they outgrow a sixteenth of them. Saved files are the
+// tables verbatim and are mapped, not read, on load. Layout (little-endian):
+//
+//   header  "ECESIMX1", u32 blocks, u32 directory_bits, u64 count
+//   tables  blocks x { u32 directory[2^directory_bits + 1],
+//                      (pad to 8), u64 rotated[count], u32 ids[count],
+//                      (pad to 8) }
+//
+// Ids are caller-assigned 32-bit integers, typically row ordinals.
+class SimHashIndex {
+public:
+    struct Match {
+        uint32_t id;
+        uint8_t distance;
+    };
+
+    // max_distance 1-7: the radius answered with exact block probes.
+    explicit SimHashIndex(int max_distance = 3);
+
+    int max_distance() const { return blocks_ - 1; }
+    size_t size() const { return base_count_ - tombstones_.size() + delta_hashes_.size(); }
+
+    // False when the (hash, id) pair is already present.
+    bool Insert(uint64_t hash, uint32_t id);
+    // Bulk build path: appends to the delta and folds once at the end.
+    void InsertMany(const uint64_t* hashes, const uint32_t* ids, size_t count);
+    // False when the pair is not present.
+    bool Remove(uint64_t hash, uint32_t id);
+    void Clear();
+
+    // Entries within `distance` bits of `hash`, nearest first, then by id.
+    std::vector<Match> QueryWithin(uint64_t hash, int distance) const;
+
+    // Folds the delta and tombstones into freshly sorted tables.
+    void Compact();
+
+    bool Save(const std::string& path, std::string* error);
+    // Replaces the contents with a mapped file; on failure nothing changes.
+    bool Load(const std::string& path, std::string* error);
+
+private:
+    struct Entry {
+        uint64_t hash;
+        uint32_t id;
+        bool operator==(const Entry& other) const { return hash == other.hash && id == other.id; }
+    };
+    struct EntryHash {
+        size_t operator()(const Entry& entry) const;
+    };
+
+    // One sorted table; points into owned_ storage or the mapped file.
+    struct Table {
+        const uint32_t* directory = nullptr;
+        const uint64_t* rotated = nullptr;
+        const uint32_t* ids = nullptr;
+    };
+    struct OwnedTable {
+        std::vector<uint32_t> directory;
+        std::vector<uint64_t> rotated;
+        std::vector<uint32_t> ids;
+    };
+
+    // Left rotation that brings block b to the top bits.
+    int Rotation(int block) const { return 64 - block_end_[block]; }
+    int Width(int block) const { return block_end_[block] - (block == 0 ? 0 : block_end_[block - 1]); }
+    void Layout(int blocks);
+
+    bool InBase(const Entry& entry) const;
+    void AppendRange(int block, size_t first, size_t last, uint64_t rotated_query, int distance,
+                     std::vector<uint8_t>* scratch, std::vector<Match>* matches) const;
+    void MaybeCompact();
+
+    int blocks_ = 4;
+    int block_end_[8] = {};
+    int directory_bits_ = 16;
+
+    size_t base_count_ = 0;
+    std::vector<Table> tables_;
+    std::vector<OwnedTable> owned_;
+    MappedFile file_;
+
+    std::vector<uint64_t> delta_hashes_;
+    std::vector<uint32_t> delta_ids_;
+    std::unordered_map<Entry, size_t, EntryHash> delta_index_;
+    std::unordered_set<Entry, EntryHash> tombstones_;
+};
+
+// JS wrapper: new SimHashIndex({ maxDistance? })
+class SimHashIndexObject : public Napi::ObjectWrap<SimHashIndexObject> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SimHashIndexObject(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value Insert(const Napi::CallbackInfo& info);
+    Napi::Value InsertMany(const Napi::CallbackInfo& info);
+    Napi::Value Remove(const Napi::CallbackInfo& info);
+    Napi::Value QueryWithin(const Napi::CallbackInfo& info);
+    Napi::Value Compact(const Napi::CallbackInfo& info);
+    Napi::Value Clear(const Napi::CallbackInfo& info);
+    Napi::Value Save(const Napi::CallbackInfo& info);
+    Napi::Value Load(const Napi::CallbackInfo& info);
+    Napi::Value GetSize(const Napi::CallbackInfo& info);
+
+    SimHashIndex index_;
+};
+
+} // namespace ece
@@ -0,0 +1,88 @@
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace ece {
+
+WorkerPool& WorkerPool::Shared() {
+    // Leaked on purpose: joining at static destruction would race Node's exit
+    static WorkerPool* pool = new WorkerPool(std::max(2u, std::thread::hardware_concurrency()));
+    return *pool;
+}
+
+WorkerPool::WorkerPool(size_t threads) {
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { Run(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void WorkerPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& fn, size_t max_workers) {
+    if (count == 0) return;
+
+    struct Loop {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto loop = std::make_shared<Loop>();
+    const size_t total = count;
+
+    // Completion is tracked per index rather than per helper, so a helper that
+    // is still queued when the caller drains the range never blocks it.
+    auto work = [loop, total, &fn] {
+        size_t i;
+        while ((i = loop->next.fetch_add(1)) < total) {
+            fn(i);
+            if (loop->done.fetch_add(1) + 1 == total) {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    size_t workers = max_workers == 0 ? Size() : std::min(max_workers, Size());
+    size_t helpers = std::min(workers, count) - (workers > 0 ? 1 : 0);
+    for (size_t h = 0; h < helpers; ++h) Submit(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&] { return loop->done.load() == total; });
+}
+
+void WorkerPool::Run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_ && queue_.empty()) return;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace ece
\ No newline at end of file
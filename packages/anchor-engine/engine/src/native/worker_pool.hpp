@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ece {
+
+// Fixed-size pool of native threads shared by the batch APIs. Long-lived
+// threads let workers keep thread_local scratch buffers warm across calls.
+class WorkerPool {
+public:
+    // Process-wide pool sized to the hardware; never torn down.
+    static WorkerPool& Shared();
+
+    explicit WorkerPool(size_t threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t Size() const { return threads_.size(); }
+
+    // Runs fn(i) for every i in [0, count) and blocks until all have finished.
+    // The calling thread takes indices too, so nested calls cannot deadlock.
+    // At most `max_workers` threads (0 = pool size) work on this loop.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn, size_t max_workers = 0);
+
+    // Fire-and-forget task.
+    void Submit(std::function<void()> task);
+
+private:
+    void Run();
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+} // namespace ece
\ No newline at end of file
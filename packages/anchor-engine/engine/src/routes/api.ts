@@ -14,6 +14,7 @@ import { validate, schemas } from '../middleware/validate.js';
 import { executeSearch, smartChatSearch } from '../services/search/search.js';
 import { AtomizerService } from '../services/ingest/atomizer-service.js';
 import { AtomicIngestService } from '../services/ingest/ingest-atomic.js';
+import { findDuplicateMolecules } from '../services/ingest/molecule-dedupe.js';
 import { dream } from '../services/dreamer/dreamer.js';
 import { getState, clearState } from '../services/scribe/scribe.js';
 import { createBackup, listBackups, restoreBackup } from '../services/backup/backup.js';
@@ -568,6 +569,32 @@ export function setupRoutes(app: Application) {
     }
   });
 
+  // Maintenance: report near-duplicate molecules (MinHash + LSH); read-only
+  app.post('/v1/maintenance/dedupe-molecules', async (req: Request, res: Response) => {
+    try {
+      const { threshold, bands, rows, shingle, minLength, limit } = req.body || {};
+      if (threshold !== undefined && !(typeof threshold === 'number' && threshold >= 0 && threshold <= 1)) {
+        res.status(400).json({ error: 'threshold must be a number between 0 and 1' });
+        return;
+      }
+      // The counts go straight to the native index
+      const counts: Array<[string, unknown, number]> = [
+        ['bands', bands, 1], ['rows', rows, 1], ['shingle', shingle, 1], ['minLength', minLength, 0], ['limit', limit, 1]
+      ];
+      for (const [name, value, min] of counts) {
+        if (value !== undefined && !(Number.isInteger(value) && (value as number) >= min)) {
+          res.status(400).json({ error: `${name} must be an integer >= ${min}` });
+          return;
+        }
+      }
+      const report = await findDuplicateMolecules({ threshold, bands, rows, shingle, minLength, limit });
+      res.status(200).json(report);
+    } catch (e: any) {
+      console.error('[Maintenance] Molecule dedupe failed:', e);
+      res.status(500).json({ error: e.message });
+    }
+  });
+
   // Web Search Endpoint
   app.get('/v1/research/web-search', async (req: Request, res: Response) => {
     try {
@@ -10,15 +10,39 @@ const __dirname = path.dirname(__filename);
 // Native modules from @rbalchii packages (with fallbacks)
 let nativeFingerprint: ((text: string) => string) | null = null;
 let nativeCleanse: ((text: string) => string) | null = null;
+let nativeSanitize: ((text: string) => string) | null = null;
 
 try {
     const fp = await import('@rbalchii/native-fingerprint');
     nativeFingerprint = fp.fingerprint;
 } catch { /* use JS fallback */ }
 
+// Otherwise ece_native's SimHash (or the manager's JS SimHash when the addon
+// is unavailable); a 32-bit string hash is not a similarity hash at all
+if (!nativeFingerprint) {
+    try {
+        const { nativeModuleManager } = await import('../../utils/native-module-manager.js');
+        const native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
+        if (typeof native?.fingerprint === 'function') {
+            // 16 hex digits: the walker casts simhash columns with ::bit(64)
+            nativeFingerprint = (text: string) => (native.fingerprint(text) as bigint).toString(16).padStart(16, '0');
+        }
+    } catch { /* use JS fallback */ }
+}
+
+// ece_native's Key Assassin, else the JS path below. It is linear and
+// non-recursive; the standalone @rbalchii/native-keyassassin package stays
+// off because it overflows the stack on deeply nested input.
 try {
-    const ka = await import('@rbalchii/native-keyassassin');
-    nativeCleanse = ka.cleanse;
+    const { nativeModuleManager } = await import('../../utils/native-module-manager.js');
+    const native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
+    if (!nativeModuleManager.isUsingFallback('ece_native') && typeof native?.cleanse === 'function') {
+        nativeCleanse = native.cleanse;
+    }
+    // The sanitize chain below as one sweep into one output buffer
+    if (!nativeModuleManager.isUsingFallback('ece_native') && typeof native?.sanitize === 'function') {
+        nativeSanitize = (text: string) => native.sanitize(text);
+    }
 } catch { /* use JS fallback */ }
 
 export class AtomizerService {
@@ -227,8 +251,12 @@ export class AtomizerService {
     /**
      * Enhanced Content Sanitization (The Key Assassin)
      * Surgically removes JSON wrappers, log spam, and PII.
+     * The native sanitize applies the same rules in chain order in a single
+     * pass, without a full copy of the content per rule.
      */
     private sanitize(text: string, filePath: string = ''): string {
+        if (nativeSanitize) return nativeSanitize(text);
+
         let clean = text;
 
         // 1. Fundamental Normalization
@@ -291,21 +319,21 @@ export class AtomizerService {
     /**
      * Helper: The Key Assassin
      * Recursively un-escapes and removes JSON wrappers.
+     * The native cleanse does the same in two linear sweeps; unlike the
+     * fallback below it unwinds any escaping depth and leaves backslashes
+     * inside fenced code alone.
      */
     private cleanseJsonArtifacts(text: string): string {
+        if (nativeCleanse) return nativeCleanse(text);
+
         let clean = text;
 
         // 1. Recursive Un-escape
-        // DISABLED NATIVE CLEANSE due to stack overflow on deep nesting
-        // if (native && native.cleanse) {
-        //    clean = native.cleanse(clean);
-        // } else {
         let pass = 0;
         while (clean.includes('\\') && pass < 3) {
             pass++;
             clean = clean.replace(/\\"/g, '"').replace(/\\n/g, '\n').replace(/\\t/g, '\t');
         }
-        // }
 
         // 2. Code Block Protection
         const codeBlocks: string[] = [];
@@ -1,6 +1,7 @@
 import { db } from '../../core/db.js';
 import { config } from '../../config/index.js';
 import { Atom, Molecule, Compound } from '../../types/atomic.js';
+import { recordSimhashes } from '../search/simhash-column.js';
 
 export class AtomicIngestService {
 
@@ -319,7 +320,7 @@ export class AtomicIngestService {
             atomContent = atomContent.substring(0, MAX_ATOM_CONTENT_SIZE) + '... [TRUNCATED]';
         }
 
-        await db.run(
+        const compoundRow = await db.run(
             `INSERT INTO atoms (id, content, source_path, timestamp, simhash, embedding, provenance, buckets, tags, compound_id, start_byte, end_byte)
              VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12)
              ON CONFLICT (id) DO UPDATE SET
@@ -333,7 +334,8 @@ export class AtomicIngestService {
                tags = EXCLUDED.tags,
                compound_id = EXCLUDED.compound_id,
                start_byte = EXCLUDED.start_byte,
-               end_byte = EXCLUDED.end_byte`,
+               end_byte = EXCLUDED.end_byte
+             RETURNING ordinal, simhash`,
             [
                 compound.id,
                 atomContent,
@@ -349,6 +351,7 @@ export class AtomicIngestService {
                 compound.compound_body.length
             ]
         );
+        await recordSimhashes(compoundRow.rows || []);
 
         // 2. Write Molecule Rows in Batches
         const atomLabelMap = new Map<string, string>();
@@ -392,7 +395,7 @@ export class AtomicIngestService {
                 );
             }
 
-            await db.run(
+            const written = await db.run(
                 `INSERT INTO atoms (id, content, source_path, timestamp, simhash, embedding, provenance, buckets, tags, compound_id, start_byte, end_byte)
                  VALUES ${placeholders.join(', ')}
                  ON CONFLICT (id) DO UPDATE SET
@@ -406,9 +409,11 @@ export class AtomicIngestService {
                    tags = EXCLUDED.tags,
                    compound_id = EXCLUDED.compound_id,
                    start_byte = EXCLUDED.start_byte,
-                   end_byte = EXCLUDED.end_byte`,
+                   end_byte = EXCLUDED.end_byte
+                 RETURNING ordinal, simhash`,
                 values
             );
+            await recordSimhashes(written.rows || []);
         }
     }
 
@@ -0,0 +1,116 @@
+/**
+ * Molecule Dedupe — MinHash + LSH pass over the molecules table
+ *
+ * SimHash compares whole texts, so a paragraph quoted inside a longer chat
+ * message looks unrelated to the original. MinHash signatures over 3-word
+ * shingles estimate set overlap instead; the native MinHashLSH index finds
+ * candidate pairs by banding and verifies them on containment: the share of
+ * the shorter molecule's shingles found in the other, so a quote scores
+ * near 1 against its source.
+ *
+ * Candidates still come from banding on Jaccard similarity, which for a
+ * quote is roughly its share of the host message. At the default 32 x 4
+ * bands a quote half the message is found about 87% of the time and one a
+ * third of it about 33%; more bands of fewer rows (64 x 2) catch shorter
+ * quotes at the cost of more candidate pairs.
+ *
+ * The pass only reports clusters. Nothing is deleted or merged.
+ */
+
+import { db } from '../../core/db.js';
+import { nativeModuleManager } from '../../utils/native-module-manager.js';
+
+const BATCH_SIZE = 5000;
+const PREVIEW_LENGTH = 160;
+
+export interface MoleculeDedupeOptions {
+    threshold?: number;  // estimated containment a pair needs (0-1)
+    bands?: number;      // LSH bands; bands * rows <= 128
+    rows?: number;
+    shingle?: number;    // words per shingle
+    minLength?: number;  // molecules shorter than this (chars) are skipped
+    limit?: number;      // clusters returned in full; the counts cover all
+}
+
+export interface DuplicateCluster {
+    size: number;
+    molecules: Array<{ id: string; compoundId: string | null; preview: string }>;
+}
+
+export interface MoleculeDedupeReport {
+    scanned: number;
+    clusterCount: number;
+    duplicateMolecules: number; // molecules beyond the first of each cluster
+    clusters: DuplicateCluster[];
+    elapsedMs: number;
+}
+
+export async function findDuplicateMolecules(options: MoleculeDedupeOptions = {}): Promise<MoleculeDedupeReport> {
+    const start = Date.now();
+    const threshold = options.threshold ?? 0.5;
+    const shingle = options.shingle ?? 3;
+    const minLength = options.minLength ?? 40;
+    const limit = options.limit ?? 100;
+
+    const native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
+    if (!native || typeof native.MinHashLSH !== 'function') {
+        throw new Error('Molecule dedupe requires the native module (MinHashLSH unavailable)');
+    }
+    const index = new native.MinHashLSH({ bands: options.bands ?? 32, rows: options.rows ?? 4 });
+
+    // Ordinals in scan order; the index stores these instead of text ids
+    const ids: string[] = [];
+    const compoundIds: Array<string | null> = [];
+    let after = '';
+    for (;;) {
+        const result = await db.run(
+            `SELECT id, compound_id, content FROM molecules
+             WHERE id > $1 AND length(content) >= $2
+             ORDER BY id LIMIT ${BATCH_SIZE}`,
+            [after, minLength]
+        );
+        const rows: any[] = result.rows || [];
+        if (rows.length === 0) break;
+
+        const ordinals = new Uint32Array(rows.length);
+        rows.forEach((row, i) => {
+            ordinals[i] = ids.length;
+            ids.push(row.id);
+            compoundIds.push(row.compound_id ?? null);
+        });
+        const { signatures, sizes } = native.minhashBatch(rows.map(row => row.content as string), { shingle });
+        index.insert(ordinals, signatures, sizes);
+
+        after = rows[rows.length - 1].id;
+        await new Promise(resolve => setImmediate(resolve));
+    }
+
+    const found: Uint32Array[] = index.clusters(threshold);
+    const reported = found.slice(0, limit);
+    const previews = new Map<string, string>();
+    const reportedIds = reported.flatMap(cluster => Array.from(cluster, ordinal => ids[ordinal]));
+    if (reportedIds.length > 0) {
+        const result = await db.run(
+            `SELECT id, left(content, ${PREVIEW_LENGTH}) AS preview FROM molecules WHERE id = ANY($1::text[])`,
+            [reportedIds]
+        );
+        for (const row of (result.rows || []) as any[]) previews.set(row.id, row.preview);
+    }
+
+    const report: MoleculeDedupeReport = {
+        scanned: ids.length,
+        clusterCount: found.length,
+        duplicateMolecules: found.reduce((sum, cluster) => sum + cluster.length - 1, 0),
+        clusters: reported.map(cluster => ({
+            size: cluster.length,
+            molecules: Array.from(cluster, ordinal => ({
+                id: ids[ordinal],
+                compoundId: compoundIds[ordinal],
+                preview: previews.get(ids[ordinal]) ?? ''
+            }))
+        })),
+        elapsedMs: Date.now() - start
+    };
+    console.log(`[MoleculeDedupe] ${report.clusterCount} clusters (${report.duplicateMolecules} duplicates) in ${report.scanned} molecules, ${report.elapsedMs}ms`);
+    return report;
+}
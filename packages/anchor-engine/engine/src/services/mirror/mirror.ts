@@ -82,6 +82,14 @@ export async function createMirror() {
     }
 
     console.log(`🪞 Mirror Protocol: Complete. ${fileCount} files mirrored, ${rehydratedCount} files rehydrated.`);
+
+    // Mirrored paths are current now; hand the agent a fresh atom index
+    try {
+        const { refreshMemoryIndex } = await import('../search/memory-index.js');
+        await refreshMemoryIndex();
+    } catch (e: any) {
+        console.warn(`🪞 Mirror: Memory index export failed: ${e.message}`);
+    }
 }
 
 /**
@@ -6,6 +6,7 @@ import * as fs from 'fs';
 import * as path from 'path';
 import * as crypto from 'crypto';
 import { NOTEBOOK_DIR } from '../../config/paths.js';
+import { nativeModuleManager } from '../../utils/native-module-manager.js';
 
 const PLUGINS_DIR = path.join(NOTEBOOK_DIR, 'plugins');
 
@@ -27,6 +28,23 @@ const turndownService = new TurndownService({
 // Remove script tags, styles, etc.
 turndownService.remove(['script', 'style', 'noscript', 'iframe', 'nav', 'footer', 'header']);
 
+// Native HTML->Markdown (ece_native HtmlIngestor), Turndown as fallback
+let nativeIngestor: any = undefined;
+function toMarkdown(html: string): string {
+    if (nativeIngestor === undefined) {
+        const native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
+        nativeIngestor = native && native.HtmlIngestor ? new native.HtmlIngestor() : null;
+    }
+    if (nativeIngestor) {
+        try {
+            return nativeIngestor.toMarkdown(html);
+        } catch (e: any) {
+            console.warn(`[Research] Native markdown conversion failed, using Turndown: ${e.message}`);
+        }
+    }
+    return turndownService.turndown(html);
+}
+
 interface ResearchResult {
     success: boolean;
     filePath?: string;
@@ -61,7 +79,7 @@ export async function fetchAndProcess(url: string, category: 'article' | 'paper'
         let contentHtml = $('main').html() || $('article').html() || $('body').html() || '';
 
         // Convert
-        const markdown = turndownService.turndown(contentHtml);
+        const markdown = toMarkdown(contentHtml);
 
         // Frontmatter
         const fileContent = `# ${title}
@@ -0,0 +1,168 @@
+/**
+ * Memory Index Export — atom_positions snapshot for the native agent
+ *
+ * Writes the atom_positions table as a flat binary file that the native
+ * module maps read-only (see native/agent/memory_index.hpp for the layout),
+ * so the agent's search_memory tool resolves atoms and reads windows from the
+ * mirrored files without a SQL round-trip.
+ *
+ * Refreshed after every Mirror Protocol run, when mirrored paths are current.
+ */
+
+import * as fs from 'fs';
+import * as path from 'path';
+import { db } from '../../core/db.js';
+import PATHS, { NOTEBOOK_DIR } from '../../config/paths.js';
+import { getMirrorPath } from '../mirror/mirror.js';
+import { nativeModuleManager } from '../../utils/native-module-manager.js';
+
+const MAGIC = 'ECEMIDX1';
+const HEADER_SIZE = 24;
+const COMPOUND_SIZE = 24;
+const LABEL_SIZE = 16;
+const POSTING_SIZE = 8;
+
+export interface MemoryIndexStats {
+    compounds: number;
+    labels: number;
+    postings: number;
+}
+
+/**
+ * Normalize an atom label the way the native lookup does:
+ * strip leading '#', lowercase ASCII only.
+ */
+export function normalizeAtomKey(label: string): string {
+    return label.replace(/^#+/, '').replace(/[A-Z]/g, c => c.toLowerCase());
+}
+
+/**
+ * Resolve the file a compound's byte offsets point into:
+ * the mirror when it exists, otherwise the original.
+ */
+function resolveCompoundFile(dbPath: string, provenance: string): string {
+    const mirrorPath = getMirrorPath(dbPath, provenance);
+    if (fs.existsSync(mirrorPath)) return mirrorPath;
+    return path.isAbsolute(dbPath) ? dbPath : path.join(NOTEBOOK_DIR, dbPath);
+}
+
+/**
+ * Export atom_positions to `outPath`. The file is written next to the target
+ * and renamed into place, so a concurrent loader never sees a partial index.
+ */
+export async function exportMemoryIndex(outPath: string = PATHS.MEMORY_INDEX_FILE): Promise<MemoryIndexStats> {
+    const result = await db.run(`
+        SELECT ap.compound_id, ap.atom_label, ap.byte_offset, c.path, c.timestamp, c.provenance
+        FROM atom_positions ap
+        JOIN compounds c ON ap.compound_id = c.id
+    `);
+    const rows: any[] = result.rows || [];
+
+    // String pool shared by compound ids, paths and label keys
+    const pool: Buffer[] = [];
+    let poolSize = 0;
+    const intern = (text: string): [number, number] => {
+        const bytes = Buffer.from(text, 'utf-8');
+        const offset = poolSize;
+        pool.push(bytes);
+        poolSize += bytes.length;
+        return [offset, bytes.length];
+    };
+
+    const compoundIndex = new Map<string, number>();
+    const compounds: { id: [number, number], file: [number, number], timestamp: number }[] = [];
+    const labels = new Map<string, number[]>(); // key -> [compound, offset, compound, offset, ...]
+
+    for (const row of rows) {
+        const compoundId = row.compound_id as string;
+        let index = compoundIndex.get(compoundId);
+        if (index === undefined) {
+            index = compounds.length;
+            compoundIndex.set(compoundId, index);
+            compounds.push({
+                id: intern(compoundId),
+                file: intern(resolveCompoundFile(row.path as string, row.provenance as string)),
+                timestamp: Number(row.timestamp) || 0
+            });
+        }
+
+        const key = normalizeAtomKey(row.atom_label as string);
+        if (!key) continue;
+        let postings = labels.get(key);
+        if (!postings) {
+            postings = [];
+            labels.set(key, postings);
+        }
+        postings.push(index, Number(row.byte_offset));
+    }
+
+    // Native side binary-searches raw UTF-8 bytes, so sort the same way
+    const keys = Array.from(labels.keys()).map(key => ({ key, bytes: Buffer.from(key, 'utf-8') }));
+    keys.sort((a, b) => Buffer.compare(a.bytes, b.bytes));
+
+    const postingCount = rows.length;
+    const tables = Buffer.alloc(HEADER_SIZE + compounds.length * COMPOUND_SIZE + keys.length * LABEL_SIZE + postingCount * POSTING_SIZE);
+    tables.write(MAGIC, 0, 'latin1');
+    tables.writeUInt32LE(compounds.length, 8);
+    tables.writeUInt32LE(keys.length, 12);
+
+    let pos = HEADER_SIZE;
+    for (const compound of compounds) {
+        tables.writeUInt32LE(compound.id[0], pos);
+        tables.writeUInt32LE(compound.id[1], pos + 4);
+        tables.writeUInt32LE(compound.file[0], pos + 8);
+        tables.writeUInt32LE(compound.file[1], pos + 12);
+        tables.writeDoubleLE(compound.timestamp, pos + 16);
+        pos += COMPOUND_SIZE;
+    }
+
+    let postingPos = pos + keys.length * LABEL_SIZE;
+    let written = 0;
+    for (const { key, bytes } of keys) {
+        // Group by compound then offset; drop duplicates ('#Rob' and 'rob' normalize together)
+        const flat = labels.get(key)!;
+        const pairs: [number, number][] = [];
+        for (let i = 0; i < flat.length; i += 2) pairs.push([flat[i], flat[i + 1]]);
+        pairs.sort((a, b) => a[0] - b[0] || a[1] - b[1]);
+
+        const first = written;
+        for (let i = 0; i < pairs.length; i++) {
+            if (i > 0 && pairs[i][0] === pairs[i - 1][0] && pairs[i][1] === pairs[i - 1][1]) continue;
+            tables.writeUInt32LE(pairs[i][0], postingPos);
+            tables.writeUInt32LE(pairs[i][1], postingPos + 4);
+            postingPos += POSTING_SIZE;
+            written++;
+        }
+
+        const [keyOffset] = intern(key);
+        tables.writeUInt32LE(keyOffset, pos);
+        tables.writeUInt32LE(bytes.length, pos + 4);
+        tables.writeUInt32LE(first, pos + 8);
+        tables.writeUInt32LE(written - first, pos + 12);
+        pos += LABEL_SIZE;
+    }
+    tables.writeUInt32LE(written, 16);
+
+    // Duplicates leave unused posting slots; trim them before the string pool
+    const body = tables.subarray(0, HEADER_SIZE + compounds.length * COMPOUND_SIZE + keys.length * LABEL_SIZE + written * POSTING_SIZE);
+
+    fs.mkdirSync(path.dirname(outPath), { recursive: true });
+    const tmpPath = `${outPath}.${process.pid}.tmp`;
+    fs.writeFileSync(tmpPath, Buffer.concat([body, ...pool]));
+    fs.renameSync(tmpPath, outPath);
+
+    return { compounds: compounds.length, labels: keys.length, postings: written };
+}
+
+/**
+ * Export the index and swap it into the native module, if it is loaded.
+ */
+export async function refreshMemoryIndex(outPath: string = PATHS.MEMORY_INDEX_FILE): Promise<MemoryIndexStats> {
+    const stats = await exportMemoryIndex(outPath);
+    const native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
+    if (native?.loadMemoryIndex) {
+        native.loadMemoryIndex(outPath);
+    }
+    console.log(`[MemoryIndex] Exported ${stats.labels} atoms, ${stats.postings} positions across ${stats.compounds} compounds.`);
+    return stats;
+}
@@ -17,6 +17,8 @@
 
 import { db } from '../../core/db.js';
 import { SearchResult } from './search.js';
+import { getSimhashColumn, syncSimhashes } from './simhash-column.js';
+import type { SimHashColumn } from './simhash-column.js';
 import type {
   SearchConfig,
   ConnectionType,
@@ -220,6 +222,16 @@ export class PhysicsTagWalker {
       ? anchorIds.slice(0, MAX_ANCHOR_IDS)
       : anchorIds;
 
+    // Native simhash column: score in one call instead of hex casts per row
+    const column = await getSimhashColumn();
+    if (column) {
+      try {
+        return await this.getConnectedNodesNative(column, cappedIds, limit, threshold);
+      } catch (e) {
+        console.warn('[PhysicsWalker] Native simhash scoring failed, using SQL:', e);
+      }
+    }
+
     const startTime = Date.now();
 
     // 1. Prepare Anchor Params
@@ -438,6 +450,103 @@ export class PhysicsTagWalker {
     }
   }
 
+  /**
+   * The Unified Field weighting above with simhash distances from the native
+   * column. SQL only finds the candidates (shared tags, ordinal, timestamp);
+   * one native call gives every anchor-candidate distance, the gravity is
+   * computed here, and full rows are fetched for the survivors only.
+   */
+  private async getConnectedNodesNative(
+    column: SimHashColumn,
+    anchorIds: string[],
+    limit: number,
+    threshold: number
+  ): Promise<WalkerNode[]> {
+    const startTime = Date.now();
+    const placeHolders = anchorIds.map((_, i) => `$${i + 1}`).join(',');
+
+    const anchorResult = await sqlWithTimeout<any>(
+      `SELECT id, ordinal, timestamp, simhash FROM atoms WHERE id IN (${placeHolders})`,
+      anchorIds
+    );
+    const anchors: any[] = anchorResult.rows || [];
+    if (anchors.length === 0) return [];
+
+    const candidateResult = await sqlWithTimeout<any>(`
+      SELECT t.atom_id, COUNT(DISTINCT t.tag) AS shared_tags, a.ordinal, a.timestamp, a.simhash
+      FROM tags t
+      JOIN atoms a ON a.id = t.atom_id
+      WHERE t.tag IN (SELECT DISTINCT tag FROM tags WHERE atom_id IN (${placeHolders}))
+        AND t.atom_id NOT IN (${placeHolders})
+      GROUP BY t.atom_id, a.ordinal, a.timestamp, a.simhash
+    `, anchorIds);
+    const candidates: any[] = candidateResult.rows || [];
+    if (candidates.length === 0) return [];
+
+    // Atoms written or re-hashed outside IngestAtomic may be missing or stale
+    syncSimhashes(column, anchors);
+    syncSimhashes(column, candidates);
+
+    // Row-major: distances[a * candidates.length + c]
+    const distances: Uint8Array = column.distances(
+      Uint32Array.from(anchors, a => Number(a.ordinal)),
+      Uint32Array.from(candidates, c => Number(c.ordinal))
+    );
+    const anchorTimes = anchors.map(a => parseFloat(a.timestamp));
+
+    // W = SharedTags * Damping * max over anchors of TimeDecay * (1 - Hamming/64)
+    const n = candidates.length;
+    const scored: Array<{ index: number; gravity: number; bestAnchorId: string }> = [];
+    for (let c = 0; c < n; c++) {
+      const timestamp = parseFloat(candidates[c].timestamp);
+      let best = -Infinity;
+      let bestAnchorId = '';
+      for (let a = 0; a < anchors.length; a++) {
+        const pull = Math.exp(-this.TIME_DECAY_LAMBDA * (Math.abs(timestamp - anchorTimes[a]) / 3600000.0)) *
+          (1.0 - distances[a * n + c] / 64.0);
+        if (pull > best) {
+          best = pull;
+          bestAnchorId = anchors[a].id;
+        }
+      }
+      const gravity = parseInt(candidates[c].shared_tags) * this.DAMPING_FACTOR * best;
+      if (gravity > threshold) scored.push({ index: c, gravity, bestAnchorId });
+    }
+    scored.sort((x, y) => y.gravity - x.gravity);
+    const top = scored.slice(0, limit);
+    if (top.length === 0) return [];
+
+    const detailResult = await sqlWithTimeout<any>(`
+      SELECT id, content, source_path, tags, provenance, type, compound_id, start_byte, end_byte
+      FROM atoms
+      WHERE id = ANY($1::text[])
+    `, [top.map(s => candidates[s.index].atom_id)]);
+    const details = new Map<string, any>((detailResult.rows || []).map((row: any) => [row.id, row]));
+
+    console.log(`[PhysicsWalker] Native Weighting: ${top.length} of ${n} candidates in ${Date.now() - startTime}ms`);
+
+    return top.map(s => {
+      const candidate = candidates[s.index];
+      const row = details.get(candidate.atom_id) || {};
+      return {
+        atomId: candidate.atom_id,
+        sharedTags: parseInt(candidate.shared_tags),
+        timestamp: parseFloat(candidate.timestamp),
+        simhash: column.get(Number(candidate.ordinal)),
+        content: row.content || '',
+        source: row.source_path || '',
+        tags: row.tags || [],
+        provenance: row.provenance || 'internal',
+        type: row.type || 'thought',
+        compoundId: row.compound_id || undefined,
+        startByte: (row.start_byte !== null && row.start_byte !== undefined) ? row.start_byte : undefined,
+        endByte: (row.end_byte !== null && row.end_byte !== undefined) ? row.end_byte : undefined,
+        gravityScore: s.gravity,
+        bestAnchorId: s.bestAnchorId
+      };
+    });
+  }
+
   // --- Tag-Based Variant (for Virtual/Mol Anchors) ---
 
   /**
@@ -0,0 +1,147 @@
+/**
+ * SimHash Column — atom simhashes as a native uint64 array
+ *
+ * The atoms table keeps simhashes as hex text, which the physics walker used
+ * to parse per candidate in SQL (and again in TS). This module keeps a dense
+ * copy keyed by atoms.ordinal in the native SimHashColumn, persisted in a
+ * file next to the database, so scoring a candidate set is one native call.
+ *
+ * IngestAtomic records every row it writes. Other paths (scribe, dreamer,
+ * restores, semantic ingestion, ...) insert atoms or rewrite the simhash of
+ * existing ones without touching the column, so readers reconcile the rows
+ * they select: syncSimhashes records the stored hash of every row whose slot
+ * holds a different value. The column is a cache: on first use it is checked
+ * against the newest rows and rebuilt from SQL when the two disagree (a crash
+ * between the two writes, a replaced database).
+ */
+
+import * as fs from 'fs';
+import * as path from 'path';
+import { db } from '../../core/db.js';
+import { pathManager } from '../../utils/path-manager.js';
+import { nativeModuleManager } from '../../utils/native-module-manager.js';
+
+const REBUILD_BATCH = 50_000;
+const VALIDATE_ROWS = 32;
+
+/** The native SimHashColumn, or null when the native module is unavailable */
+export type SimHashColumn = any;
+
+let opening: Promise<SimHashColumn | null> | null = null;
+
+/** File beside the PGlite directory holding the column */
+export function simhashColumnPath(): string {
+    const dbPath = process.env.PGLITE_DB_PATH || pathManager.getDatabasePath();
+    return path.join(path.dirname(dbPath), `${path.basename(dbPath)}.simhash`);
+}
+
+/** Parse a stored simhash ('0x'-prefixed or bare hex); anything else is 0n */
+export function parseSimhash(hash: string | null | undefined): bigint {
+    if (!hash || !/^(0x)?[0-9a-fA-F]{1,16}$/.test(hash)) return 0n;
+    return BigInt(hash.startsWith('0x') ? hash : `0x${hash}`);
+}
+
+/**
+ * Open (and if needed rebuild) the column. Resolves to null when the native
+ * module or the ordinal column is unavailable; callers keep their SQL path.
+ */
+export function getSimhashColumn(): Promise<SimHashColumn | null> {
+    if (!opening) {
+        opening = openColumn().catch(e => {
+            console.warn(`[SimHashColumn] Unavailable, using SQL simhashes: ${e.message}`);
+            return null;
+        });
+    }
+    return opening;
+}
+
+async function openColumn(): Promise<SimHashColumn | null> {
+    const native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
+    if (!native || typeof native.SimHashColumn !== 'function') return null;
+
+    const file = simhashColumnPath();
+    let column: SimHashColumn;
+    try {
+        column = new native.SimHashColumn(file);
+    } catch (e: any) {
+        console.warn(`[SimHashColumn] ${e.message}; recreating`);
+        fs.rmSync(file, { force: true });
+        column = new native.SimHashColumn(file);
+    }
+
+    if (!(await isCurrent(column))) {
+        await rebuild(column);
+    }
+    return column;
+}
+
+/** Compare the newest rows (the ones a crash would lose) and the extent */
+async function isCurrent(column: SimHashColumn): Promise<boolean> {
+    const result = await db.run(
+        `SELECT ordinal, simhash FROM atoms ORDER BY ordinal DESC LIMIT ${VALIDATE_ROWS}`
+    );
+    const rows: any[] = result.rows || [];
+    if (rows.length === 0) return column.size === 0;
+    if (column.size > Number(rows[0].ordinal) + 1) return false;
+    return rows.every(row => column.get(Number(row.ordinal)) === parseSimhash(row.simhash));
+}
+
+async function rebuild(column: SimHashColumn): Promise<void> {
+    const start = Date.now();
+    column.reset();
+    let after = -1;
+    let total = 0;
+    for (;;) {
+        const result = await db.run(
+            `SELECT ordinal, simhash FROM atoms WHERE ordinal > $1 ORDER BY ordinal LIMIT ${REBUILD_BATCH}`,
+            [after]
+        );
+        const rows: any[] = result.rows || [];
+        if (rows.length === 0) break;
+        recordRows(column, rows);
+        after = Number(rows[rows.length - 1].ordinal);
+        total += rows.length;
+        await new Promise(resolve => setImmediate(resolve));
+    }
+    column.sync();
+    console.log(`[SimHashColumn] Rebuilt ${total} simhashes in ${Date.now() - start}ms`);
+}
+
+function recordRows(column: SimHashColumn, rows: any[]): void {
+    const ordinals = new Uint32Array(rows.length);
+    const hashes = new BigUint64Array(rows.length);
+    rows.forEach((row, i) => {
+        ordinals[i] = Number(row.ordinal);
+        hashes[i] = parseSimhash(row.simhash);
+    });
+    column.set(ordinals, hashes);
+}
+
+/**
+ * Record the stored simhash of rows (ordinal, simhash) whose slot differs
+ * from it, so atoms inserted or re-hashed outside IngestAtomic score with
+ * their current hash. Returns how many slots were updated.
+ */
+export function syncSimhashes(column: SimHashColumn, rows: any[]): number {
+    const stale = rows.filter(row =>
+        column.get(Number(row.ordinal)) !== parseSimhash(row.simhash)
+    );
+    if (stale.length > 0) recordRows(column, stale);
+    return stale.length;
+}
+
+/**
+ * Record rows just written to atoms (their ordinal and stored simhash, as
+ * returned by the INSERT). A failure only leaves the column stale, which the
+ * next open detects, so it never fails the ingest.
+ */
+export async function recordSimhashes(rows: any[]): Promise<void> {
+    if (rows.length === 0) return;
+    const column = await getSimhashColumn();
+    if (!column) return;
+    try {
+        recordRows(column, rows);
+    } catch (e: any) {
+        console.warn(`[SimHashColumn] Could not record ${rows.length} simhashes: ${e.message}`);
+    }
+}
@@ -13,6 +13,7 @@ import { SemanticCategory } from '../../types/taxonomy.js';
 import { parseNaturalLanguage, expandQuery } from '../nlp/query-parser.js';
 import { ContextInflator } from '../search/context-inflator.js';
 import { distributeQueryBudget, getBudgetForTerm, getAllTerms } from '../search/distributed-query.js';
+import { nativeModuleManager } from '../../utils/native-module-manager.js';
 
 
 interface SearchResult {
@@ -539,6 +540,26 @@ function isCommonCapitalizedWord(word: string): boolean {
   return commonWords.includes(word);
 }
 
+const RELATIONSHIP_INDICATORS = ['relationship', 'with', 'and', 'met', 'told', 'said', 'visited', 'called', 'texted', 'about', 'love', 'knows', 'friend', 'partner', 'couple', 'together'];
+const TEMPORAL_INDICATORS = ['when', 'then', 'later', 'before', 'after', 'during', 'while', 'yesterday', 'today', 'tomorrow', 'morning', 'afternoon', 'evening', 'night'];
+
+// Both indicator lists compiled once into a native PatternSet, so a result
+// is scanned once instead of once per indicator (null: use the JS loops)
+let indicatorSet: any | null | undefined;
+
+function getIndicatorSet(): any | null {
+  if (indicatorSet === undefined) {
+    indicatorSet = null;
+    try {
+      const native = nativeModuleManager.loadNativeModule('ece_native', 'ece_native.node');
+      if (!nativeModuleManager.isUsingFallback('ece_native') && typeof native?.PatternSet === 'function') {
+        indicatorSet = new native.PatternSet([...RELATIONSHIP_INDICATORS, ...TEMPORAL_INDICATORS], { caseInsensitive: true });
+      }
+    } catch { /* use JS fallback */ }
+  }
+  return indicatorSet;
+}
+
 /**
  * Calculate semantic relevance score based on entity co-occurrence and relationship patterns
  */
@@ -561,17 +582,25 @@ function calculateSemanticScore(content: string, queryEntities: string[], search
     }
   }
 
+  const indicators = getIndicatorSet();
+  if (indicators) {
+    // Same boosts as below: 5 per relationship and 3 per temporal indicator present
+    const counts: Uint32Array = indicators.count(content);
+    counts.forEach((hits, i) => {
+      if (hits > 0) score += i < RELATIONSHIP_INDICATORS.length ? 5 : 3;
+    });
+    return score;
+  }
+
   // Additional boost if content contains relationship indicators
-  const relationshipIndicators = ['relationship', 'with', 'and', 'met', 'told', 'said', 'visited', 'called', 'texted', 'about', 'love', 'knows', 'friend', 'partner', 'couple', 'together'];
-  for (const indicator of relationshipIndicators) {
+  for (const indicator of RELATIONSHIP_INDICATORS) {
     if (contentLower.includes(indicator)) {
       score += 5;
     }
   }
 
   // Boost for temporal indicators if looking for narratives
-  const temporalIndicators = ['when', 'then', 'later', 'before', 'after', 'during', 'while', 'yesterday', 'today', 'tomorrow', 'morning', 'afternoon', 'evening', 'night'];
-  for (const indicator of temporalIndicators) {
+  for (const indicator of TEMPORAL_INDICATORS) {
     if (contentLower.includes(indicator)) {
       score += 3;
     }
@@ -14,6 +14,16 @@ const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 const require = createRequire(import.meta.url);
 
+// Set bits of a 64-bit BigInt, counted per 32-bit half (fallback distances)
+function popcount64(x: bigint): number {
+  const popcount32 = (v: number): number => {
+    v = v - ((v >>> 1) & 0x55555555);
+    v = (v & 0x33333333) + ((v >>> 2) & 0x33333333);
+    return (Math.imul((v + (v >>> 4)) & 0x0F0F0F0F, 0x01010101) >>> 24);
+  };
+  return popcount32(Number(x & 0xFFFFFFFFn)) + popcount32(Number(x >> 32n));
+}
+
 export interface NativeModuleStatus {
   loaded: boolean;
   moduleName: string;
@@ -274,6 +284,36 @@ export class NativeModuleManager {
             }
 
             return count;
+          },
+
+          distanceBatch: (query: bigint | BigUint64Array, candidates: BigUint64Array): Uint8Array => {
+            // Same contract as the native batch: one query for every candidate,
+            // or one query per candidate
+            const pairwise = typeof query !== 'bigint' && query.length !== 1;
+            if (pairwise && (query as BigUint64Array).length !== candidates.length) {
+              throw new TypeError('Query must be a 64-bit hash or a BigUint64Array of 1 or candidates.length hashes');
+            }
+            const single = typeof query === 'bigint' ? query : query[0];
+            const distances = new Uint8Array(candidates.length);
+            for (let i = 0; i < candidates.length; i++) {
+              const q = pairwise ? (query as BigUint64Array)[i] : single;
+              distances[i] = popcount64(BigInt.asUintN(64, q ^ candidates[i]));
+            }
+            return distances;
+          },
+
+          nearestK: (query: bigint, candidates: BigUint64Array, k: number, maxDistance = 64) => {
+            const within: Array<[number, number]> = [];
+            for (let i = 0; i < candidates.length; i++) {
+              const d = popcount64(BigInt.asUintN(64, query ^ candidates[i]));
+              if (d <= maxDistance) within.push([d, i]);
+            }
+            within.sort((x, y) => x[0] - y[0] || x[1] - y[1]);
+            const nearest = within.slice(0, Math.max(0, k));
+            return {
+              indices: Uint32Array.from(nearest, ([, i]) => i),
+              distances: Uint8Array.from(nearest, ([d]) => d)
+            };
           }
         };
 
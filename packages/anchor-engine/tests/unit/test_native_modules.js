@@ -7,6 +7,8 @@
  * - Fingerprint (SimHash Deduplication)
  */
 
+import fs from 'fs';
+import os from 'os';
 import path from 'path';
 import { fileURLToPath } from 'url';
 import { createRequire } from 'module';
@@ -106,6 +108,88 @@ async function runNativeModuleTests() {
         // Should handle double backslashes appropriately
     });
 
+    await test('Multi-level escaping, metadata keys and fenced code', async () => {
+        const input = '[{"type": "user", "content": "say \\\\\\"hi\\\\\\"\\\\nC:\\\\\\\\Users"}, ' +
+            '{"type": "assistant", "content": "```\nx = "a\\\\b"\n```"}]';
+        const expected = '{ "say "hi"\nC:/Users"\n\n "```\nx = "a\\\\b"\n```"}';
+        const result = native.cleanse(input);
+        assert(result === expected, `Expected ${JSON.stringify(expected)}, got ${JSON.stringify(result)}`);
+    });
+
+    await test('Deep nesting does not overflow', async () => {
+        const depth = 200000;
+        const input = '['.repeat(depth) + '\\'.repeat(depth) + '"x' + ']'.repeat(depth);
+        const result = native.cleanse(Buffer.from(input));
+        assert(result.length === 2 * depth, `Unexpected length ${result.length}`);
+        assert(result.includes('"x'), 'Escaped quote should be unwound');
+    });
+
+    await test('Sanitize pipeline in one pass', async () => {
+        const input = '﻿<|user|>\r\nLoading \'model.bin\'...\n2026-01-25 10:11:12 > ' +
+            '{"content": "Mail bob@example.com from 10.0.0.12",\n\n\n\n' +
+            '"type": "note", "text": "key sk-' + 'a'.repeat(32) + '"}\n<|assistant|>[Source: notes.md] ok  ';
+        // Same output as the AtomizerService.sanitize regex chain
+        const expected = '{Mail [EMAIL_REDACTED] from [IP_REDACTED]",\n\nnote", key sk-[REDACTED]\n ok';
+        const result = native.sanitize(input);
+        assert(result === expected, `Expected ${JSON.stringify(expected)}, got ${JSON.stringify(result)}`);
+        const kept = native.sanitize(Buffer.from(input), { redact: false });
+        assert(kept.includes('bob@example.com from 10.0.0.12'), 'redact: false should keep PII');
+    });
+
+    await test('Sanitize matches the regex chain on random inputs', async () => {
+        // AtomizerService.sanitize as it was before the native port
+        const chain = (text, redact) => {
+            let clean = text.replace(/^﻿/, '').replace(/[\u0000�]/g, '');
+            clean = clean.replace(/\\r\\n/g, '\n').replace(/\r\n/g, '\n');
+            for (const verb of ['Processing', 'Loading', 'Indexing', 'Analyzing']) {
+                clean = clean.replace(new RegExp(`(?:^|\\s|\\.{3}\\s*)${verb} '[^']+'\\.{3}`, 'g'), '\n');
+            }
+            clean = clean.replace(/(?:^|\n)\s*-\s*\[\d{4}-\d{2}-\d{2}.*?\].*?Processing.*?(?:\n|$)/gi, '\n');
+            clean = clean.replace(/^\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}(?:\.\d{3})?\s*(?:AM|PM)?\s*[-:>]/gm, '');
+            clean = clean.replace(/\[\d{4}-\d{2}-\d{2}.*?\]/g, '');
+            clean = clean.replace(/\[[#=]{0,10}\s{0,10}\]\s*\d{1,3}%/g, '');
+            if (redact) {
+                clean = clean.replace(/\b[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Z|a-z]{2,}\b/g, '[EMAIL_REDACTED]');
+                clean = clean.replace(/\b(?:\d{1,3}\.){3}\d{1,3}\b/g, '[IP_REDACTED]');
+                clean = clean.replace(/sk-[a-zA-Z0-9]{32,}/g, 'sk-[REDACTED]');
+            }
+            clean = clean.replace(/(?:status:\s*)?\[Source: .*?\](?:\s*\(Timestamp: .*?\))?/g, '');
+            for (const key of ['response_content', 'thinking_content', 'content', 'message', 'text', 'body', 'type', 'timestamp', 'source_path']) {
+                clean = clean.replace(new RegExp(`["']?${key}["']?\\s*:\\s*(?:\\|-?|")?`, 'g'), '');
+            }
+            clean = clean.replace(/"\s*,\s*"/g, '\n').replace(/"\s*}/g, '').replace(/{\s*"/g, '');
+            clean = clean.replace(/<\|user\|>/g, '').replace(/<\|assistant\|>/g, '').replace(/<\|system\|>/g, '');
+            return clean.replace(/\n{3,}/g, '\n\n').trim();
+        };
+
+        const explicit = native.sanitize('Done [===] 100%bob@x.com');
+        assert(explicit === 'Done [EMAIL_REDACTED]', `Progress bar hid an address: ${JSON.stringify(explicit)}`);
+
+        const tokens = [
+            'Processing ', "'a.txt'", '...', ' ', '\n', '\r\n', '\\r\\n', '- ', '[2026-01-25 10:00]', '2026-01-25 10:11:12',
+            '.123', ' PM', ' - ', '>', 'Done [===] 100%', '[== ] 50%', '[Source: a.md]', ' (Timestamp: 1)', 'status: ',
+            '\r', '\0', '�', '﻿', 'john', '.doe', '@', 'bob@x.com', '.com', '1.2.3.4', '256', '.', 'sk-',
+            'sk-' + 'a'.repeat(32), 'A'.repeat(16), '-', '%', '{', '}', '"', "'", ',', ': ', ':', '|-', '|', 'content',
+            'response_content', 'text', 'type', 'timestamp', 'hello', '<|user|>', '<|assistant|>', '\n\n\n',
+        ];
+        let state = 0x2545F491;
+        const rand = (n) => {
+            state ^= state << 13; state >>>= 0;
+            state ^= state >>> 17;
+            state ^= state << 5; state >>>= 0;
+            return state % n;
+        };
+        for (let i = 0; i < 5000; i++) {
+            let input = '';
+            for (let n = rand(25); n > 0; n--) input += tokens[rand(tokens.length)];
+            const redact = i % 4 !== 0;
+            const expected = chain(input, redact);
+            const result = native.sanitize(input, { redact });
+            assert(result === expected,
+                `${JSON.stringify(input)}: expected ${JSON.stringify(expected)}, got ${JSON.stringify(result)}`);
+        }
+    });
+
     // ═══════════════════════════════════════════
     // SECTION 2: Atomizer Tests
     // ═══════════════════════════════════════════
@@ -140,6 +224,19 @@ async function runNativeModuleTests() {
         assert(atoms.length === 0, `Expected 0 atoms for empty string, got ${atoms.length}`);
     });
 
+    await test('PatternSet finds overlapping and whole-word matches', async () => {
+        const set = new native.PatternSet(['he', 'she', 'his', 'hers']);
+        const { ids, offsets } = set.match('ushers');
+        assert(Array.from(ids).join() === '1,0,3' && Array.from(offsets).join() === '1,2,2',
+            `Expected she@1, he@2, hers@2, got ids ${Array.from(ids)} offsets ${Array.from(offsets)}`);
+
+        const words = new native.PatternSet(['memory', 'graph'], { caseInsensitive: true, wordBoundary: true });
+        assert(words.size === 2, 'size should count the patterns');
+        assert(Array.from(words.count(Buffer.from('Memory graphs and a GRAPH'))).join() === '1,1',
+            'count should fold case and skip "graphs"');
+        assert(words.test('graphite') === false, 'test should respect word boundaries');
+    });
+
     // ═══════════════════════════════════════════
     // SECTION 3: Fingerprint (SimHash) Tests
     // ═══════════════════════════════════════════
@@ -198,6 +295,168 @@ async function runNativeModuleTests() {
         assert(dist1 === dist2, `Distance should be symmetric: ${dist1} vs ${dist2}`);
     });
 
+    await test('Fingerprint is a 64-bit BigInt that accepts Buffers and options', async () => {
+        const text = 'Hello World, this is a long enough sentence to shingle well.';
+        const hash = native.fingerprint(text);
+        assert(typeof hash === 'bigint' && hash < (1n << 64n), `Expected a uint64 BigInt, got ${typeof hash}`);
+        assert(native.fingerprint(Buffer.from(text)) === hash, 'Buffer and string input should agree');
+        assert(native.fingerprint(text.toLowerCase()) === hash, 'ASCII case is folded by default');
+        assert(native.fingerprint(text, { lowercase: false }) !== hash, 'lowercase: false should keep case');
+        assert(native.fingerprint(text, { shingle: 3 }) !== hash, 'Shingle size should change the features');
+        assert(native.fingerprint('   ') === 0n, 'Text without tokens hashes to 0');
+        const hex = hash.toString(16).padStart(16, '0');
+        assert(native.distance(hex, hash) === 0 && native.distance(`0x${hex}`, 0n) === native.distance(hash, 0n),
+            'distance() should accept hex strings as stored in the simhash columns');
+        for (const bad of ['', '0x', 2 ** 64]) {
+            let rejected = false;
+            try { native.distance(bad, 0n); } catch (e) { rejected = e instanceof TypeError; }
+            assert(rejected, `distance() should reject ${JSON.stringify(bad)}`);
+        }
+        assert(native.fingerprint(text, { shingle: '3' }) === hash, 'A non-numeric shingle is ignored');
+    });
+
+    await test('distanceBatch and nearestK agree with distance()', async () => {
+        const query = native.fingerprint('the quick brown fox jumps over the lazy dog');
+        const candidates = new BigUint64Array(37);
+        for (let i = 0; i < candidates.length; i++) {
+            candidates[i] = i % 5 === 0 ? query ^ (1n << BigInt(i)) : native.fingerprint(`candidate ${i} text`);
+        }
+        const distances = native.distanceBatch(query, candidates);
+        assert(distances instanceof Uint8Array && distances.length === candidates.length, 'Expected one Uint8 per candidate');
+        for (let i = 0; i < candidates.length; i++) {
+            assert(distances[i] === native.distance(query, candidates[i]), `Distance ${i} disagrees with distance()`);
+        }
+        const pairwise = native.distanceBatch(candidates, candidates);
+        assert(pairwise.every(d => d === 0), 'Pairwise distances of an array to itself are 0');
+
+        const { indices, distances: nearest } = native.nearestK(query, candidates, 4, 1);
+        assert(indices.length === 4 && Array.from(indices).join() === '0,5,10,15',
+            `Expected the one-bit neighbours in index order, got ${Array.from(indices)}`);
+        assert(nearest.every(d => d === 1), 'nearestK should report the distances it ranked by');
+    });
+
+    await test('SimHashStream matches fingerprint() across appends and restores', async () => {
+        const text = 'the log grows by a line every minute\nand each line has a few words in it\n'.repeat(20);
+        const stream = new native.SimHashStream({ window: 8, stride: 4 });
+        let windows = 0;
+        for (let i = 0; i < text.length; i += 37) {
+            windows += stream.append(text.slice(i, i + 37)).hashes.length;
+            assert(stream.digest() === native.fingerprint(text.slice(0, i + 37)),
+                `Digest should equal fingerprint() of the prefix at ${i + 37}`);
+        }
+        assert(stream.bytes === Buffer.byteLength(text) && windows > 0, 'Stream should count bytes and emit windows');
+
+        const resumed = new native.SimHashStream(stream.serialize());
+        const more = 'a brand new tail line\n';
+        const { hashes, starts, ends } = resumed.append(Buffer.from(more));
+        assert(resumed.digest() === native.fingerprint(text + more), 'A restored stream should continue where it stopped');
+        for (let i = 0; i < hashes.length; i++) {
+            const covered = Buffer.from(text + more).subarray(starts[i], ends[i]).toString();
+            assert(hashes[i] === native.fingerprint(covered), 'A window hash should fingerprint its byte range');
+        }
+        let threw = false;
+        try { new native.SimHashStream(Buffer.from('not a stream')); } catch (e) { threw = true; }
+        assert(threw, 'Corrupt state should be rejected');
+        let typeError = null;
+        try { new native.SimHashStream({ window: '8' }); } catch (e) { typeError = e; }
+        assert(typeError instanceof TypeError, 'A non-numeric window should throw a TypeError');
+    });
+
+    await test('SimHashIndex finds near duplicates and survives save/load', async () => {
+        const index = new native.SimHashIndex({ maxDistance: 3 });
+        const base = native.fingerprint('an atom about the physics walker and its moons');
+        const hashes = new BigUint64Array(200);
+        const ids = new Uint32Array(200);
+        for (let i = 0; i < hashes.length; i++) {
+            hashes[i] = i < 4 ? base ^ ((1n << BigInt(i)) - 1n) : native.fingerprint(`unrelated atom ${i}`);
+            ids[i] = i;
+        }
+        assert(index.insertMany(hashes, ids) === 200 && index.size === 200, 'insertMany should report the size');
+        assert(index.insert(hashes[0], 0) === false, 'Duplicate pairs are not inserted twice');
+
+        let { ids: near, distances } = index.queryWithin(base, 3);
+        assert(Array.from(near).join() === '0,1,2,3' && Array.from(distances).join() === '0,1,2,3',
+            `Expected ids 0-3 at distances 0-3, got ${Array.from(near)} / ${Array.from(distances)}`);
+
+        assert(index.remove(hashes[1], 1) && !index.remove(hashes[1], 1), 'remove reports whether the pair existed');
+        const file = path.join(os.tmpdir(), `ece-simhash-${process.pid}.idx`);
+        index.save(file);
+        const loaded = new native.SimHashIndex();
+        assert(loaded.load(file) === 199, 'load should return the saved size');
+        ({ ids: near } = loaded.queryWithin(base, 3));
+        assert(Array.from(near).join() === '0,2,3', `Removed ids must stay removed, got ${Array.from(near)}`);
+        fs.rmSync(file, { force: true });
+    });
+
+    await test('SimHashColumn stores hashes by ordinal and reopens from disk', async () => {
+        const file = path.join(os.tmpdir(), `ece-simhash-${process.pid}.col`);
+        fs.rmSync(file, { force: true });
+        const base = native.fingerprint('an atom about the physics walker and its moons');
+        let column = new native.SimHashColumn(file);
+        assert(column.set(new Uint32Array([0, 2, 5]), new BigUint64Array([base, base ^ 1n, base ^ 7n])) === 6,
+            'set should grow the column to the highest ordinal');
+        column.set(new Uint32Array([2]), new BigUint64Array([base ^ 3n]));
+        column.close();
+
+        column = new native.SimHashColumn(file);
+        assert(column.size === 6 && column.get(2) === (base ^ 3n) && column.get(3) === 0n,
+            'Reopened column should keep the latest values and leave gaps unset');
+        const matrix = column.distances(new Uint32Array([0]), new Uint32Array([5, 2, 0]));
+        assert(Array.from(matrix).join() === '3,2,0', `Expected distances 3,2,0, got ${Array.from(matrix)}`);
+        const byHash = column.distances(new BigUint64Array([base, base ^ 1n]), new Uint32Array([0]));
+        assert(Array.from(byHash).join() === '0,1', 'Anchors may be passed as hashes');
+        column.close();
+
+        // A header counting more slots than the file holds is rejected
+        fs.truncateSync(file, 16 + 4 * 8);
+        let rejected = false;
+        try { new native.SimHashColumn(file); } catch { rejected = true; }
+        assert(rejected, 'A truncated column should not open');
+        fs.rmSync(file, { force: true });
+    });
+
+    await test('MinHashLSH clusters a quoted paragraph with its source', async () => {
+        const paragraph = 'the physics walker scores candidates by shared tags and time decay and then ' +
+            'blends in simhash similarity so near duplicates pull each other closer in the graph';
+        const texts = [
+            paragraph,
+            `> ${paragraph}\nagreed, that matches what I saw`,
+            'an unrelated molecule about backups and restore points and how often they run',
+            'another unrelated note on charset sniffing for legacy html exports from old tools',
+            ''
+        ];
+        const { signatures, sizes } = native.minhashBatch(texts);
+        assert(signatures.length === texts.length * 128 && sizes.length === texts.length,
+            'minhashBatch should return 128 slots and a shingle count per text');
+        assert(signatures.subarray(128, 256).join() === native.minhash(texts[1]).join(),
+            'Batch and single signatures should agree');
+
+        const lsh = new native.MinHashLSH({ bands: 32, rows: 4 });
+        assert(lsh.insert(Uint32Array.from(texts.keys()), signatures, sizes) === 4, 'Empty texts are not indexed');
+        const clusters = lsh.clusters(0.5);
+        assert(clusters.length === 1 && Array.from(clusters[0]).join() === '0,1',
+            `Expected one cluster of the quote and its source, got ${clusters.map(c => Array.from(c))}`);
+        const probe = native.minhashBatch([paragraph]);
+        const { ids, similarities } = lsh.query(probe.signatures, 0.5, probe.sizes[0]);
+        assert(ids[0] === 0 && similarities[0] === 1 && Array.from(ids).includes(1),
+            'query should rank the exact match first and find the quote');
+
+        // A quote under half of its host: Jaccard about 0.3, containment near 1
+        const host = 'i was reading through the notes from last week and wanted to point out one passage in ' +
+            'particular that explains the ranking behaviour we keep running into when testing the new search ' +
+            `page: ${paragraph} so that is probably why the results looked so odd`;
+        const hosts = native.minhashBatch([host, texts[2]]);
+        const quoted = new native.MinHashLSH({ bands: 64, rows: 2 });
+        quoted.insert(Uint32Array.of(7, 8), hosts.signatures, hosts.sizes);
+        const contained = quoted.query(probe.signatures, 0.5, probe.sizes[0]);
+        assert(contained.ids.length === 1 && contained.ids[0] === 7 && contained.similarities[0] > 0.8,
+            `A short quote should be found by containment, got ${Array.from(contained.similarities)}`);
+        assert(quoted.query(probe.signatures, 0.5).ids.length === 0, 'Without a size the query verifies on Jaccard');
+        let rejected = false;
+        try { new native.MinHashLSH({ bands: '32' }); } catch (e) { rejected = e instanceof TypeError; }
+        assert(rejected, 'Non-numeric bands should throw a TypeError');
+    });
+
     // ═══════════════════════════════════════════
     // SECTION 4: Performance Comparison Tests
     // ═══════════════════════════════════════════
@@ -231,6 +490,331 @@ async function runNativeModuleTests() {
         console.log(`     └─ Fingerprinted ${mediumText.length} chars in ${duration.toFixed(2)}ms`);
     });
 
+    // ═══════════════════════════════════════════
+    // SECTION 5: HTML Ingestor Tests
+    // ═══════════════════════════════════════════
+    console.log('\n─── HTML Ingestor ───');
+
+    await test('Streaming push/finish matches extractContent', async () => {
+        const html = '<html><head><style>p { color: red; }</style></head><body>' +
+            '<p>First &amp; foremost.</p><script>var x = "<p>not text</p>";</script>' +
+            '<div>Caf\u00e9 <b>menu</b></div></body></html>';
+        const ingestor = new native.HtmlIngestor({ blockBreaks: false });
+        const expected = ingestor.extractContent(html);
+
+        // Split the UTF-8 bytes at every position, including inside tags and "é"
+        const bytes = Buffer.from(html, 'utf8');
+        for (let cut = 1; cut < bytes.length; cut += 7) {
+            const streamed = ingestor.push(bytes.subarray(0, cut)) + ingestor.push(bytes.subarray(cut)) + ingestor.finish();
+            assert(streamed === expected, `Cut at ${cut}: expected "${expected}", got "${streamed}"`);
+        }
+        assert(!expected.includes('not text') && !expected.includes('color'), 'Script/style content should be dropped');
+    });
+
+    await test('Streaming atomize mode yields bounded atoms', async () => {
+        const ingestor = new native.HtmlIngestor({ atomize: true, maxChunkSize: 64 });
+        const atoms = [];
+        for (let i = 0; i < 200; i++) {
+            atoms.push(...ingestor.push(`<p>Paragraph ${i} has a sentence. And another one here.</p>`));
+        }
+        atoms.push(...ingestor.finish());
+        assert(atoms.length > 10, `Expected many atoms, got ${atoms.length}`);
+        assert(atoms.every(atom => atom.length <= 64 * 3 + 2), 'Atoms should respect the hard size limit');
+        assert(atoms.join('').includes('Paragraph 199'), 'Final paragraph should be flushed by finish()');
+    });
+
+    await test('extractMainContent drops navigation and boilerplate', async () => {
+        const html = '<body><div class="cookie-consent">We use cookies, accept all?</div>' +
+            '<nav><a href="/">Home</a> <a href="/about">About</a></nav>' +
+            '<div class="layout"><aside class="sidebar"><a href="/x">Related link</a></aside>' +
+            '<article><p>The article body has enough words, commas, and substance to be chosen.</p>' +
+            '<p>A second paragraph keeps going, adding detail, context, and length.</p></article></div>' +
+            '<footer>Copyright, terms, privacy</footer></body>';
+        const ingestor = new native.HtmlIngestor();
+        const main = ingestor.extractMainContent(html);
+        assert(main.includes('The article body') && main.includes('second paragraph'), `Article text missing: "${main}"`);
+        assert(!/cookies|Home|Related link|Copyright/.test(main), `Boilerplate leaked: "${main}"`);
+    });
+
+    await test('toMarkdown emits headings, lists, links, code and tables', async () => {
+        const html = '<h2>Setup</h2><p>Read <a href="https://example.com/docs">the docs</a> <b>first</b>.</p>' +
+            '<ul><li>one</li><li>two</li></ul><pre class="language-js"><code>let x = 1;</code></pre>' +
+            '<table><tr><th>Key</th><th>Value</th></tr><tr><td>a</td><td>1</td></tr></table>';
+        const markdown = new native.HtmlIngestor().toMarkdown(html);
+        for (const expected of ['## Setup', '[the docs](https://example.com/docs)', '**first**', '- one\n- two',
+            '```js\nlet x = 1;\n```', '| Key | Value |\n| --- | --- |\n| a | 1 |']) {
+            assert(markdown.includes(expected), `Missing "${expected}" in:\n${markdown}`);
+        }
+    });
+
+    await test('toMarkdown drops page chrome, scripts and frames', async () => {
+        const html = '<header><h1>Site name</h1></header><nav><a href="/">Home</a></nav>' +
+            '<script>var tracker = 1;</script><style>p { color: red }</style><noscript>Enable JS</noscript>' +
+            '<p>The article body.</p><iframe src="/ad">Ad frame</iframe><footer>Copyright</footer>';
+        const markdown = new native.HtmlIngestor().toMarkdown(html);
+        assert(markdown.trim() === 'The article body.', `Chrome leaked into markdown:\n${markdown}`);
+    });
+
+    await test('extractBatchAsync matches per-document extraction in input order', async () => {
+        const ingestor = new native.HtmlIngestor();
+        const docs = Array.from({ length: 64 }, (_, i) =>
+            `<html><head><title>Doc ${i}</title><meta name="keywords" content="k${i}, shared"></head>` +
+            `<body><p>Body of document ${i} ${'x'.repeat(i * 37)}</p></body></html>`);
+        const inputs = docs.map((doc, i) => (i % 2 ? Buffer.from(doc) : doc));
+
+        const { contents, metadata } = await ingestor.extractBatchAsync(inputs);
+        assert(contents.length === docs.length && metadata.length === docs.length, 'Result length mismatch');
+        docs.forEach((doc, i) => {
+            assert(contents[i] === ingestor.extractContent(doc), `Content mismatch at ${i}`);
+            assert(metadata[i].title === `Doc ${i}`, `Title mismatch at ${i}: ${metadata[i].title}`);
+            assert(metadata[i].tags.join() === `k${i},shared`, `Tags mismatch at ${i}`);
+        });
+    });
+
+    await test('extractLinks returns resolved targets with anchor spans into the content', async () => {
+        const html = '<p>Read <a href="guide/intro.html">the <b>intro</b></a>, skip <a href="#top">top</a>, ' +
+            'then <a href="/caf%C3%A9">café ☕</a>.</p>';
+        const ingestor = new native.HtmlIngestor();
+        const { content, targets, anchors, spans } = ingestor.extractLinks(html, 'https://example.com/docs/index.html');
+        assert(content === ingestor.extractContent(html), 'Content differs from extractContent');
+        assert(targets.join() === 'https://example.com/docs/guide/intro.html,https://example.com/caf%C3%A9', `Targets: ${targets}`);
+        assert(spans instanceof Uint32Array && spans.length === targets.length * 2, 'Spans must be packed pairs');
+        anchors.forEach((anchor, i) => {
+            assert(content.slice(spans[2 * i], spans[2 * i + 1]) === anchor, `Span ${i} does not cover "${anchor}"`);
+        });
+    });
+
+    await test('Buffer input is sniffed and transcoded to UTF-8', async () => {
+        const ingestor = new native.HtmlIngestor();
+        const cp1252 = Buffer.from('<p>Caf\xe9 \x93quoted\x94 \x80 5</p>', 'latin1');
+        const utf16 = Buffer.concat([Buffer.from([0xff, 0xfe]), Buffer.from('<p>na\u00efve \u2615</p>', 'utf16le')]);
+        const declared = Buffer.from('<meta http-equiv="Content-Type" content="text/html; charset=iso-8859-15"><p>\xa4 10</p>', 'latin1');
+
+        assert(ingestor.detectCharset(cp1252) === 'windows-1252', `Got ${ingestor.detectCharset(cp1252)}`);
+        assert(ingestor.extractContent(cp1252) === 'Café \u201cquoted\u201d \u20ac 5', ingestor.extractContent(cp1252));
+        assert(ingestor.extractContent(utf16) === 'na\u00efve \u2615', ingestor.extractContent(utf16));
+        assert(ingestor.extractContent(declared) === '\u20ac 10', ingestor.extractContent(declared));
+
+        const streamed = new native.HtmlIngestor({ blockBreaks: false });
+        let text = '';
+        for (let i = 0; i < utf16.length; i += 3) text += streamed.push(utf16.subarray(i, i + 3));
+        text += streamed.finish();
+        assert(text === 'na\u00efve \u2615', `Streamed UTF-16 gave "${text}"`);
+
+        // The charset is chosen from the head of the stream, not its first chunk
+        for (const [bytes, expected] of [[declared, '\u20ac 10'], [cp1252, 'Caf\u00e9 \u201cquoted\u201d \u20ac 5']]) {
+            let chunked = '';
+            for (let i = 0; i < bytes.length; i += 8) chunked += streamed.push(bytes.subarray(i, i + 8));
+            chunked += streamed.finish();
+            assert(chunked === expected, `Streamed in 8-byte chunks gave "${chunked}"`);
+        }
+    });
+
+    // ═══════════════════════════════════════════
+    // SECTION 6: Tool Executor Tests
+    // ═══════════════════════════════════════════
+    console.log('\n─── Tool Executor (Agent Tools) ───');
+
+    const toolDir = fs.mkdtempSync(path.join(os.tmpdir(), 'ece-tools-'));
+    const runTool = (tool, params) => native.executeTool(JSON.stringify({ tool, params }));
+
+    await test('write_file/read_file round-trip JSON escapes and braces', async () => {
+        const file = path.join(toolDir, 'escapes.txt');
+        const content = 'function f() { return "}"; }\n\ttab \\ caf\u00e9 \ud83d\ude80';
+        const written = runTool('write_file', { path: file, content });
+        assert(written.startsWith('Success'), written);
+        assert(fs.readFileSync(file, 'utf8') === content, 'File content differs from the JSON string');
+        assert(runTool('read_file', { path: file }) === content, 'read_file did not return the written content');
+        assert(native.executeTool('{"tool": "read_file", "params": ').startsWith('Error: Invalid JSON'), 'Malformed JSON must be rejected');
+        assert(runTool('no_such_tool', {}).startsWith("Error: Unknown tool 'no_such_tool'"), 'Unknown tool must be reported');
+    });
+
+    await test('read_file serves byte windows, line ranges and truncates large reads', async () => {
+        const file = path.join(toolDir, 'ranged.txt');
+        fs.writeFileSync(file, 'alpha\nbravo\ncharlie\ndelta\n' + 'x'.repeat(4096));
+        assert(runTool('read_file', { path: file, offset: 6, length: 5 }) === 'bravo', 'Byte window mismatch');
+        assert(runTool('read_file', { path: file, start_line: 2, end_line: 3 }) === 'bravo\ncharlie\n', 'Line range mismatch');
+        const capped = runTool('read_file', { path: file, max_bytes: 100 });
+        assert(capped.startsWith('alpha\nbravo') && capped.includes('[TRUNCATED - returned bytes 0-100 of 4122'), capped.slice(-120));
+    });
+
+    await test('exec_shell captures stderr and exit codes and enforces timeouts', async () => {
+        const result = runTool('exec_shell', { command: 'echo out; echo err >&2; exit 3' });
+        assert(result === 'out\n[stderr]\nerr\n[exit code 3]', JSON.stringify(result));
+        const started = Date.now();
+        const slow = runTool('exec_shell', { command: 'sleep 5', timeout_ms: 200 });
+        assert(slow.includes('[TIMED OUT after 200ms') && Date.now() - started < 2000, slow);
+    });
+
+    await test('exec_shell timeout still applies after the command closes its output', async () => {
+        const started = Date.now();
+        const detached = runTool('exec_shell', { command: 'exec sleep 5 >/dev/null 2>&1', timeout_ms: 1000 });
+        assert(detached.includes('[TIMED OUT after 1000ms') && Date.now() - started < 3000, detached);
+    });
+
+    await test('execShellStream delivers output chunks before the process exits', async () => {
+        const chunks = [];
+        const summary = await native.execShellStream('for i in 1 2 3; do echo line$i; sleep 0.05; done; echo oops >&2',
+            (text, stream) => chunks.push([stream, text]));
+        const stdout = chunks.filter(([stream]) => stream === 'stdout').map(([, text]) => text).join('');
+        assert(stdout === 'line1\nline2\nline3\n', JSON.stringify(chunks));
+        assert(chunks.some(([stream, text]) => stream === 'stderr' && text === 'oops\n'), 'stderr chunk missing');
+        assert(summary.exitCode === 0 && !summary.timedOut && !summary.truncated, JSON.stringify(summary));
+    });
+
+    await test('executeMany returns results in order with writes acting as barriers', async () => {
+        const file = path.join(toolDir, 'batch.txt');
+        const read = JSON.stringify({ tool: 'read_file', params: { path: file } });
+        const write = (content) => JSON.stringify({ tool: 'write_file', params: { path: file, content } });
+        const results = await native.executeMany([write('first'), read, read, read, write('second'), read], { concurrency: 2 });
+        assert(results.length === 6, `Expected 6 results, got ${results.length}`);
+        assert(results.slice(1, 4).every(r => r === 'first') && results[5] === 'second', JSON.stringify(results));
+        assert(await native.executeAsync(read) === 'second', 'executeAsync should resolve with the tool result');
+    });
+
+    await test('search_memory answers from a loaded atom index', async () => {
+        // One compound, one label ('rob' at byte 6); layout per native/agent/memory_index.hpp
+        const doc = path.join(toolDir, 'memory.md');
+        fs.writeFileSync(doc, 'Hello Rob, welcome back.');
+        const pool = Buffer.from('c1' + doc + 'rob');
+        const index = Buffer.alloc(24 + 24 + 16 + 8);
+        index.write('ECEMIDX1', 0, 'latin1');
+        index.writeUInt32LE(1, 8); index.writeUInt32LE(1, 12); index.writeUInt32LE(1, 16);
+        index.writeUInt32LE(0, 24); index.writeUInt32LE(2, 28);
+        index.writeUInt32LE(2, 32); index.writeUInt32LE(doc.length, 36); index.writeDoubleLE(1, 40);
+        index.writeUInt32LE(2 + doc.length, 48); index.writeUInt32LE(3, 52); index.writeUInt32LE(0, 56); index.writeUInt32LE(1, 60);
+        index.writeUInt32LE(0, 64); index.writeUInt32LE(6, 68);
+        const indexPath = path.join(toolDir, 'memory.idx');
+        fs.writeFileSync(indexPath, Buffer.concat([index, pool]));
+
+        const stats = native.loadMemoryIndex(indexPath);
+        assert(stats.compounds === 1 && stats.labels === 1 && stats.postings === 1, JSON.stringify(stats));
+        const result = runTool('search_memory', { query: '#Rob', radius: 8 });
+        assert(result.includes(doc) && result.includes('Hello Rob, wel\n'), result);
+        fs.writeFileSync(indexPath, 'not an index');
+        let threw = false;
+        try { native.loadMemoryIndex(indexPath); } catch { threw = true; }
+        assert(threw, 'loadMemoryIndex should reject a corrupt file');
+    });
+
+    await test('list_dir walks recursively with .gitignore rules and glob filters', async () => {
+        const root = path.join(toolDir, 'walk');
+        fs.mkdirSync(path.join(root, 'src', 'nested'), { recursive: true });
+        fs.mkdirSync(path.join(root, 'build'), { recursive: true });
+        fs.writeFileSync(path.join(root, '.gitignore'), 'build/\n*.log\n');
+        fs.writeFileSync(path.join(root, 'src', 'nested', 'deep.ts'), 'export {};');
+        fs.writeFileSync(path.join(root, 'src', 'app.js'), '');
+        fs.writeFileSync(path.join(root, 'build', 'out.ts'), '');
+        fs.writeFileSync(path.join(root, 'debug.log'), '');
+
+        const paths = (text) => text.trim().split('\n').map(line => line.split('\t')[0]);
+        const top = runTool('list_dir', { path: root });
+        assert(JSON.stringify(paths(top)) === JSON.stringify(['.gitignore', 'src/']), top);
+        const all = paths(runTool('list_dir', { path: root, recursive: true }));
+        assert(all.includes('src/nested/deep.ts') && !all.some(p => p.startsWith('build')), JSON.stringify(all));
+        const deep = runTool('glob', { path: root, pattern: '**/*.{ts,js}' });
+        assert(JSON.stringify(paths(deep)) === JSON.stringify(['src/app.js', 'src/nested/deep.ts']), deep);
+        assert(deep.split('\n')[1].split('\t')[1] === '10', 'glob should report file sizes');
+        const capped = runTool('list_dir', { path: root, recursive: true, max_entries: 2 });
+        assert(JSON.stringify(paths(capped).slice(0, 2)) === JSON.stringify(['.gitignore', 'src/']) &&
+            capped.includes('TRUNCATED'), `max_entries should keep the first paths: ${capped}`);
+        // Repeated "**" used to backtrack exponentially over deep paths
+        const chain = path.join(root, ...Array(24).fill('a'));
+        fs.mkdirSync(chain, { recursive: true });
+        fs.writeFileSync(path.join(chain, 'c.ts'), '');
+        const started = Date.now();
+        const none = runTool('glob', { path: root, pattern: '**/a/**/a/**/a/**/a/**/b' });
+        assert(!none.includes('c.ts') && Date.now() - started < 2000, `"**" matching should stay fast: ${none}`);
+        if (process.platform !== 'win32') {
+            fs.writeFileSync(path.join(root, 'odd\tname\n.txt'), '');
+            const odd = paths(runTool('list_dir', { path: root, pattern: 'odd*' }));
+            assert(odd.includes('odd\\tname\\n.txt'), `Tabs and newlines in names should be escaped: ${JSON.stringify(odd)}`);
+        }
+    });
+
+    await test('grep returns structured hits with line numbers and byte offsets', async () => {
+        const root = path.join(toolDir, 'grep');
+        fs.mkdirSync(path.join(root, 'lib'), { recursive: true });
+        fs.writeFileSync(path.join(root, 'lib', 'a.ts'), 'const x = 1;\nfunction loadIndex() {}\n// loadindex again\n');
+        fs.writeFileSync(path.join(root, 'b.md'), 'loadIndex in docs\n');
+
+        const literal = JSON.parse(runTool('grep', { path: root, pattern: 'loadIndex' }));
+        assert(literal.hits.length === 2 && literal.files_searched === 2 && !literal.truncated, JSON.stringify(literal));
+        assert(literal.hits[0].path === 'b.md' && literal.hits[1].path === 'lib/a.ts', JSON.stringify(literal.hits));
+        assert(literal.hits[1].line === 2 && literal.hits[1].byte_offset === 22, JSON.stringify(literal.hits[1]));
+
+        const regex = JSON.parse(runTool('grep', { path: root, pattern: 'load\\w+\\(', ignore_case: true, glob: '*.ts' }));
+        assert(regex.hits.length === 1 && regex.hits[0].snippet === 'function loadIndex() {}', JSON.stringify(regex));
+        const capped = JSON.parse(runTool('grep', { path: root, pattern: 'loadindex', ignore_case: true, max_matches: 1 }));
+        assert(capped.hits.length === 1 && capped.truncated, JSON.stringify(capped));
+        assert(runTool('grep', { path: root, pattern: 'a(b' }).startsWith('Error: Invalid pattern'), 'bad regex should be reported');
+    });
+
+    await test('write_file replaces atomically, appends, and write_files commits batches', async () => {
+        const dir = path.join(toolDir, 'atomic');
+        const file = path.join(dir, 'log.txt');
+        assert(runTool('write_file', { path: file, content: 'one' }).startsWith('Success: Written 3 bytes'), 'write_file failed');
+        fs.chmodSync(file, 0o640);
+        runTool('write_file', { path: file, content: 'two' });
+        assert((fs.statSync(file).mode & 0o777) === 0o640, 'Replacing a file should keep its mode');
+        assert(runTool('write_file', { path: file, content: '+3', append: true }).startsWith('Success: Appended 2 bytes'), 'append failed');
+        assert(fs.readFileSync(file, 'utf8') === 'two+3', 'Append should extend the file');
+
+        const batch = runTool('write_files', { files: [
+            { path: path.join(dir, 'a', 'x.ts'), content: 'x' },
+            { path: path.join(dir, 'a', 'y.ts'), content: 'y' },
+            { path: path.join(dir, 'b', 'z.ts'), content: 'z' }
+        ] });
+        assert(batch === 'Success: Written 3 files (3 bytes) in 2 directories', batch);
+        const failed = runTool('write_files', { files: [
+            { path: path.join(dir, 'a', 'x.ts'), content: 'changed' },
+            { path: path.join(file, 'not-a-dir.ts'), content: '' }
+        ] });
+        assert(failed.startsWith('Error:') && fs.readFileSync(path.join(dir, 'a', 'x.ts'), 'utf8') === 'x', failed);
+        assert(!fs.readdirSync(path.join(dir, 'a')).some(name => name.endsWith('.tmp')), 'Temp files must not be left behind');
+    });
+
+    await test('apply_edit applies exact replacements and unified diffs', async () => {
+        const file = path.join(toolDir, 'edit.ts');
+        fs.writeFileSync(file, 'const a = 1;\nconst b = 2;\nconst c = 3;\n');
+        const replaced = runTool('apply_edit', { path: file, edits: [
+            { old_text: 'a = 1', new_text: 'a = 10' },
+            { old_text: 'c = 3', new_text: 'c = 30' }
+        ] });
+        assert(replaced.startsWith('Success: Applied 2 replacement(s)'), replaced);
+        assert(fs.readFileSync(file, 'utf8') === 'const a = 10;\nconst b = 2;\nconst c = 30;\n', 'Replacements not applied');
+
+        const ambiguous = runTool('apply_edit', { path: file, old_text: 'const', new_text: 'let' });
+        assert(ambiguous.startsWith('Error:') && ambiguous.includes('matches 3 times'), ambiguous);
+
+        const diff = '--- a/edit.ts\n+++ b/edit.ts\n@@ -2 +2,2 @@\n-const b = 2;\n+const b = 20;\n+const d = 4;\n';
+        const patched = runTool('apply_edit', { path: file, diff });
+        assert(patched.startsWith('Success: Applied 1 hunk(s)'), patched);
+        assert(fs.readFileSync(file, 'utf8') === 'const a = 10;\nconst b = 20;\nconst d = 4;\nconst c = 30;\n', 'Diff not applied');
+        assert(runTool('apply_edit', { path: file, diff }).startsWith('Error:'), 'A stale diff must be rejected');
+    });
+
+    await test('read_file results are cached until the file changes', async () => {
+        const file = path.join(toolDir, 'cached.txt');
+        fs.writeFileSync(file, 'cached v1');
+        const past = new Date(Date.now() - 60000); // recently modified files are not cached
+        fs.utimesSync(file, past, past);
+        native.clearToolCache();
+
+        const before = native.toolCacheStats();
+        assert(runTool('read_file', { path: file }) === 'cached v1', 'First read failed');
+        assert(runTool('read_file', { path: file }) === 'cached v1', 'Cached read returned wrong content');
+        const after = native.toolCacheStats();
+        assert(after.hits === before.hits + 1 && after.misses === before.misses + 1, JSON.stringify(after));
+
+        runTool('write_file', { path: file, content: 'cached v2' });
+        assert(runTool('read_file', { path: file }) === 'cached v2', 'A write must invalidate the cached read');
+        fs.writeFileSync(file, 'changed outside');
+        assert(runTool('read_file', { path: file }) === 'changed outside', 'An outside change must invalidate the cached read');
+    });
+
+    fs.rmSync(toolDir, { recursive: true, force: true });
+
     // ═══════════════════════════════════════════
     // SUMMARY
     // ═══════════════════════════════════════════